@@ -0,0 +1,275 @@
+#pragma once
+#ifndef ClusteredLights_h
+#define ClusteredLights_h
+
+#if defined (__APPLE__)
+#define GLFW_INCLUDE_GLCOREARB
+#else
+#define GLEW_STATIC
+#include <GL/glew.h>
+#endif
+
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include "GLState.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define LIGHTS_USE_SSE 1
+#include <xmmintrin.h>
+#else
+#define LIGHTS_USE_SSE 0
+#endif
+
+struct PointLight {
+    glm::vec3 position;
+    glm::vec3 color;
+    float radius; // lumina nu mai are efect dincolo de această distanță
+};
+
+// Repartizarea luminilor pe clustere pentru forward shading. Frustumul vederii
+// e împărțit în DIM_X x DIM_Y dale de ecran și DIM_Z felii exponențiale de
+// adâncime. Fiecare lumină e pusă pe CPU în clusterele atinse de sfera ei, iar
+// listele fiecărui cluster sunt încărcate prin texture buffers:
+//   lightTexture   RGBA32F  2 texeli pe lumină: (poziție, rază), (culoare, 0)
+//   gridTexture    RG32UI   pe cluster: (primul indice, numărul de lumini)
+//   indexTexture   R32UI    indicii luminilor, grupați pe cluster
+class LightClusters
+{
+public:
+    static const int DIM_X = 16;
+    static const int DIM_Y = 9;
+    static const int DIM_Z = 24;
+    static const int CLUSTER_COUNT = DIM_X * DIM_Y * DIM_Z;
+
+    float nearPlane; // adâncimea de la capătul primei felii e derivată din aceasta
+    float farPlane;
+    GLuint lightTexture, gridTexture, indexTexture;
+    int indexCount; // totalul referințelor la lumini din ultima actualizare
+
+    LightClusters() : nearPlane(1.0f), farPlane(500.0f), lightTexture(0), gridTexture(0), indexTexture(0),
+        indexCount(0), lightBuffer(0), gridBuffer(0), indexBuffer(0), maxTexels(65536) {}
+
+    void init()
+    {
+        GLint maxSize = 0;
+        glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &maxSize);
+        if (maxSize > 0) maxTexels = maxSize;
+
+        createBufferTexture(lightBuffer, lightTexture, GL_RGBA32F);
+        createBufferTexture(gridBuffer, gridTexture, GL_RG32UI);
+        createBufferTexture(indexBuffer, indexTexture, GL_R32UI);
+    }
+
+    // Trebuie apelat cât contextul GL încă există
+    void release()
+    {
+        GLuint textures[3] = { lightTexture, gridTexture, indexTexture };
+        GLuint buffers[3] = { lightBuffer, gridBuffer, indexBuffer };
+        GLState::deleteTextures(3, textures);
+        GLState::deleteBuffers(3, buffers);
+        lightTexture = gridTexture = indexTexture = 0;
+        lightBuffer = gridBuffer = indexBuffer = 0;
+    }
+
+    // Repartizează luminile pentru camera acestui cadru și încarcă listele clusterelor
+    void update(const std::vector<PointLight>& lights, const glm::mat4& view, float fovY, float aspect)
+    {
+        setupTileBoundaries(tan(fovY * 0.5f) * aspect, tan(fovY * 0.5f));
+
+        ranges.resize(lights.size());
+        counts.assign(CLUSTER_COUNT, 0);
+        for (size_t i = 0; i < lights.size(); i++) {
+            glm::vec3 p = glm::vec3(view * glm::vec4(lights[i].position, 1.0f));
+            ranges[i] = binLight(p, lights[i].radius);
+            const ClusterRange& r = ranges[i];
+            if (r.empty()) continue;
+            for (int z = r.minZ; z <= r.maxZ; z++)
+                for (int y = r.minY; y <= r.maxY; y++)
+                    for (int x = r.minX; x <= r.maxX; x++)
+                        counts[clusterIndex(x, y, z)]++;
+        }
+
+        // Suma prefix dă fiecărui cluster porțiunea lui din lista de indici
+        grid.resize(CLUSTER_COUNT * 2);
+        unsigned int offset = 0;
+        for (int c = 0; c < CLUSTER_COUNT; c++) {
+            grid[c * 2] = offset;
+            grid[c * 2 + 1] = 0;
+            offset += counts[c];
+        }
+        if ((int)offset > maxTexels) {
+            std::cout << "WARNING: cluster light list truncated (" << offset << " > " << maxTexels << ")" << std::endl;
+        }
+
+        indices.resize(std::max(offset, 1u));
+        for (size_t i = 0; i < lights.size(); i++) {
+            const ClusterRange& r = ranges[i];
+            if (r.empty()) continue;
+            for (int z = r.minZ; z <= r.maxZ; z++)
+                for (int y = r.minY; y <= r.maxY; y++)
+                    for (int x = r.minX; x <= r.maxX; x++) {
+                        int c = clusterIndex(x, y, z);
+                        unsigned int slot = grid[c * 2] + grid[c * 2 + 1];
+                        if ((int)slot >= maxTexels) continue;
+                        indices[slot] = (unsigned int)i;
+                        grid[c * 2 + 1]++;
+                    }
+        }
+        indexCount = (int)offset;
+
+        lightData.resize(std::max<size_t>(lights.size(), 1) * 8);
+        for (size_t i = 0; i < lights.size(); i++) {
+            float* texel = &lightData[i * 8];
+            texel[0] = lights[i].position.x; texel[1] = lights[i].position.y;
+            texel[2] = lights[i].position.z; texel[3] = lights[i].radius;
+            texel[4] = lights[i].color.r; texel[5] = lights[i].color.g;
+            texel[6] = lights[i].color.b; texel[7] = 0.0f;
+        }
+
+        upload(lightBuffer, lightData.data(), lightData.size() * sizeof(float));
+        upload(gridBuffer, grid.data(), grid.size() * sizeof(unsigned int));
+        upload(indexBuffer, indices.data(), std::min<size_t>(indices.size(), maxTexels) * sizeof(unsigned int));
+    }
+
+private:
+    struct ClusterRange {
+        int minX, maxX, minY, maxY, minZ, maxZ;
+        bool empty() const { return minX > maxX || minY > maxY || minZ > maxZ; }
+    };
+
+    // Planele dintre dale trec prin ochi. Pentru granița de la NDC x = a,
+    // distanța cu semn a unui punct din spațiul vederii e x * n.x + z * n.z;
+    // tablourile sunt completate la un multiplu de patru pentru bucla SSE.
+    static const int PLANES_X = (DIM_X + 1 + 3) / 4 * 4;
+    static const int PLANES_Y = (DIM_Y + 1 + 3) / 4 * 4;
+    float planeXn[PLANES_X], planeXz[PLANES_X];
+    float planeYn[PLANES_Y], planeYz[PLANES_Y];
+
+    GLuint lightBuffer, gridBuffer, indexBuffer;
+    int maxTexels;
+    std::vector<ClusterRange> ranges;
+    std::vector<unsigned int> counts;
+    std::vector<unsigned int> grid;
+    std::vector<unsigned int> indices;
+    std::vector<float> lightData;
+
+    static int clusterIndex(int x, int y, int z) { return (z * DIM_Y + y) * DIM_X + x; }
+
+    static void createBufferTexture(GLuint& buffer, GLuint& texture, GLenum format)
+    {
+        glGenBuffers(1, &buffer);
+        GLState::bindBuffer(GL_TEXTURE_BUFFER, buffer);
+        glBufferData(GL_TEXTURE_BUFFER, 16, nullptr, GL_STREAM_DRAW);
+        glGenTextures(1, &texture);
+        GLState::bindTexture(GL_TEXTURE_BUFFER, texture);
+        glTexBuffer(GL_TEXTURE_BUFFER, format, buffer);
+        GLState::bindTexture(GL_TEXTURE_BUFFER, 0);
+        GLState::bindBuffer(GL_TEXTURE_BUFFER, 0);
+    }
+
+    static void upload(GLuint buffer, const void* data, size_t bytes)
+    {
+        GLState::bindBuffer(GL_TEXTURE_BUFFER, buffer);
+        glBufferData(GL_TEXTURE_BUFFER, bytes, nullptr, GL_STREAM_DRAW);
+        glBufferSubData(GL_TEXTURE_BUFFER, 0, bytes, data);
+        GLState::bindBuffer(GL_TEXTURE_BUFFER, 0);
+    }
+
+    static void setupPlanes(float* normal, float* depth, int count, int padded, float tanHalf)
+    {
+        for (int i = 0; i < padded; i++) {
+            // Completarea repetă ultima graniță; biții ei sunt mascați mai târziu
+            float a = -1.0f + 2.0f * (float)std::min(i, count) / (float)count;
+            float invLength = 1.0f / sqrt(1.0f + a * tanHalf * a * tanHalf);
+            normal[i] = invLength;
+            depth[i] = a * tanHalf * invLength;
+        }
+    }
+
+    void setupTileBoundaries(float tanX, float tanY)
+    {
+        setupPlanes(planeXn, planeXz, DIM_X, PLANES_X, tanX);
+        setupPlanes(planeYn, planeYz, DIM_Y, PLANES_Y, tanY);
+    }
+
+    // Bitul i e setat când sfera ajunge pe partea pozitivă / negativă a
+    // planului de graniță i
+    static void boundaryMasks(const float* normal, const float* depth, int padded,
+        float coord, float z, float radius, unsigned int& above, unsigned int& below)
+    {
+        above = 0;
+        below = 0;
+#if LIGHTS_USE_SSE
+        __m128 c = _mm_set1_ps(coord);
+        __m128 pz = _mm_set1_ps(z);
+        __m128 r = _mm_set1_ps(radius);
+        __m128 negR = _mm_set1_ps(-radius);
+        for (int i = 0; i < padded; i += 4) {
+            __m128 d = _mm_add_ps(_mm_mul_ps(c, _mm_loadu_ps(normal + i)), _mm_mul_ps(pz, _mm_loadu_ps(depth + i)));
+            above |= (unsigned int)_mm_movemask_ps(_mm_cmpgt_ps(d, negR)) << i;
+            below |= (unsigned int)_mm_movemask_ps(_mm_cmplt_ps(d, r)) << i;
+        }
+#else
+        for (int i = 0; i < padded; i++) {
+            float d = coord * normal[i] + z * depth[i];
+            if (d > -radius) above |= 1u << i;
+            if (d < radius) below |= 1u << i;
+        }
+#endif
+    }
+
+    // Dala t stă între granițele t și t + 1
+    static bool tileRange(unsigned int above, unsigned int below, int tiles, int& first, int& last)
+    {
+        unsigned int mask = above & (below >> 1) & ((1u << tiles) - 1u);
+        if (!mask) return false;
+        first = 0;
+        while (!(mask & (1u << first))) first++;
+        last = tiles - 1;
+        while (!(mask & (1u << last))) last--;
+        return true;
+    }
+
+    int depthSlice(float depth) const
+    {
+        if (depth <= nearPlane) return 0;
+        int slice = (int)(log(depth / nearPlane) / log(farPlane / nearPlane) * DIM_Z);
+        return std::min(std::max(slice, 0), DIM_Z - 1);
+    }
+
+    ClusterRange binLight(const glm::vec3& p, float radius) const
+    {
+        ClusterRange r = { 0, -1, 0, -1, 0, -1 };
+        float depth = -p.z;
+        if (depth + radius < 0.0f) return r; // în spatele camerei
+
+        r.minZ = depthSlice(std::max(depth - radius, 0.0f));
+        r.maxZ = depthSlice(depth + radius);
+
+        // Planele dalelor se întâlnesc în ochi; o sferă din jurul lui atinge toate dalele
+        if (depth - radius <= 0.0f) {
+            r.minX = 0; r.maxX = DIM_X - 1;
+            r.minY = 0; r.maxY = DIM_Y - 1;
+            return r;
+        }
+
+        unsigned int above, below;
+        boundaryMasks(planeXn, planeXz, PLANES_X, p.x, p.z, radius, above, below);
+        if (!tileRange(above, below, DIM_X, r.minX, r.maxX)) {
+            r.maxX = -1;
+            return r;
+        }
+        boundaryMasks(planeYn, planeYz, PLANES_Y, p.y, p.z, radius, above, below);
+        if (!tileRange(above, below, DIM_Y, r.minY, r.maxY)) {
+            r.maxX = -1;
+            return r;
+        }
+        return r;
+    }
+};
+
+#endif
@@ -0,0 +1,292 @@
+#pragma once
+#ifndef Culling_h
+#define Culling_h
+
+#include <glm/glm.hpp>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include "Camera.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CULLING_USE_SSE 1
+#include <xmmintrin.h>
+#else
+#define CULLING_USE_SSE 0
+#endif
+
+// Cele șase plane (ax + by + cz + d >= 0 înseamnă înăuntru) extrase dintr-o
+// matrice view-projection (Gribb/Hartmann).
+struct Frustum {
+    glm::vec4 planes[6];
+
+    static Frustum fromMatrix(const glm::mat4& m)
+    {
+        Frustum f;
+        glm::vec4 row0(m[0][0], m[1][0], m[2][0], m[3][0]);
+        glm::vec4 row1(m[0][1], m[1][1], m[2][1], m[3][1]);
+        glm::vec4 row2(m[0][2], m[1][2], m[2][2], m[3][2]);
+        glm::vec4 row3(m[0][3], m[1][3], m[2][3], m[3][3]);
+
+        f.planes[0] = row3 + row0; // stânga
+        f.planes[1] = row3 - row0; // dreapta
+        f.planes[2] = row3 + row1; // jos
+        f.planes[3] = row3 - row1; // sus
+        f.planes[4] = row3 + row2; // aproape
+        f.planes[5] = row3 - row2; // departe
+
+        for (int i = 0; i < 6; i++) {
+            float len = glm::length(glm::vec3(f.planes[i]));
+            if (len > 0.0f) f.planes[i] /= len;
+        }
+        return f;
+    }
+
+    bool intersects(const AABB& box) const
+    {
+        for (int i = 0; i < 6; i++) {
+            const glm::vec4& p = planes[i];
+            glm::vec3 positive(p.x > 0.0f ? box.max.x : box.min.x,
+                               p.y > 0.0f ? box.max.y : box.min.y,
+                               p.z > 0.0f ? box.max.z : box.min.z);
+            if (p.x * positive.x + p.y * positive.y + p.z * positive.z + p.w < 0.0f)
+                return false;
+        }
+        return true;
+    }
+};
+
+// AABB-ul în spațiul lumii al unei cutii locale transformate de o matrice afină (Arvo).
+inline AABB transformAABB(const glm::vec3& localMin, const glm::vec3& localMax, const glm::mat4& m)
+{
+    glm::vec3 center = (localMin + localMax) * 0.5f;
+    glm::vec3 extent = (localMax - localMin) * 0.5f;
+
+    glm::vec3 worldCenter = glm::vec3(m * glm::vec4(center, 1.0f));
+    glm::vec3 worldExtent(
+        fabs(m[0][0]) * extent.x + fabs(m[1][0]) * extent.y + fabs(m[2][0]) * extent.z,
+        fabs(m[0][1]) * extent.x + fabs(m[1][1]) * extent.y + fabs(m[2][1]) * extent.z,
+        fabs(m[0][2]) * extent.x + fabs(m[1][2]) * extent.y + fabs(m[2][2]) * extent.z);
+
+    return AABB(worldCenter - worldExtent, worldCenter + worldExtent);
+}
+
+// BVH cu patru copii peste o listă de cutii de primitive. Fiecare nod ține
+// cutiile celor patru copii în formă SoA, ca un plan al frustumului să fie
+// testat cu toate printr-o singură operație SSE. O frunză are exact o primitivă.
+class SceneBVH
+{
+public:
+    SceneBVH() : primitiveCount(0) {}
+
+    void build(const std::vector<AABB>& boxes)
+    {
+        nodes.clear();
+        primitiveCount = (int)boxes.size();
+        order.resize(boxes.size());
+        for (size_t i = 0; i < boxes.size(); i++) order[i] = (int)i;
+
+        if (!boxes.empty()) buildNode(boxes, 0, primitiveCount);
+    }
+
+    // Recalculează cutiile nodurilor după ce primitivele s-au mutat (topologia
+    // rămâne). Copiii stau mereu după părinte, deci o parcurgere de la coadă
+    // vizitează fiecare copil înaintea nodului care îl conține.
+    void refit(const std::vector<AABB>& boxes)
+    {
+        for (int n = (int)nodes.size() - 1; n >= 0; n--) {
+            Node& node = nodes[n];
+            for (int k = 0; k < 4; k++) {
+                if (node.kind[k] == SLOT_LEAF) {
+                    setSlot(node, k, boxes[node.child[k]]);
+                }
+                else if (node.kind[k] == SLOT_INNER) {
+                    setSlot(node, k, nodeBounds(nodes[node.child[k]]));
+                }
+            }
+        }
+    }
+
+    // Pune visible[i] = 1 pentru fiecare primitivă din frustum și întoarce
+    // câte au fost.
+    int cull(const Frustum& frustum, std::vector<unsigned char>& visible) const
+    {
+        visible.assign(primitiveCount, 0);
+        if (nodes.empty()) return 0;
+
+        int visibleCount = 0;
+        int stack[64];
+        int stackSize = 0;
+        stack[stackSize++] = 0;
+
+        while (stackSize > 0) {
+            const Node& node = nodes[stack[--stackSize]];
+            int mask = testNode(node, frustum);
+
+            for (int k = 0; k < 4; k++) {
+                if (!(mask & (1 << k))) continue;
+                if (node.kind[k] == SLOT_LEAF) {
+                    visible[node.child[k]] = 1;
+                    visibleCount++;
+                }
+                else if (node.kind[k] == SLOT_INNER && stackSize < 64) {
+                    stack[stackSize++] = node.child[k];
+                }
+            }
+        }
+        return visibleCount;
+    }
+
+    int nodeCount() const { return (int)nodes.size(); }
+
+private:
+    enum SlotKind { SLOT_EMPTY = 0, SLOT_LEAF = 1, SLOT_INNER = 2 };
+
+    struct Node {
+        float minX[4], minY[4], minZ[4];
+        float maxX[4], maxY[4], maxZ[4];
+        int child[4]; // indicele primitivei (frunză) sau al nodului (interior)
+        int kind[4];
+    };
+
+    std::vector<Node> nodes;
+    std::vector<int> order;
+    int primitiveCount;
+
+    static void setSlot(Node& node, int k, const AABB& box)
+    {
+        node.minX[k] = box.min.x; node.minY[k] = box.min.y; node.minZ[k] = box.min.z;
+        node.maxX[k] = box.max.x; node.maxY[k] = box.max.y; node.maxZ[k] = box.max.z;
+    }
+
+    static Node emptyNode()
+    {
+        // Locurile goale primesc o cutie inversată, finită, care pică orice test de plan
+        Node node;
+        for (int k = 0; k < 4; k++) {
+            setSlot(node, k, AABB(glm::vec3(1e30f), glm::vec3(-1e30f)));
+            node.child[k] = 0;
+            node.kind[k] = SLOT_EMPTY;
+        }
+        return node;
+    }
+
+    static AABB nodeBounds(const Node& node)
+    {
+        AABB box(glm::vec3(1e30f), glm::vec3(-1e30f));
+        for (int k = 0; k < 4; k++) {
+            if (node.kind[k] == SLOT_EMPTY) continue;
+            box.min = glm::min(box.min, glm::vec3(node.minX[k], node.minY[k], node.minZ[k]));
+            box.max = glm::max(box.max, glm::vec3(node.maxX[k], node.maxY[k], node.maxZ[k]));
+        }
+        return box;
+    }
+
+    AABB rangeBounds(const std::vector<AABB>& boxes, int start, int end) const
+    {
+        AABB box(glm::vec3(1e30f), glm::vec3(-1e30f));
+        for (int i = start; i < end; i++) {
+            box.min = glm::min(box.min, boxes[order[i]].min);
+            box.max = glm::max(box.max, boxes[order[i]].max);
+        }
+        return box;
+    }
+
+    // Împărțire la mediană pe cea mai lungă axă a cutiei centroizilor
+    int splitRange(const std::vector<AABB>& boxes, int start, int end)
+    {
+        glm::vec3 cMin(1e30f), cMax(-1e30f);
+        for (int i = start; i < end; i++) {
+            glm::vec3 c = (boxes[order[i]].min + boxes[order[i]].max) * 0.5f;
+            cMin = glm::min(cMin, c);
+            cMax = glm::max(cMax, c);
+        }
+        glm::vec3 size = cMax - cMin;
+        int axis = (size.x > size.y && size.x > size.z) ? 0 : (size.y > size.z ? 1 : 2);
+
+        int mid = (start + end) / 2;
+        std::nth_element(order.begin() + start, order.begin() + mid, order.begin() + end,
+            [&boxes, axis](int a, int b) {
+                return boxes[a].min[axis] + boxes[a].max[axis] < boxes[b].min[axis] + boxes[b].max[axis];
+            });
+        return mid;
+    }
+
+    int buildNode(const std::vector<AABB>& boxes, int start, int end)
+    {
+        int nodeIndex = (int)nodes.size();
+        nodes.push_back(emptyNode());
+
+        // Două runde de împărțiri în două dau până la patru intervale de copii
+        int ranges[4][2];
+        int rangeCount = 1;
+        ranges[0][0] = start;
+        ranges[0][1] = end;
+        for (int round = 0; round < 2; round++) {
+            int current = rangeCount;
+            for (int r = 0; r < current; r++) {
+                int s = ranges[r][0], e = ranges[r][1];
+                if (e - s <= 1) continue;
+                int mid = splitRange(boxes, s, e);
+                ranges[r][1] = mid;
+                ranges[rangeCount][0] = mid;
+                ranges[rangeCount][1] = e;
+                rangeCount++;
+            }
+        }
+
+        for (int k = 0; k < rangeCount; k++) {
+            int s = ranges[k][0], e = ranges[k][1];
+            AABB box = rangeBounds(boxes, s, e);
+            int child, kind;
+            if (e - s == 1) {
+                child = order[s];
+                kind = SLOT_LEAF;
+            }
+            else {
+                child = buildNode(boxes, s, e);
+                kind = SLOT_INNER;
+            }
+            // nodes poate fi realocat de apelul recursiv
+            setSlot(nodes[nodeIndex], k, box);
+            nodes[nodeIndex].child[k] = child;
+            nodes[nodeIndex].kind[k] = kind;
+        }
+        return nodeIndex;
+    }
+
+    // Bitul k e setat când cutia copilului k nu e complet în afara niciunui plan
+    static int testNode(const Node& node, const Frustum& frustum)
+    {
+#if CULLING_USE_SSE
+        __m128 minX = _mm_loadu_ps(node.minX), maxX = _mm_loadu_ps(node.maxX);
+        __m128 minY = _mm_loadu_ps(node.minY), maxY = _mm_loadu_ps(node.maxY);
+        __m128 minZ = _mm_loadu_ps(node.minZ), maxZ = _mm_loadu_ps(node.maxZ);
+        __m128 zero = _mm_setzero_ps();
+        __m128 outside = zero;
+
+        for (int i = 0; i < 6; i++) {
+            const glm::vec4& p = frustum.planes[i];
+            __m128 px = p.x > 0.0f ? maxX : minX;
+            __m128 py = p.y > 0.0f ? maxY : minY;
+            __m128 pz = p.z > 0.0f ? maxZ : minZ;
+
+            __m128 d = _mm_add_ps(
+                _mm_add_ps(_mm_mul_ps(px, _mm_set1_ps(p.x)), _mm_mul_ps(py, _mm_set1_ps(p.y))),
+                _mm_add_ps(_mm_mul_ps(pz, _mm_set1_ps(p.z)), _mm_set1_ps(p.w)));
+            outside = _mm_or_ps(outside, _mm_cmplt_ps(d, zero));
+        }
+        return ~_mm_movemask_ps(outside) & 0xF;
+#else
+        int mask = 0;
+        for (int k = 0; k < 4; k++) {
+            AABB box(glm::vec3(node.minX[k], node.minY[k], node.minZ[k]),
+                     glm::vec3(node.maxX[k], node.maxY[k], node.maxZ[k]));
+            if (frustum.intersects(box)) mask |= 1 << k;
+        }
+        return mask;
+#endif
+    }
+};
+
+#endif
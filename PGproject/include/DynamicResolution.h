@@ -0,0 +1,279 @@
+#pragma once
+#ifndef DynamicResolution_h
+#define DynamicResolution_h
+
+#if defined (__APPLE__)
+#define GLFW_INCLUDE_GLCOREARB
+#else
+#define GLEW_STATIC
+#include <GL/glew.h>
+#endif
+
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+#include "Shader.h"
+#include "GLState.h"
+#include "GLCapabilities.h"
+#include "RenderStats.h"
+
+// Randează scena într-o țintă în afara ecranului la scale x mărimea ferestrei
+// și o mărește în fereastră cu un filtru temporal. Scara e condusă la fiecare
+// cadru, din timpul GPU al trecerilor, spre targetMs, în [minScale, maxScale].
+//
+// Ținta e alocată o singură dată la maxScale; un cadru folosește doar colțul
+// ei width x height (viewport din origine), deci schimbarea scării nu
+// realocă nimic. Trecerile care citesc apoi culoarea sau adâncimea scenei
+// trebuie să le adreseze cu texelFetch(gl_FragCoord), nu cu coordonate
+// normalizate.
+//
+// Proiecția e decalată la fiecare cadru cu un offset sub-pixel Halton(2, 3).
+// resolve() apoi, pentru fiecare pixel al ferestrei:
+//   - filtrează cei 3x3 texeli de randare din jurul lui, ponderați după
+//     distanța de la pozițiile lor de eșantionare decalate la centrul pixelului;
+//   - află unde era pixelul în cadrul trecut, din cea mai apropiată adâncime
+//     a celor 3x3 și view-projection-ul anterior (doar mișcarea camerei);
+//   - limitează istoricul reproiectat la min / max al celor 3x3 și amestecă
+//     eșantioanele noi.
+// Istoricul e ținut la rezoluția ferestrei, deci supraviețuiește schimbărilor de scară.
+class DynamicResolution
+{
+public:
+    bool enabled;
+    float minScale, maxScale;  // din mărimea ferestrei, pe axă
+    float targetMs;            // timpul GPU al cadrului spre care e condusă scara
+    float scale;
+    int width, height;               // randate în acest cadru
+    int targetWidth, targetHeight;   // mărimea alocată a țintei (fereastra când e oprit)
+    GLuint fbo, colorTexture, depthTexture;
+
+    DynamicResolution() : enabled(true), minScale(0.5f), maxScale(1.0f), targetMs(16.6f), scale(1.0f),
+        width(0), height(0), targetWidth(0), targetHeight(0), fbo(0), colorTexture(0), depthTexture(0),
+        windowWidth(0), windowHeight(0), allocatedScale(0.0f), current(0), frameIndex(0), historyValid(false),
+        smoothedMs(0.0), jitterOffset(0.0f), emptyVAO(0), viewProjection(1.0f), previousViewProjection(1.0f)
+    {
+        historyTextures[0] = historyTextures[1] = 0;
+        historyFbos[0] = historyFbos[1] = 0;
+    }
+
+    void init()
+    {
+        shader.loadShader("shaders/fullscreen.vert", "shaders/temporal_upscale.frag");
+        // Profilul core cere un VAO legat chiar și când vârfurile vin din gl_VertexID
+        glGenVertexArrays(1, &emptyVAO);
+        scale = maxScale;
+        std::cout << "Dynamic resolution: " << minScale << "-" << maxScale << " of the window, target "
+                  << targetMs << " ms";
+        if (!GLCapabilities::get().timerQuery) std::cout << " (no timer queries, fixed at " << scale << ")";
+        std::cout << std::endl;
+    }
+
+    // Alege mărimea de randare a cadrului și decalajul proiecției lui.
+    // viewProjection e cea fără decalaj, folosită la reproiecție.
+    void beginFrame(int windowW, int windowH, const glm::mat4& cameraViewProjection)
+    {
+        if (!enabled) {
+            width = targetWidth = windowW;
+            height = targetHeight = windowH;
+            historyValid = false;
+            jitterOffset = glm::vec2(0.0f);
+            return;
+        }
+        if (!fbo || windowW != windowWidth || windowH != windowHeight || allocatedScale != maxScale) {
+            allocate(windowW, windowH);
+        }
+
+        scale = std::min(std::max(scale, minScale), maxScale);
+        width = std::min(std::max((int)std::lround(windowW * scale), 1), targetWidth);
+        height = std::min(std::max((int)std::lround(windowH * scale), 1), targetHeight);
+
+        // Mai puțini pixeli pe pixel de fereastră cer mai multe faze ca să îl acopere
+        int phases = std::max(8, (int)std::ceil(8.0f / (scale * scale)));
+        int index = frameIndex % phases + 1;
+        jitterOffset = glm::vec2(halton(index, 2) - 0.5f, halton(index, 3) - 0.5f);
+        frameIndex++;
+        viewProjection = cameraViewProjection;
+    }
+
+    // Decalează imaginea cu jitterul cadrului, în pixeli de randare, ca texelul
+    // cu centrul în c să eșantioneze scena în c - jitter (ce presupune
+    // resolve()). clip.w = -z_view, deci coloana z mută NDC în sens invers.
+    glm::mat4 jitterProjection(glm::mat4 projection) const
+    {
+        projection[2][0] -= jitterOffset.x * 2.0f / (float)width;
+        projection[2][1] -= jitterOffset.y * 2.0f / (float)height;
+        return projection;
+    }
+
+    GLuint framebuffer() const { return enabled ? fbo : 0; }
+
+    float activeScale() const { return enabled ? (float)width / (float)windowWidth : 1.0f; }
+
+    // Ținta scenei (sau fereastra) cu viewportul cadrului
+    void bind() const
+    {
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer());
+        glViewport(0, 0, width, height);
+    }
+
+    // Mărește în următoarea textură de istoric și o copiază în fereastră.
+    // Trecerea de iluminare deferred își scrie și ea adâncimea în țintă, deci
+    // adâncimea țintei servește ambele căi.
+    void resolve()
+    {
+        int next = 1 - current;
+        glBindFramebuffer(GL_FRAMEBUFFER, historyFbos[next]);
+        glViewport(0, 0, windowWidth, windowHeight);
+        GLState::disable(GL_DEPTH_TEST);
+        GLState::disable(GL_BLEND);
+
+        shader.useShaderProgram();
+        bindTexture(COLOR_UNIT, colorTexture);
+        bindTexture(DEPTH_UNIT, depthTexture);
+        bindTexture(HISTORY_UNIT, historyTextures[current]);
+        GLState::activeTexture(GL_TEXTURE0);
+        shader.setInt("sceneColor", COLOR_UNIT);
+        shader.setInt("sceneDepth", DEPTH_UNIT);
+        shader.setInt("history", HISTORY_UNIT);
+        shader.setVec2("renderSize", glm::vec2((float)width, (float)height));
+        shader.setVec2("jitter", jitterOffset);
+        shader.setMat4("inverseViewProjection", glm::inverse(viewProjection));
+        shader.setMat4("previousViewProjection", previousViewProjection);
+        shader.setBool("historyValid", historyValid);
+        GLState::bindVertexArray(emptyVAO);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        GLState::bindVertexArray(0);
+        RenderStats::frame().drawCalls++;
+        GLState::enable(GL_DEPTH_TEST);
+
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, historyFbos[next]);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+        glBlitFramebuffer(0, 0, windowWidth, windowHeight, 0, 0, windowWidth, windowHeight,
+            GL_COLOR_BUFFER_BIT, GL_NEAREST);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+        current = next;
+        previousViewProjection = viewProjection;
+        historyValid = true;
+    }
+
+    // Conduce scara pentru cadrul următor. Numărul de pixeli crește cu
+    // scale^2, deci scara care ar atinge ținta e scale * sqrt(target / time);
+    // scara parcurge o zecime din drum pe cadru, și deloc în 5% din țintă,
+    // pentru că rezultatele timerelor sunt vechi de câteva cadre.
+    void update(double gpuMs)
+    {
+        if (!enabled || gpuMs <= 0.0) return;
+        smoothedMs = smoothedMs > 0.0 ? smoothedMs + (gpuMs - smoothedMs) * 0.1 : gpuMs;
+        double ratio = targetMs / smoothedMs;
+        if (ratio > 0.95 && ratio < 1.05) return;
+        float wanted = scale * (float)std::sqrt(ratio);
+        scale = std::min(std::max(scale + (wanted - scale) * 0.1f, minScale), maxScale);
+    }
+
+    // Trebuie apelat cât contextul GL încă există
+    void release()
+    {
+        deleteTargets();
+        if (emptyVAO) GLState::deleteVertexArrays(1, &emptyVAO);
+        if (shader.shaderProgram) GLState::deleteProgram(shader.shaderProgram);
+        emptyVAO = 0;
+        shader.shaderProgram = 0;
+    }
+
+private:
+    // Peste unitățile folosite de iluminare (1-6), G-buffer (7-9) și ceața volumetrică (10-11)
+    static const int COLOR_UNIT = 12;
+    static const int DEPTH_UNIT = 13;
+    static const int HISTORY_UNIT = 14;
+
+    Shader shader;
+    int windowWidth, windowHeight;
+    float allocatedScale;
+    GLuint historyTextures[2], historyFbos[2]; // ping-pong la rezoluția ferestrei
+    int current;
+    int frameIndex;
+    bool historyValid;
+    double smoothedMs;
+    glm::vec2 jitterOffset;
+    GLuint emptyVAO;
+    glm::mat4 viewProjection, previousViewProjection;
+
+    static float halton(int index, int base)
+    {
+        float value = 0.0f, fraction = 1.0f;
+        for (; index > 0; index /= base) {
+            fraction /= (float)base;
+            value += fraction * (float)(index % base);
+        }
+        return value;
+    }
+
+    static void bindTexture(int unit, GLuint texture)
+    {
+        GLState::activeTexture(GL_TEXTURE0 + unit);
+        GLState::bindTexture(GL_TEXTURE_2D, texture);
+        GLState::bindSampler(unit, 0);
+    }
+
+    void allocate(int windowW, int windowH)
+    {
+        deleteTargets();
+        windowWidth = windowW;
+        windowHeight = windowH;
+        allocatedScale = maxScale;
+        targetWidth = std::max((int)std::ceil(windowW * maxScale), 1);
+        targetHeight = std::max((int)std::ceil(windowH * maxScale), 1);
+
+        colorTexture = createTexture(GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, targetWidth, targetHeight, GL_NEAREST);
+        depthTexture = createTexture(GL_DEPTH24_STENCIL8, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8,
+            targetWidth, targetHeight, GL_NEAREST);
+        glGenFramebuffers(1, &fbo);
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colorTexture, 0);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, depthTexture, 0);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+            std::cout << "ERROR: dynamic resolution framebuffer is incomplete" << std::endl;
+        }
+
+        // Istoricul e eșantionat biliniar în poziția reproiectată
+        glGenFramebuffers(2, historyFbos);
+        for (int i = 0; i < 2; i++) {
+            historyTextures[i] = createTexture(GL_RGBA16F, GL_RGBA, GL_FLOAT, windowW, windowH, GL_LINEAR);
+            glBindFramebuffer(GL_FRAMEBUFFER, historyFbos[i]);
+            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, historyTextures[i], 0);
+        }
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        historyValid = false;
+        std::cout << "Render target: " << targetWidth << "x" << targetHeight << " for a " << windowW << "x"
+                  << windowH << " window" << std::endl;
+    }
+
+    static GLuint createTexture(GLenum internalFormat, GLenum format, GLenum type, int w, int h, GLint filter)
+    {
+        GLuint texture;
+        glGenTextures(1, &texture);
+        GLState::bindTexture(GL_TEXTURE_2D, texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, w, h, 0, format, type, NULL);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        return texture;
+    }
+
+    void deleteTargets()
+    {
+        if (fbo) glDeleteFramebuffers(1, &fbo);
+        if (historyFbos[0]) glDeleteFramebuffers(2, historyFbos);
+        GLuint textures[4] = { colorTexture, depthTexture, historyTextures[0], historyTextures[1] };
+        GLState::deleteTextures(4, textures);
+        fbo = colorTexture = depthTexture = 0;
+        historyFbos[0] = historyFbos[1] = 0;
+        historyTextures[0] = historyTextures[1] = 0;
+    }
+};
+
+#endif
@@ -0,0 +1,87 @@
+#pragma once
+#ifndef FogPass_h
+#define FogPass_h
+
+#if defined (__APPLE__)
+#define GLFW_INCLUDE_GLCOREARB
+#else
+#define GLEW_STATIC
+#include <GL/glew.h>
+#endif
+
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include "Shader.h"
+#include "GLState.h"
+#include "RenderStats.h"
+
+// Ceața ca o singură trecere pe tot ecranul, după geometria opacă: fiecare
+// pixel citește adâncimea scenei, își reface poziția în lume și amestecă o
+// singură dată culoarea ceții peste fereastră, inclusiv peste cer. Termenul de
+// distanță e ceața exponențială la pătrat pe care shaderul de iluminare o
+// aplica pe fiecare fragment; termenul opțional de înălțime integrează în formă
+// închisă, de-a lungul razei vederii, o densitate care scade exponențial cu
+// înălțimea, deci costă încă un exp.
+class FogPass
+{
+public:
+    glm::vec3 color;
+    float density;        // ceața de distanță: 1 - exp(-density * d^2)
+    float heightDensity;  // densitatea ceții de înălțime la heightBase ...
+    float heightFalloff;  // ... împărțită la e la fiecare 1 / heightFalloff metri deasupra
+    float heightBase;
+
+    FogPass() : color(0.2f, 0.2f, 0.25f), density(0.004f), heightDensity(0.04f), heightFalloff(0.35f),
+        heightBase(0.0f), emptyVAO(0) {}
+
+    void init()
+    {
+        shader.loadShader("shaders/fullscreen.vert", "shaders/fog.frag");
+        // Profilul core cere un VAO legat chiar și când vârfurile vin din gl_VertexID
+        glGenVertexArrays(1, &emptyVAO);
+    }
+
+    // Desenează peste framebufferul legat acum; sceneDepth e adâncimea
+    // cadrului la rezoluție completă
+    void apply(GLuint sceneDepth, const glm::mat4& inverseViewProjection, const glm::vec3& cameraPos, bool heightFog)
+    {
+        GLState::disable(GL_DEPTH_TEST);
+        GLState::enable(GL_BLEND);
+        GLState::blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+        shader.useShaderProgram();
+        GLState::activeTexture(GL_TEXTURE0);
+        GLState::bindTexture(GL_TEXTURE_2D, sceneDepth);
+        GLState::bindSampler(0, 0);
+        shader.setInt("sceneDepth", 0);
+        shader.setMat4("inverseViewProjection", inverseViewProjection);
+        shader.setVec3("cameraPos", cameraPos);
+        shader.setVec3("fogColor", color);
+        shader.setFloat("fogDensity", density);
+        shader.setFloat("heightFogDensity", heightFog ? heightDensity : 0.0f);
+        shader.setFloat("heightFogFalloff", heightFalloff);
+        shader.setFloat("heightFogBase", heightBase);
+        GLState::bindVertexArray(emptyVAO);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        GLState::bindVertexArray(0);
+        RenderStats::frame().drawCalls++;
+
+        GLState::disable(GL_BLEND);
+        GLState::enable(GL_DEPTH_TEST);
+    }
+
+    // Trebuie apelat cât contextul GL încă există
+    void release()
+    {
+        if (emptyVAO) GLState::deleteVertexArrays(1, &emptyVAO);
+        if (shader.shaderProgram) GLState::deleteProgram(shader.shaderProgram);
+        emptyVAO = 0;
+        shader.shaderProgram = 0;
+    }
+
+private:
+    Shader shader;
+    GLuint emptyVAO;
+};
+
+#endif
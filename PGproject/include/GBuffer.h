@@ -0,0 +1,79 @@
+#pragma once
+#ifndef GBuffer_h
+#define GBuffer_h
+
+#if defined (__APPLE__)
+#define GLFW_INCLUDE_GLCOREARB
+#else
+#define GLEW_STATIC
+#include <GL/glew.h>
+#endif
+
+#include <GLFW/glfw3.h>
+#include <iostream>
+#include "GLState.h"
+
+// Țintele de randare ale căii deferred:
+//   albedoTexture  RGBA8    rgb = albedo, a = indicatorul de emisie
+//   normalTexture  RGBA16F  xyz = normala în lume (sau culoarea emisiei, dacă e emisiv)
+//   depthTexture   DEPTH24  din ea se reconstruiește poziția în lume
+class GBuffer
+{
+public:
+    GLuint fbo;
+    GLuint albedoTexture, normalTexture, depthTexture;
+    int width, height;
+
+    GBuffer() : fbo(0), albedoTexture(0), normalTexture(0), depthTexture(0), width(0), height(0) {}
+
+    void init(int w, int h)
+    {
+        release();
+        width = w;
+        height = h;
+
+        glGenFramebuffers(1, &fbo);
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+
+        albedoTexture = createTarget(GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, albedoTexture, 0);
+        normalTexture = createTarget(GL_RGBA16F, GL_RGBA, GL_FLOAT);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, normalTexture, 0);
+        depthTexture = createTarget(GL_DEPTH_COMPONENT24, GL_DEPTH_COMPONENT, GL_FLOAT);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depthTexture, 0);
+
+        GLenum drawBuffers[2] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+        glDrawBuffers(2, drawBuffers);
+
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+            std::cout << "ERROR: G-buffer framebuffer is incomplete" << std::endl;
+        }
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+
+    // Trebuie apelat cât contextul GL încă există
+    void release()
+    {
+        if (fbo) glDeleteFramebuffers(1, &fbo);
+        GLuint textures[3] = { albedoTexture, normalTexture, depthTexture };
+        GLState::deleteTextures(3, textures);
+        fbo = 0;
+        albedoTexture = normalTexture = depthTexture = 0;
+    }
+
+private:
+    GLuint createTarget(GLenum internalFormat, GLenum format, GLenum type)
+    {
+        GLuint texture;
+        glGenTextures(1, &texture);
+        GLState::bindTexture(GL_TEXTURE_2D, texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, type, NULL);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        return texture;
+    }
+};
+
+#endif
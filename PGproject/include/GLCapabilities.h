@@ -0,0 +1,189 @@
+#pragma once
+#ifndef GLCapabilities_h
+#define GLCapabilities_h
+
+#if defined (__APPLE__)
+#define GLFW_INCLUDE_GLCOREARB
+#else
+#define GLEW_STATIC
+#include <GL/glew.h>
+#endif
+
+#include <GLFW/glfw3.h>
+#include <string>
+#include <set>
+#include <iostream>
+
+#ifndef GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT
+#define GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT 0x84FF
+#endif
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+
+// Ce oferă driverul, verificat o dată după crearea contextului, și ce
+// implementare folosește fiecare subsistem din cauza asta.
+//
+// Nivelurile grupează căile opționale, ca un nivel întreg să poată fi forțat
+// pentru măsurători (--tier în linia de comandă):
+//   baseline - doar ce garantează un context GL 4.1 core (macOS)
+//   modern   - + multi-draw indirect cu base instance, texturi comprimate de
+//              driver, compilare paralelă a shaderelor
+//   azdo     - + stocare imutabilă pentru buffere
+// Fiecare cale e folosită tot doar când driverul o suportă, deci forțarea unui
+// nivel peste cel detectat pornește doar ce există.
+class GLCapabilities
+{
+public:
+    enum Tier { TIER_BASELINE = 0, TIER_MODERN = 1, TIER_AZDO = 2, TIER_AUTO = 3 };
+
+    int major, minor;
+    std::string renderer;
+
+    // Suportul driverului
+    bool multiDrawIndirect;    // GL 4.3 / ARB_multi_draw_indirect + ARB_base_instance
+    bool bufferStorage;        // GL 4.4 / ARB_buffer_storage
+    bool parallelShaderCompile; // ARB_parallel_shader_compile
+    bool timerQuery;           // GL 3.3 / ARB_timer_query
+    bool s3tc, rgtc, bptc, astc;
+    float maxAnisotropy;       // 0 = fără filtrare anizotropă
+
+    Tier requestedTier;        // TIER_AUTO dacă nu s-a dat --tier
+    Tier detectedTier;         // cel mai înalt nivel ale cărui funcții definitorii există
+    Tier tier;                 // nivelul folosit
+
+    // Căile alese din suport + nivel
+    bool useMultiDrawIndirect;
+    bool useBufferStorage;
+    bool useParallelShaderCompile;
+    bool useCompressedTextures;
+
+    static GLCapabilities& get()
+    {
+        static GLCapabilities caps;
+        return caps;
+    }
+
+    static const char* tierName(Tier t)
+    {
+        static const char* names[] = { "baseline", "modern", "azdo", "auto" };
+        return names[t];
+    }
+
+    // Acceptă numele afișate de tierName; întoarce false pentru orice altceva
+    static bool parseTier(const std::string& name, Tier& out)
+    {
+        for (int t = TIER_BASELINE; t <= TIER_AUTO; t++) {
+            if (name == tierName((Tier)t)) {
+                out = (Tier)t;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Cea mai mare versiune minoră de context care merită cerută (majora e mereu 4)
+    int preferredContextMinor() const
+    {
+#if defined(__APPLE__)
+        return 1;
+#else
+        return requestedTier == TIER_BASELINE ? 1 : 6;
+#endif
+    }
+
+    // Cere un context curent (și glewInit pe Windows / Linux)
+    void probe()
+    {
+        glGetIntegerv(GL_MAJOR_VERSION, &major);
+        glGetIntegerv(GL_MINOR_VERSION, &minor);
+        const GLubyte* name = glGetString(GL_RENDERER);
+        renderer = name ? (const char*)name : "";
+
+        extensions.clear();
+        GLint count = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+        for (GLint i = 0; i < count; i++) {
+            const GLubyte* ext = glGetStringi(GL_EXTENSIONS, i);
+            if (ext) extensions.insert((const char*)ext);
+        }
+
+        multiDrawIndirect = atLeast(4, 3) || (has("GL_ARB_multi_draw_indirect") && has("GL_ARB_base_instance"));
+        bufferStorage = atLeast(4, 4) || has("GL_ARB_buffer_storage");
+        parallelShaderCompile = has("GL_ARB_parallel_shader_compile");
+        timerQuery = atLeast(3, 3) || has("GL_ARB_timer_query");
+        s3tc = has("GL_EXT_texture_compression_s3tc");
+        rgtc = atLeast(3, 0) || has("GL_ARB_texture_compression_rgtc");
+        bptc = atLeast(4, 2) || has("GL_ARB_texture_compression_bptc");
+        astc = has("GL_KHR_texture_compression_astc_ldr");
+
+        maxAnisotropy = 0.0f;
+        if (atLeast(4, 6) || has("GL_EXT_texture_filter_anisotropic") || has("GL_ARB_texture_filter_anisotropic")) {
+            glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &maxAnisotropy);
+        }
+
+#if defined(__APPLE__)
+        // Headerele native nu expun aceste funcții
+        multiDrawIndirect = false;
+        bufferStorage = false;
+        parallelShaderCompile = false;
+#endif
+
+        detectedTier = TIER_BASELINE;
+        if (multiDrawIndirect) detectedTier = TIER_MODERN;
+        if (multiDrawIndirect && bufferStorage) detectedTier = TIER_AZDO;
+        tier = requestedTier == TIER_AUTO ? detectedTier : requestedTier;
+
+        useMultiDrawIndirect = tier >= TIER_MODERN && multiDrawIndirect;
+        useCompressedTextures = tier >= TIER_MODERN && s3tc;
+        useParallelShaderCompile = tier >= TIER_MODERN && parallelShaderCompile;
+        useBufferStorage = tier >= TIER_AZDO && bufferStorage;
+
+#if !defined(__APPLE__)
+        // Driverul poate compila pe câte fire dorește
+        if (useParallelShaderCompile) glMaxShaderCompilerThreadsARB(0xFFFFFFFFu);
+#endif
+    }
+
+    void print() const
+    {
+        std::cout << "GL " << major << "." << minor << " on " << renderer << std::endl;
+        std::cout << "  multi-draw indirect: " << yesNo(multiDrawIndirect)
+                  << ", buffer storage: " << yesNo(bufferStorage)
+                  << ", parallel shader compile: " << yesNo(parallelShaderCompile)
+                  << ", timer queries: " << yesNo(timerQuery) << std::endl;
+        std::cout << "  texture compression: S3TC " << yesNo(s3tc) << ", RGTC " << yesNo(rgtc)
+                  << ", BPTC " << yesNo(bptc) << ", ASTC " << yesNo(astc)
+                  << ", max anisotropy " << maxAnisotropy << std::endl;
+        std::cout << "Render tier: " << tierName(tier) << " (detected " << tierName(detectedTier)
+                  << (requestedTier != TIER_AUTO ? ", forced from the command line" : "") << ")" << std::endl;
+        if (tier > detectedTier) {
+            std::cout << "  WARNING: the driver lacks part of the " << tierName(tier)
+                      << " tier; those paths stay on their fallbacks" << std::endl;
+        }
+        std::cout << "  draw submission: " << (useMultiDrawIndirect ? "multi-draw indirect" : "multi-draw base vertex")
+                  << ", textures: " << (useCompressedTextures ? "S3TC/RGTC" : "uncompressed")
+                  << ", shader compile: " << (useParallelShaderCompile ? "parallel" : "serial")
+                  << ", static buffers: " << (useBufferStorage ? "immutable storage" : "glBufferData")
+                  << ", GPU timers: " << (timerQuery ? "on" : "off") << std::endl;
+    }
+
+private:
+    std::set<std::string> extensions;
+
+    GLCapabilities()
+        : major(0), minor(0), multiDrawIndirect(false), bufferStorage(false), parallelShaderCompile(false),
+          timerQuery(false), s3tc(false), rgtc(false), bptc(false), astc(false), maxAnisotropy(0.0f),
+          requestedTier(TIER_AUTO), detectedTier(TIER_BASELINE), tier(TIER_BASELINE),
+          useMultiDrawIndirect(false), useBufferStorage(false), useParallelShaderCompile(false),
+          useCompressedTextures(false) {}
+
+    bool has(const char* name) const { return extensions.count(name) > 0; }
+    bool atLeast(int maj, int min) const { return major > maj || (major == maj && minor >= min); }
+    static const char* yesNo(bool b) { return b ? "yes" : "no"; }
+};
+
+#endif
@@ -0,0 +1,316 @@
+#pragma once
+#ifndef GLState_h
+#define GLState_h
+
+#if defined (__APPLE__)
+#define GLFW_INCLUDE_GLCOREARB
+#else
+#define GLEW_STATIC
+#include <GL/glew.h>
+#endif
+
+#include <GLFW/glfw3.h>
+#include "RenderStats.h"
+
+// Copia stării GL pe care o modifică proiectul. Orice bind / enable trece pe
+// aici; apelurile care ar lăsa starea neschimbată sunt omise și numărate în
+// RenderStats (glCallsElided față de glCallsIssued).
+//
+// Cache-ul e corect doar cât timp nimic altceva nu atinge aceeași stare, așa
+// că tot codul GL din proiect folosește aceste funcții, inclusiv la ștergerea
+// obiectelor (GL dezleagă singur obiectele șterse). După cod care nu trece
+// pe aici, apelați invalidate().
+class GLState
+{
+public:
+    static const int MAX_TEXTURE_UNITS = 16;
+
+    static void invalidate()
+    {
+        State& s = state();
+        s.program = UNKNOWN;
+        s.vertexArray = UNKNOWN;
+        s.activeUnit = UNKNOWN;
+        for (int u = 0; u < MAX_TEXTURE_UNITS; u++) {
+            for (int t = 0; t < TEXTURE_TARGETS; t++) s.textures[u][t] = UNKNOWN;
+            s.samplers[u] = UNKNOWN;
+        }
+        for (int b = 0; b < BUFFER_TARGETS; b++) s.buffers[b] = UNKNOWN;
+        for (int c = 0; c < CAPS; c++) s.caps[c] = -1;
+        s.blendSrc = s.blendDst = s.blendSrcAlpha = s.blendDstAlpha = UNKNOWN;
+        s.depthFunc = UNKNOWN;
+        s.depthMask = -1;
+        s.colorMask = -1;
+        s.polygonMode = UNKNOWN;
+        s.cullFace = UNKNOWN;
+    }
+
+    static void useProgram(GLuint program)
+    {
+        if (changed(state().program, program)) {
+            glUseProgram(program);
+            RenderStats::frame().programSwitches++;
+        }
+    }
+
+    static void bindVertexArray(GLuint vao)
+    {
+        if (changed(state().vertexArray, vao)) glBindVertexArray(vao);
+    }
+
+    static void activeTexture(GLenum unit)
+    {
+        if (changed(state().activeUnit, unit)) glActiveTexture(unit);
+    }
+
+    // Leagă pe unitatea activă, ca glBindTexture
+    static void bindTexture(GLenum target, GLuint texture)
+    {
+        State& s = state();
+        int unit = s.activeUnit == UNKNOWN ? -1 : (int)(s.activeUnit - GL_TEXTURE0);
+        int t = textureTarget(target);
+        if (unit < 0 || unit >= MAX_TEXTURE_UNITS || t < 0) {
+            issue();
+            glBindTexture(target, texture);
+            return;
+        }
+        if (changed(s.textures[unit][t], texture)) glBindTexture(target, texture);
+    }
+
+    static void bindSampler(GLuint unit, GLuint sampler)
+    {
+        if (unit >= (GLuint)MAX_TEXTURE_UNITS) {
+            issue();
+            glBindSampler(unit, sampler);
+            return;
+        }
+        if (changed(state().samplers[unit], sampler)) glBindSampler(unit, sampler);
+    }
+
+    // GL_ELEMENT_ARRAY_BUFFER aparține VAO-ului legat și nu e reținut niciodată
+    static void bindBuffer(GLenum target, GLuint buffer)
+    {
+        int b = bufferTarget(target);
+        if (b < 0) {
+            issue();
+            glBindBuffer(target, buffer);
+            return;
+        }
+        if (changed(state().buffers[b], buffer)) glBindBuffer(target, buffer);
+    }
+
+    // Legăturile indexate nu sunt reținute, dar glBindBufferBase înlocuiește
+    // și legătura generică a lui target, deci aceea e actualizată
+    static void bindBufferBase(GLenum target, GLuint index, GLuint buffer)
+    {
+        issue();
+        glBindBufferBase(target, index, buffer);
+        int b = bufferTarget(target);
+        if (b >= 0) state().buffers[b] = buffer;
+    }
+
+    static void enable(GLenum cap) { setCap(cap, true); }
+    static void disable(GLenum cap) { setCap(cap, false); }
+
+    static void blendFunc(GLenum src, GLenum dst) { blendFuncSeparate(src, dst, src, dst); }
+
+    static void blendFuncSeparate(GLenum src, GLenum dst, GLenum srcAlpha, GLenum dstAlpha)
+    {
+        State& s = state();
+        if (s.blendSrc == src && s.blendDst == dst && s.blendSrcAlpha == srcAlpha && s.blendDstAlpha == dstAlpha) {
+            elide();
+            return;
+        }
+        s.blendSrc = src;
+        s.blendDst = dst;
+        s.blendSrcAlpha = srcAlpha;
+        s.blendDstAlpha = dstAlpha;
+        issue();
+        glBlendFuncSeparate(src, dst, srcAlpha, dstAlpha);
+    }
+
+    static void depthFunc(GLenum func)
+    {
+        if (changed(state().depthFunc, func)) glDepthFunc(func);
+    }
+
+    static void depthMask(GLboolean flag)
+    {
+        if (changedFlag(state().depthMask, flag ? 1 : 0)) glDepthMask(flag);
+    }
+
+    // Toate cele patru canale odată, singurul mod în care e folosit aici
+    static void colorMask(GLboolean flag)
+    {
+        if (changedFlag(state().colorMask, flag ? 1 : 0)) glColorMask(flag, flag, flag, flag);
+    }
+
+    // Profilul core acceptă doar GL_FRONT_AND_BACK
+    static void polygonMode(GLenum mode)
+    {
+        if (changed(state().polygonMode, mode)) glPolygonMode(GL_FRONT_AND_BACK, mode);
+    }
+
+    static void cullFace(GLenum face)
+    {
+        if (changed(state().cullFace, face)) glCullFace(face);
+    }
+
+    static void deleteTextures(GLsizei n, const GLuint* textures)
+    {
+        State& s = state();
+        for (GLsizei i = 0; i < n; i++) {
+            if (!textures[i]) continue;
+            for (int u = 0; u < MAX_TEXTURE_UNITS; u++)
+                for (int t = 0; t < TEXTURE_TARGETS; t++)
+                    if (s.textures[u][t] == textures[i]) s.textures[u][t] = 0;
+        }
+        glDeleteTextures(n, textures);
+    }
+
+    static void deleteBuffers(GLsizei n, const GLuint* buffers)
+    {
+        State& s = state();
+        for (GLsizei i = 0; i < n; i++) {
+            if (!buffers[i]) continue;
+            for (int b = 0; b < BUFFER_TARGETS; b++)
+                if (s.buffers[b] == buffers[i]) s.buffers[b] = 0;
+        }
+        glDeleteBuffers(n, buffers);
+    }
+
+    static void deleteVertexArrays(GLsizei n, const GLuint* arrays)
+    {
+        State& s = state();
+        for (GLsizei i = 0; i < n; i++) {
+            if (arrays[i] && s.vertexArray == arrays[i]) s.vertexArray = 0;
+        }
+        glDeleteVertexArrays(n, arrays);
+    }
+
+    static void deleteSamplers(GLsizei n, const GLuint* samplers)
+    {
+        State& s = state();
+        for (GLsizei i = 0; i < n; i++) {
+            if (!samplers[i]) continue;
+            for (int u = 0; u < MAX_TEXTURE_UNITS; u++)
+                if (s.samplers[u] == samplers[i]) s.samplers[u] = 0;
+        }
+        glDeleteSamplers(n, samplers);
+    }
+
+    // Un program șters rămâne în uz până se leagă altul, așa că numele reținut
+    // e doar uitat, nu pus pe 0
+    static void deleteProgram(GLuint program)
+    {
+        if (program && state().program == program) state().program = UNKNOWN;
+        glDeleteProgram(program);
+    }
+
+private:
+    static const GLuint UNKNOWN = 0xFFFFFFFFu;
+    static const int TEXTURE_TARGETS = 5;
+    static const int BUFFER_TARGETS = 5;
+    static const int CAPS = 7;
+
+    struct State {
+        GLuint program;
+        GLuint vertexArray;
+        GLuint activeUnit;
+        GLuint textures[MAX_TEXTURE_UNITS][TEXTURE_TARGETS];
+        GLuint samplers[MAX_TEXTURE_UNITS];
+        GLuint buffers[BUFFER_TARGETS];
+        int caps[CAPS]; // -1 = necunoscut
+        GLuint blendSrc, blendDst, blendSrcAlpha, blendDstAlpha;
+        GLuint depthFunc;
+        int depthMask;
+        int colorMask;
+        GLuint polygonMode;
+        GLuint cullFace;
+    };
+
+    static State& state()
+    {
+        static State s;
+        static bool initialized = false;
+        if (!initialized) {
+            initialized = true;
+            invalidate();
+        }
+        return s;
+    }
+
+    static void issue() { RenderStats::frame().glCallsIssued++; }
+    static void elide() { RenderStats::frame().glCallsElided++; }
+
+    static bool changed(GLuint& cached, GLuint value)
+    {
+        if (cached == value) {
+            elide();
+            return false;
+        }
+        cached = value;
+        issue();
+        return true;
+    }
+
+    static bool changedFlag(int& cached, int value)
+    {
+        if (cached == value) {
+            elide();
+            return false;
+        }
+        cached = value;
+        issue();
+        return true;
+    }
+
+    static int textureTarget(GLenum target)
+    {
+        switch (target) {
+            case GL_TEXTURE_2D: return 0;
+            case GL_TEXTURE_2D_ARRAY: return 1;
+            case GL_TEXTURE_CUBE_MAP: return 2;
+            case GL_TEXTURE_BUFFER: return 3;
+            case GL_TEXTURE_3D: return 4;
+            default: return -1;
+        }
+    }
+
+    static int bufferTarget(GLenum target)
+    {
+        switch (target) {
+            case GL_ARRAY_BUFFER: return 0;
+            case GL_TEXTURE_BUFFER: return 1;
+            case GL_UNIFORM_BUFFER: return 2;
+            case GL_TRANSFORM_FEEDBACK_BUFFER: return 3;
+            case GL_DRAW_INDIRECT_BUFFER: return 4;
+            default: return -1;
+        }
+    }
+
+    static int capIndex(GLenum cap)
+    {
+        switch (cap) {
+            case GL_DEPTH_TEST: return 0;
+            case GL_CULL_FACE: return 1;
+            case GL_BLEND: return 2;
+            case GL_PROGRAM_POINT_SIZE: return 3;
+            case GL_DEPTH_CLAMP: return 4;
+            case GL_MULTISAMPLE: return 5;
+            case GL_RASTERIZER_DISCARD: return 6;
+            default: return -1;
+        }
+    }
+
+    static void setCap(GLenum cap, bool on)
+    {
+        int c = capIndex(cap);
+        if (c >= 0 && !changedFlag(state().caps[c], on ? 1 : 0)) return;
+        if (c < 0) issue();
+        if (on) glEnable(cap);
+        else glDisable(cap);
+    }
+};
+
+#endif
@@ -0,0 +1,343 @@
+#pragma once
+#ifndef GeometryPool_h
+#define GeometryPool_h
+
+#if defined (__APPLE__)
+#define GLFW_INCLUDE_GLCOREARB
+#else
+#define GLEW_STATIC
+#include <GL/glew.h>
+#endif
+
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include <algorithm>
+#include <initializer_list>
+#include <iostream>
+#include "GLState.h"
+#include "RenderStats.h"
+#include "GLCapabilities.h"
+
+// Locul unui mesh într-un GeometryPool. Indicii sunt relativi la baseVertex,
+// deci desenele folosesc funcțiile *BaseVertex.
+struct PoolAllocation {
+    int baseVertex, vertexCount;
+    int firstIndex, indexCount;
+
+    PoolAllocation() : baseVertex(-1), vertexCount(0), firstIndex(-1), indexCount(0) {}
+    bool valid() const { return baseVertex >= 0; }
+};
+
+// Listă de spații libere first-fit peste [0, capacity) elemente. Intervalele
+// eliberate sunt unite cu vecinii lor liberi.
+class RangeAllocator
+{
+public:
+    int capacity;
+    int used;
+
+    RangeAllocator() : capacity(0), used(0) {}
+
+    void reset(int size)
+    {
+        capacity = size;
+        used = 0;
+        freeRanges.clear();
+        if (size > 0) freeRanges.push_back(Range{ 0, size });
+    }
+
+    // Întoarce offsetul, sau -1 când niciun interval liber nu e destul de mare
+    int allocate(int count)
+    {
+        for (size_t i = 0; i < freeRanges.size(); i++) {
+            Range& r = freeRanges[i];
+            if (r.count < count) continue;
+            int offset = r.offset;
+            r.offset += count;
+            r.count -= count;
+            if (r.count == 0) freeRanges.erase(freeRanges.begin() + i);
+            used += count;
+            return offset;
+        }
+        return -1;
+    }
+
+    void release(int offset, int count)
+    {
+        if (count <= 0) return;
+        used -= count;
+        insertFree(offset, count);
+    }
+
+    void grow(int newCapacity)
+    {
+        if (newCapacity <= capacity) return;
+        insertFree(capacity, newCapacity - capacity);
+        capacity = newCapacity;
+    }
+
+    int largestFree() const
+    {
+        int largest = 0;
+        for (const Range& r : freeRanges) largest = std::max(largest, r.count);
+        return largest;
+    }
+
+    int holes() const { return (int)freeRanges.size(); }
+
+    float occupancy() const { return capacity > 0 ? (float)used / (float)capacity : 0.0f; }
+
+    // 0 = tot spațiul liber într-un bloc, spre 1 = spart în găuri mici
+    float fragmentation() const
+    {
+        int freeCount = capacity - used;
+        return freeCount > 0 ? 1.0f - (float)largestFree() / (float)freeCount : 0.0f;
+    }
+
+private:
+    struct Range {
+        int offset, count;
+    };
+    std::vector<Range> freeRanges; // sortate după offset
+
+    void insertFree(int offset, int count)
+    {
+        size_t i = 0;
+        while (i < freeRanges.size() && freeRanges[i].offset < offset) i++;
+        freeRanges.insert(freeRanges.begin() + i, Range{ offset, count });
+
+        // Unește cu intervalul următor, apoi cu cel anterior
+        if (i + 1 < freeRanges.size() && freeRanges[i].offset + freeRanges[i].count == freeRanges[i + 1].offset) {
+            freeRanges[i].count += freeRanges[i + 1].count;
+            freeRanges.erase(freeRanges.begin() + i + 1);
+        }
+        if (i > 0 && freeRanges[i - 1].offset + freeRanges[i - 1].count == freeRanges[i].offset) {
+            freeRanges[i - 1].count += freeRanges[i].count;
+            freeRanges.erase(freeRanges.begin() + i);
+        }
+    }
+};
+
+// Buffer comun de vârfuri + indici pentru toate mesh-urile statice cu același
+// format de vârf, cu un singur VAO. Mesh-urile sunt sub-alocate și desenate cu
+// offseturi de bază, deci trecerea de la un model la altul nu mai schimbă
+// VAO-ul. Bufferele cresc prin copiere pe GPU când un mesh nu încape.
+class GeometryPool
+{
+public:
+    GLuint vao;
+    GLuint vertexBuffer, indexBuffer;
+    RangeAllocator vertices, indices;
+    int stride; // float-uri pe vârf
+
+    // pos(3) normal(3) uv(2) color(3): grupurile de material din Model și solul
+    static GeometryPool& meshes()
+    {
+        static GeometryPool pool("mesh", { 3, 3, 2, 3 });
+        return pool;
+    }
+
+    // Copii doar cu poziții pentru trecerea de umbră și depth prepass
+    static GeometryPool& positions()
+    {
+        static GeometryPool pool("depth", { 3 });
+        return pool;
+    }
+
+    GeometryPool(const char* poolName, std::initializer_list<int> sizes)
+        : vao(0), vertexBuffer(0), indexBuffer(0), stride(0), name(poolName),
+          attributeSizes(sizes), instanceBuffer(0), instanceOffset(0)
+    {
+        for (int size : attributeSizes) stride += size;
+    }
+
+    GeometryPool(const GeometryPool&) = delete;
+    GeometryPool& operator=(const GeometryPool&) = delete;
+
+    PoolAllocation allocate(const std::vector<float>& vertexData, const std::vector<unsigned int>& indexData)
+    {
+        PoolAllocation a;
+        int vertexCount = (int)(vertexData.size() / stride);
+        int indexCount = (int)indexData.size();
+        if (vertexCount == 0 || indexCount == 0) return a;
+
+        if (!vao) create(65536, 262144);
+
+        int baseVertex = vertices.allocate(vertexCount);
+        if (baseVertex < 0) {
+            resize(vertexBuffer, vertices, vertexCount, GL_ARRAY_BUFFER);
+            baseVertex = vertices.allocate(vertexCount);
+        }
+        int firstIndex = indices.allocate(indexCount);
+        if (firstIndex < 0) {
+            resize(indexBuffer, indices, indexCount, GL_ELEMENT_ARRAY_BUFFER);
+            firstIndex = indices.allocate(indexCount);
+        }
+
+        GLState::bindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+        glBufferSubData(GL_ARRAY_BUFFER, (GLintptr)baseVertex * stride * sizeof(float),
+            vertexData.size() * sizeof(float), vertexData.data());
+        GLState::bindVertexArray(vao);
+        glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, (GLintptr)firstIndex * sizeof(unsigned int),
+            indexData.size() * sizeof(unsigned int), indexData.data());
+
+        a.baseVertex = baseVertex;
+        a.vertexCount = vertexCount;
+        a.firstIndex = firstIndex;
+        a.indexCount = indexCount;
+        return a;
+    }
+
+    void release(PoolAllocation& a)
+    {
+        if (!a.valid()) return;
+        vertices.release(a.baseVertex, a.vertexCount);
+        indices.release(a.firstIndex, a.indexCount);
+        a = PoolAllocation();
+    }
+
+    void bind() { GLState::bindVertexArray(vao); }
+
+    // Îndreaptă atributele matricei pe instanță (locațiile 4-7) spre buffer,
+    // începând de la offset octeți. Întoarce false dacă arătau deja acolo.
+    bool bindInstanceBuffer(GLuint buffer, size_t offset = 0)
+    {
+        if (!vao || (buffer == instanceBuffer && offset == instanceOffset)) return false;
+        instanceBuffer = buffer;
+        instanceOffset = offset;
+
+        GLState::bindVertexArray(vao);
+        GLState::bindBuffer(GL_ARRAY_BUFFER, buffer);
+        for (int i = 0; i < 4; i++) {
+            glVertexAttribPointer(4 + i, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (void*)(offset + i * sizeof(glm::vec4)));
+            glEnableVertexAttribArray(4 + i);
+            glVertexAttribDivisor(4 + i, 1);
+        }
+        return true;
+    }
+
+    // Bufferul de instanțe urmează să fie șters
+    void forgetInstanceBuffer(GLuint buffer)
+    {
+        if (instanceBuffer == buffer) instanceBuffer = 0;
+    }
+
+    void draw(int indexCount, int firstIndex, int baseVertex, int instanceCount = 0)
+    {
+        if (indexCount <= 0) return;
+        bind();
+        const void* offset = (const void*)((size_t)firstIndex * sizeof(unsigned int));
+        if (instanceCount > 0) {
+            glDrawElementsInstancedBaseVertex(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, offset, instanceCount, baseVertex);
+        }
+        else {
+            glDrawElementsBaseVertex(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, offset, baseVertex);
+        }
+        RenderStats::frame().drawCalls++;
+    }
+
+    void printStats() const
+    {
+        std::cout << "Geometry pool " << name << ": "
+                  << vertices.used << "/" << vertices.capacity << " vertices ("
+                  << (int)(vertices.occupancy() * 100.0f) << "%, fragmentation "
+                  << (int)(vertices.fragmentation() * 100.0f) << "%, " << vertices.holes() << " holes), "
+                  << indices.used << "/" << indices.capacity << " indices ("
+                  << (int)(indices.occupancy() * 100.0f) << "%, fragmentation "
+                  << (int)(indices.fragmentation() * 100.0f) << "%), "
+                  << (vertices.capacity * stride * sizeof(float) + indices.capacity * sizeof(unsigned int)) / 1024
+                  << " KB" << std::endl;
+    }
+
+    // Trebuie apelat cât contextul GL încă există
+    void release()
+    {
+        if (vao) GLState::deleteVertexArrays(1, &vao);
+        GLuint buffers[2] = { vertexBuffer, indexBuffer };
+        GLState::deleteBuffers(2, buffers);
+        vao = vertexBuffer = indexBuffer = 0;
+        instanceBuffer = 0;
+        vertices.reset(0);
+        indices.reset(0);
+    }
+
+private:
+    const char* name;
+    std::vector<int> attributeSizes;
+    GLuint instanceBuffer;
+    size_t instanceOffset;
+
+    void create(int vertexCapacity, int indexCapacity)
+    {
+        glGenVertexArrays(1, &vao);
+        glGenBuffers(1, &vertexBuffer);
+        glGenBuffers(1, &indexBuffer);
+        vertices.reset(vertexCapacity);
+        indices.reset(indexCapacity);
+
+        GLState::bindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+        allocateStorage(GL_ARRAY_BUFFER, (GLsizeiptr)vertexCapacity * stride * sizeof(float));
+        GLState::bindVertexArray(vao);
+        GLState::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+        allocateStorage(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)indexCapacity * sizeof(unsigned int));
+        setupAttributes();
+    }
+
+    void setupAttributes()
+    {
+        GLState::bindVertexArray(vao);
+        GLState::bindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+        int offset = 0;
+        for (size_t i = 0; i < attributeSizes.size(); i++) {
+            glVertexAttribPointer((GLuint)i, attributeSizes[i], GL_FLOAT, GL_FALSE, stride * sizeof(float),
+                (void*)(offset * sizeof(float)));
+            glEnableVertexAttribArray((GLuint)i);
+            offset += attributeSizes[i];
+        }
+    }
+
+    // Stocarea imutabilă lasă driverul să plaseze bufferul o dată pentru
+    // totdeauna; pool-urile îl scriu doar cu glBufferSubData și nu îl
+    // redimensionează pe loc
+    static void allocateStorage(GLenum target, GLsizeiptr bytes)
+    {
+#if !defined(__APPLE__)
+        if (GLCapabilities::get().useBufferStorage) {
+            glBufferStorage(target, bytes, nullptr, GL_DYNAMIC_STORAGE_BIT);
+            return;
+        }
+#endif
+        glBufferData(target, bytes, nullptr, GL_STATIC_DRAW);
+    }
+
+    // Dublează bufferul (sau mai mult, ca să încapă `needed`) și copiază
+    // conținutul vechi în el pe GPU
+    void resize(GLuint& buffer, RangeAllocator& allocator, int needed, GLenum target)
+    {
+        size_t elementSize = target == GL_ARRAY_BUFFER ? stride * sizeof(float) : sizeof(unsigned int);
+        int newCapacity = std::max(allocator.capacity * 2, allocator.capacity + needed);
+
+        GLuint newBuffer;
+        glGenBuffers(1, &newBuffer);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, newBuffer);
+        allocateStorage(GL_COPY_WRITE_BUFFER, (GLsizeiptr)newCapacity * elementSize);
+        glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, (GLsizeiptr)allocator.capacity * elementSize);
+        GLState::deleteBuffers(1, &buffer);
+        buffer = newBuffer;
+        allocator.grow(newCapacity);
+
+        if (target == GL_ARRAY_BUFFER) {
+            setupAttributes();
+        }
+        else {
+            GLState::bindVertexArray(vao);
+            GLState::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+        }
+        std::cout << "Geometry pool " << name << " grown to " << newCapacity
+                  << (target == GL_ARRAY_BUFFER ? " vertices" : " indices") << std::endl;
+    }
+};
+
+#endif
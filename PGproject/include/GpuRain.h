@@ -0,0 +1,136 @@
+#pragma once
+#ifndef GpuRain_h
+#define GpuRain_h
+
+#if defined (__APPLE__)
+#define GLFW_INCLUDE_GLCOREARB
+#else
+#define GLEW_STATIC
+#include <GL/glew.h>
+#endif
+
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include <iostream>
+#include "Shader.h"
+#include "GLState.h"
+#include "RenderStats.h"
+#include "RainSimulation.h"
+#include "RainOcclusion.h"
+
+// Picături de ploaie simulate în întregime pe GPU. Particulele (vec4: poziție,
+// viteza de cădere) stau în două buffere; la fiecare cadru rain_update.vert
+// citește unul și scrie în celălalt prin transform feedback, cu rasterizarea
+// oprită. Se desenează bufferul tocmai scris, deci după inițializare CPU-ul nu
+// mai atinge și nu mai încarcă date de particule.
+class GpuRain
+{
+public:
+    int particleCount;
+
+    GpuRain() : particleCount(0), current(0), frame(0), needsRespawn(true)
+    {
+        buffers[0] = buffers[1] = 0;
+        vaos[0] = vaos[1] = 0;
+        drawVaos[0] = drawVaos[1] = 0;
+    }
+
+    void init(int count)
+    {
+        particleCount = count;
+        updateShader.loadFeedbackShader("shaders/rain_update.vert", { "outParticle" });
+
+        glGenBuffers(2, buffers);
+        glGenVertexArrays(2, vaos);
+        glGenVertexArrays(2, drawVaos);
+        for (int i = 0; i < 2; i++) {
+            GLState::bindBuffer(GL_ARRAY_BUFFER, buffers[i]);
+            glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)count * sizeof(glm::vec4), nullptr, GL_DYNAMIC_COPY);
+
+            // rain_update.vert citește tot vec4-ul
+            GLState::bindVertexArray(vaos[i]);
+            glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(glm::vec4), (void*)0);
+            glEnableVertexAttribArray(0);
+
+            // rain.vert citește x, y și z ca float-uri separate
+            GLState::bindVertexArray(drawVaos[i]);
+            for (int c = 0; c < 3; c++) {
+                glVertexAttribPointer(c, 1, GL_FLOAT, GL_FALSE, sizeof(glm::vec4), (void*)(c * sizeof(float)));
+                glEnableVertexAttribArray(c);
+            }
+        }
+        GLState::bindVertexArray(0);
+        needsRespawn = true;
+
+        std::cout << "GPU rain initialized with " << count << " particles ("
+                  << (2 * (size_t)count * sizeof(glm::vec4)) / 1024 << " KB)" << std::endl;
+    }
+
+    // Trebuie apelat cât contextul GL încă există
+    void release()
+    {
+        GLState::deleteVertexArrays(2, vaos);
+        GLState::deleteVertexArrays(2, drawVaos);
+        GLState::deleteBuffers(2, buffers);
+        GLState::deleteProgram(updateShader.shaderProgram);
+        vaos[0] = vaos[1] = drawVaos[0] = drawVaos[1] = buffers[0] = buffers[1] = 0;
+    }
+
+    // Următoarea actualizare împrăștie din nou toate picăturile în volum
+    void respawn() { needsRespawn = true; }
+
+    // Aceleași reguli ca RainSimulation::updateRange; shaderul readuce x / z
+    // în volum cu mod, deci orice salt al camerei e absorbit într-un cadru.
+    // Picăturile se opresc și pe suprafețele din occlusion, când e dat.
+    void update(float deltaTime, const glm::vec2& windVelocity, const RainVolume& volume,
+        RainOcclusion* occlusion = nullptr)
+    {
+        if (particleCount == 0) return;
+
+        updateShader.useShaderProgram();
+        updateShader.setFloat("deltaTime", deltaTime);
+        updateShader.setVec2("windVelocity", windVelocity);
+        updateShader.setBool("respawnAll", needsRespawn);
+        updateShader.setVec3("volumeMin", glm::vec3(volume.minX, volume.minY, volume.minZ));
+        updateShader.setVec3("volumeSize", glm::vec3(volume.sizeX, volume.sizeY, volume.sizeZ));
+        updateShader.setBool("occlusionEnabled", occlusion != nullptr);
+        if (occlusion) occlusion->apply(updateShader, 0);
+        glUniform1ui(glGetUniformLocation(updateShader.shaderProgram, "frameSeed"), frame++);
+        RenderStats::frame().uniformUploads++;
+        needsRespawn = false;
+
+        int next = 1 - current;
+        GLState::enable(GL_RASTERIZER_DISCARD);
+        GLState::bindVertexArray(vaos[current]);
+        GLState::bindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, buffers[next]);
+        glBeginTransformFeedback(GL_POINTS);
+        glDrawArrays(GL_POINTS, 0, particleCount);
+        glEndTransformFeedback();
+        GLState::bindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+        GLState::disable(GL_RASTERIZER_DISCARD);
+        RenderStats::frame().drawCalls++;
+
+        current = next;
+    }
+
+    // Desenează ultimele poziții ca puncte, cu programul legat
+    void draw()
+    {
+        if (particleCount == 0) return;
+        GLState::bindVertexArray(drawVaos[current]);
+        glDrawArrays(GL_POINTS, 0, particleCount);
+        RenderStats::frame().drawCalls++;
+    }
+
+private:
+    GLuint buffers[2];
+    GLuint vaos[2];     // trecerea de actualizare
+    GLuint drawVaos[2]; // desenarea, aceleași buffere
+    int current; // bufferul cu ultima stare
+    unsigned int frame;
+    bool needsRespawn;
+    Shader updateShader;
+};
+
+#endif
@@ -0,0 +1,78 @@
+#pragma once
+#ifndef GpuSampleCounter_h
+#define GpuSampleCounter_h
+
+#if defined (__APPLE__)
+#define GLFW_INCLUDE_GLCOREARB
+#else
+#define GLEW_STATIC
+#include <GL/glew.h>
+#endif
+
+#include <GLFW/glfw3.h>
+
+// Numără eșantioanele care trec testul de adâncime într-un bloc de comenzi GL,
+// cu interogări de ocluzie GL_SAMPLES_PASSED. Folosește același inel de
+// interogări ca GpuTimer, deci lastSamples e vechi de câteva cadre și citirea
+// lui nu blochează niciodată.
+class GpuSampleCounter
+{
+public:
+    GLuint64 lastSamples;
+    bool hasResult;
+
+    GpuSampleCounter() : lastSamples(0), hasResult(false), current(0), initialized(false)
+    {
+        for (int i = 0; i < QUERY_COUNT; i++) pending[i] = false;
+    }
+
+    // Trebuie apelat cât contextul GL încă există
+    void release()
+    {
+        if (initialized) glDeleteQueries(QUERY_COUNT, queries);
+        initialized = false;
+    }
+
+    void begin()
+    {
+        if (!initialized) {
+            glGenQueries(QUERY_COUNT, queries);
+            initialized = true;
+        }
+
+        if (pending[current]) {
+            collect(current);
+        }
+        glBeginQuery(GL_SAMPLES_PASSED, queries[current]);
+    }
+
+    void end()
+    {
+        glEndQuery(GL_SAMPLES_PASSED);
+        pending[current] = true;
+        current = (current + 1) % QUERY_COUNT;
+
+        for (int i = 0; i < QUERY_COUNT; i++) {
+            if (!pending[i] || i == current) continue;
+            GLint available = 0;
+            glGetQueryObjectiv(queries[i], GL_QUERY_RESULT_AVAILABLE, &available);
+            if (available) collect(i);
+        }
+    }
+
+private:
+    static const int QUERY_COUNT = 4;
+    GLuint queries[QUERY_COUNT];
+    bool pending[QUERY_COUNT];
+    int current;
+    bool initialized;
+
+    void collect(int index)
+    {
+        glGetQueryObjectui64v(queries[index], GL_QUERY_RESULT, &lastSamples);
+        pending[index] = false;
+        hasResult = true;
+    }
+};
+
+#endif
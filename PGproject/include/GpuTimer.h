@@ -0,0 +1,84 @@
+#pragma once
+#ifndef GpuTimer_h
+#define GpuTimer_h
+
+#if defined (__APPLE__)
+#define GLFW_INCLUDE_GLCOREARB
+#else
+#define GLEW_STATIC
+#include <GL/glew.h>
+#endif
+
+#include <GLFW/glfw3.h>
+#include "GLCapabilities.h"
+
+// Măsoară timpul GPU al unui bloc de comenzi GL cu interogări GL_TIME_ELAPSED.
+// Mai multe interogări sunt în zbor, ca citirea unui rezultat să nu oprească
+// niciodată pipeline-ul; de aceea lastMs e vechi de câteva cadre.
+// Un singur GpuTimer poate rula la un moment dat (GL nu le imbrică).
+// Fără suport pentru timer query, begin/end nu fac nimic și lastMs rămâne 0.
+class GpuTimer
+{
+public:
+    double lastMs;
+
+    GpuTimer() : lastMs(0.0), current(0), initialized(false)
+    {
+        for (int i = 0; i < QUERY_COUNT; i++) pending[i] = false;
+    }
+
+    // Trebuie apelat cât contextul GL încă există
+    void release()
+    {
+        if (initialized) glDeleteQueries(QUERY_COUNT, queries);
+        initialized = false;
+    }
+
+    void begin()
+    {
+        if (!GLCapabilities::get().timerQuery) return;
+        if (!initialized) {
+            glGenQueries(QUERY_COUNT, queries);
+            initialized = true;
+        }
+
+        // Preia rezultatul interogării pe care urmează să o refolosim
+        if (pending[current]) {
+            GLuint64 elapsed = 0;
+            glGetQueryObjectui64v(queries[current], GL_QUERY_RESULT, &elapsed);
+            lastMs = elapsed / 1000000.0;
+            pending[current] = false;
+        }
+        glBeginQuery(GL_TIME_ELAPSED, queries[current]);
+    }
+
+    void end()
+    {
+        if (!GLCapabilities::get().timerQuery) return;
+        glEndQuery(GL_TIME_ELAPSED);
+        pending[current] = true;
+        current = (current + 1) % QUERY_COUNT;
+
+        // Preia orice rezultat deja disponibil, fără să aștepte
+        for (int i = 0; i < QUERY_COUNT; i++) {
+            if (!pending[i] || i == current) continue;
+            GLint available = 0;
+            glGetQueryObjectiv(queries[i], GL_QUERY_RESULT_AVAILABLE, &available);
+            if (available) {
+                GLuint64 elapsed = 0;
+                glGetQueryObjectui64v(queries[i], GL_QUERY_RESULT, &elapsed);
+                lastMs = elapsed / 1000000.0;
+                pending[i] = false;
+            }
+        }
+    }
+
+private:
+    static const int QUERY_COUNT = 4;
+    GLuint queries[QUERY_COUNT];
+    bool pending[QUERY_COUNT];
+    int current;
+    bool initialized;
+};
+
+#endif
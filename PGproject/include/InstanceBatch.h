@@ -0,0 +1,111 @@
+#pragma once
+#ifndef InstanceBatch_h
+#define InstanceBatch_h
+
+#if defined (__APPLE__)
+#define GLFW_INCLUDE_GLCOREARB
+#else
+#define GLEW_STATIC
+#include <GL/glew.h>
+#endif
+
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include "Model.h"
+#include "Shader.h"
+#include "GLState.h"
+#include "StreamBuffer.h"
+
+// Adună matricele de lume ale tuturor copiilor unui Model într-un cadru și
+// le desenează cu un singur apel instanțiat pe grup de material.
+class InstanceBatch
+{
+public:
+    Model* model;
+    GLuint instanceVBO;
+    std::vector<glm::mat4> matrices;
+
+    // Unde au fost scrise matricele cadrului: un interval din stream buffer,
+    // sau instanceVBO de la offset 0 când inelul e oprit
+    GLuint drawBuffer;
+    size_t drawOffset;
+
+    InstanceBatch() : model(nullptr), instanceVBO(0), drawBuffer(0), drawOffset(0), capacity(0) {}
+    InstanceBatch(const InstanceBatch&) = delete;
+    InstanceBatch& operator=(const InstanceBatch&) = delete;
+
+    ~InstanceBatch()
+    {
+        if (instanceVBO) {
+            GeometryPool::meshes().forgetInstanceBuffer(instanceVBO);
+            GeometryPool::positions().forgetInstanceBuffer(instanceVBO);
+            GLState::deleteBuffers(1, &instanceVBO);
+        }
+    }
+
+    void init(Model* targetModel, int initialCapacity = 64)
+    {
+        model = targetModel;
+        capacity = initialCapacity;
+
+        glGenBuffers(1, &instanceVBO);
+        GLState::bindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+        glBufferData(GL_ARRAY_BUFFER, capacity * sizeof(glm::mat4), nullptr, GL_STREAM_DRAW);
+        GLState::bindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    void clear() { matrices.clear(); }
+
+    void add(const glm::mat4& matrix) { matrices.push_back(matrix); }
+
+    int count() const { return (int)matrices.size(); }
+
+    // Încarcă matricele cadrului în stream buffer, sau mai întâi orfanizează
+    // instanceVBO, ca driverul să nu aștepte terminarea desenelor din cadrul
+    // anterior.
+    void upload()
+    {
+        if (matrices.empty()) return;
+
+        size_t bytes = matrices.size() * sizeof(glm::mat4);
+        StreamBuffer& stream = StreamBuffer::get();
+        if (stream.enabled) {
+            StreamAllocation a = stream.upload(matrices.data(), bytes);
+            if (a.valid()) {
+                drawBuffer = a.buffer;
+                drawOffset = a.offset;
+                return;
+            }
+        }
+
+        size_t capacityBytes = (size_t)capacity * sizeof(glm::mat4);
+        StreamBuffer::orphanUpload(GL_ARRAY_BUFFER, instanceVBO, capacityBytes, matrices.data(), bytes);
+        capacity = (int)(capacityBytes / sizeof(glm::mat4));
+        GLState::bindBuffer(GL_ARRAY_BUFFER, 0);
+        drawBuffer = instanceVBO;
+        drawOffset = 0;
+    }
+
+    void draw(Shader& shader)
+    {
+        if (!model || matrices.empty()) return;
+
+        model->bindInstanceBuffer(drawBuffer, drawOffset);
+        model->drawInstanced(shader, count());
+    }
+
+    // Doar pozițiile, fără starea materialului (trecerea de umbră, depth prepass)
+    void drawDepth()
+    {
+        if (!model || matrices.empty()) return;
+
+        model->bindInstanceBuffer(drawBuffer, drawOffset);
+        model->drawDepthInstanced(count());
+    }
+
+private:
+    int capacity;
+};
+
+#endif
@@ -0,0 +1,195 @@
+#pragma once
+#ifndef LowResParticles_h
+#define LowResParticles_h
+
+#if defined (__APPLE__)
+#define GLFW_INCLUDE_GLCOREARB
+#else
+#define GLEW_STATIC
+#include <GL/glew.h>
+#endif
+
+#include <GLFW/glfw3.h>
+#include <iostream>
+#include "Shader.h"
+#include "GLState.h"
+#include "RenderStats.h"
+
+// Țintă în afara ecranului pentru particulele cu blending (ploaie, molii,
+// frunze) la 1/2 sau 1/4 din rezoluția ferestrei, ca umplerea și blendingul
+// lor să coste de 4 sau de 16 ori mai puțin.
+//
+// begin() reduce adâncimea scenei în bufferul de adâncime al țintei, păstrând
+// cea mai apropiată adâncime din fiecare bloc scale x scale, așa că
+// particulele rămân ascunse în spatele geometriei. Particulele se amestecă apoi
+// într-un buffer de culoare golit la (0, 0, 0, 1): rgb adună culoarea
+// premultiplicată, iar alpha transmitanța (funcțiile de blend scriu alpha cu
+// GL_ZERO, GL_ONE_MINUS_SRC_ALPHA). end() o compune peste fereastră cu o
+// mărire bilaterală: din cei patru texeli de rezoluție redusă din jurul unui
+// pixel, cei cu adâncimea apropiată de a pixelului primesc cea mai mare
+// pondere, așa că particulele nu trec peste siluete.
+//
+// Cu rezoluție dinamică scena e randată în colțul unei ținte mai mari, a cărei
+// mărime se schimbă la fiecare cadru: ținta de rezoluție redusă e dimensionată
+// pentru toată textura de adâncime, iar un cadru folosește colțul ei width x height.
+class LowResParticles
+{
+public:
+    int scale;          // 1 = particulele merg direct în fereastră, 2 = jumătate, 4 = sfert
+    int width, height;  // folosite de acest cadru în ținta de rezoluție redusă
+
+    LowResParticles() : scale(2), width(0), height(0), fullWidth(0), fullHeight(0), allocatedWidth(0),
+        allocatedHeight(0), fbo(0), colorTexture(0), depthTexture(0), sceneDepth(0), emptyVAO(0) {}
+
+    bool active() const { return scale > 1; }
+
+    void init()
+    {
+        downsampleShader.loadShader("shaders/fullscreen.vert", "shaders/particle_downsample.frag");
+        upsampleShader.loadShader("shaders/fullscreen.vert", "shaders/particle_upsample.frag");
+        // Profilul core cere un VAO legat chiar și când vârfurile vin din gl_VertexID
+        glGenVertexArrays(1, &emptyVAO);
+    }
+
+    // Leagă ținta de rezoluție redusă, cu adâncimea redusă a colțului w x h
+    // din `depth` (depthWidth x depthHeight) și un buffer de culoare golit;
+    // scrierea adâncimii rămâne oprită
+    void begin(GLuint depth, int w, int h, int depthWidth, int depthHeight)
+    {
+        resize(w, h, depthWidth, depthHeight);
+        sceneDepth = depth;
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        glViewport(0, 0, width, height);
+
+        GLState::disable(GL_BLEND);
+        GLState::colorMask(GL_FALSE);
+        GLState::depthMask(GL_TRUE);
+        GLState::depthFunc(GL_ALWAYS);
+        downsampleShader.useShaderProgram();
+        bindTexture(0, sceneDepth);
+        downsampleShader.setInt("sceneDepth", 0);
+        downsampleShader.setInt("scale", scale);
+        glUniform2i(glGetUniformLocation(downsampleShader.shaderProgram, "sceneSize"), fullWidth, fullHeight);
+        GLState::bindVertexArray(emptyVAO);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        GLState::bindVertexArray(0);
+        GLState::depthFunc(GL_LESS);
+        GLState::colorMask(GL_TRUE);
+        RenderStats::frame().drawCalls++;
+
+        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+        GLState::depthMask(GL_FALSE);
+    }
+
+    // Înapoi la `framebuffer` (fereastra sau ținta scenei), apoi compunerea
+    // bilaterală. nearPlane și farPlane sunt cele ale proiecției cu care a
+    // fost randată adâncimea.
+    void end(GLuint framebuffer, float nearPlane, float farPlane)
+    {
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glViewport(0, 0, fullWidth, fullHeight);
+        GLState::depthMask(GL_TRUE);
+        GLState::disable(GL_DEPTH_TEST);
+        GLState::enable(GL_BLEND);
+        GLState::blendFunc(GL_ONE, GL_SRC_ALPHA); // fereastra * transmitanța + particulele
+
+        upsampleShader.useShaderProgram();
+        bindTexture(0, colorTexture);
+        bindTexture(1, depthTexture);
+        bindTexture(2, sceneDepth);
+        GLState::activeTexture(GL_TEXTURE0);
+        upsampleShader.setInt("lowColor", 0);
+        upsampleShader.setInt("lowDepth", 1);
+        upsampleShader.setInt("sceneDepth", 2);
+        upsampleShader.setFloat("nearPlane", nearPlane);
+        upsampleShader.setFloat("farPlane", farPlane);
+        glUniform2i(glGetUniformLocation(upsampleShader.shaderProgram, "lowSize"), width, height);
+        GLState::bindVertexArray(emptyVAO);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        GLState::bindVertexArray(0);
+        RenderStats::frame().drawCalls++;
+
+        GLState::disable(GL_BLEND);
+        GLState::enable(GL_DEPTH_TEST);
+    }
+
+    // Trebuie apelat cât contextul GL încă există
+    void release()
+    {
+        deleteTargets();
+        if (emptyVAO) GLState::deleteVertexArrays(1, &emptyVAO);
+        if (downsampleShader.shaderProgram) GLState::deleteProgram(downsampleShader.shaderProgram);
+        if (upsampleShader.shaderProgram) GLState::deleteProgram(upsampleShader.shaderProgram);
+        emptyVAO = 0;
+        downsampleShader.shaderProgram = 0;
+        upsampleShader.shaderProgram = 0;
+    }
+
+private:
+    Shader downsampleShader, upsampleShader;
+    int fullWidth, fullHeight;
+    int allocatedWidth, allocatedHeight;
+    GLuint fbo, colorTexture, depthTexture;
+    GLuint sceneDepth; // la rezoluție completă, din begin()
+    GLuint emptyVAO;
+
+    static void bindTexture(int unit, GLuint texture)
+    {
+        GLState::activeTexture(GL_TEXTURE0 + unit);
+        GLState::bindTexture(GL_TEXTURE_2D, texture);
+        GLState::bindSampler(unit, 0);
+    }
+
+    // Recreează țintele când s-a schimbat textura de adâncime sau scara
+    void resize(int w, int h, int depthWidth, int depthHeight)
+    {
+        fullWidth = w;
+        fullHeight = h;
+        width = (w + scale - 1) / scale;
+        height = (h + scale - 1) / scale;
+        int lowWidth = (depthWidth + scale - 1) / scale;
+        int lowHeight = (depthHeight + scale - 1) / scale;
+        if (fbo && allocatedWidth == lowWidth && allocatedHeight == lowHeight) return;
+
+        deleteTargets();
+        allocatedWidth = lowWidth;
+        allocatedHeight = lowHeight;
+
+        colorTexture = createTexture(GL_RGBA16F, GL_RGBA, GL_FLOAT, lowWidth, lowHeight);
+        depthTexture = createTexture(GL_DEPTH_COMPONENT24, GL_DEPTH_COMPONENT, GL_FLOAT, lowWidth, lowHeight);
+        glGenFramebuffers(1, &fbo);
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colorTexture, 0);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depthTexture, 0);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+            std::cout << "ERROR: low-resolution particle framebuffer is incomplete" << std::endl;
+        }
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        std::cout << "Particle target: " << lowWidth << "x" << lowHeight << " (1/" << scale << " of " << depthWidth
+                  << "x" << depthHeight << ")" << std::endl;
+    }
+
+    static GLuint createTexture(GLenum internalFormat, GLenum format, GLenum type, int w, int h)
+    {
+        GLuint texture;
+        glGenTextures(1, &texture);
+        GLState::bindTexture(GL_TEXTURE_2D, texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, w, h, 0, format, type, NULL);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        return texture;
+    }
+
+    void deleteTargets()
+    {
+        if (fbo) glDeleteFramebuffers(1, &fbo);
+        GLuint textures[2] = { colorTexture, depthTexture };
+        GLState::deleteTextures(2, textures);
+        fbo = colorTexture = depthTexture = 0;
+    }
+};
+
+#endif
@@ -16,8 +16,13 @@
 #include <sstream>
 #include <iostream>
 #include <map>
+#include <unordered_map>
+#include <cfloat>
 #include "TextureLoader.h"
 #include "Shader.h"
+#include "RenderStats.h"
+#include "GLState.h"
+#include "GeometryPool.h"
 
 struct Material {
     std::string name;
@@ -26,18 +31,34 @@ struct Material {
     GLuint textureID;
     bool hasTexture;
     bool hasEmission;
+    int sortId; // unic per material, folosit în cheile RenderQueue (vezi nextSortId)
 
     Material() : diffuseColor(1.0f, 1.0f, 1.0f), emissionColor(0.0f, 0.0f, 0.0f), 
-                 textureID(0), hasTexture(false), hasEmission(false) {}
+                 textureID(0), hasTexture(false), hasEmission(false), sortId(0) {}
+
+    // Id-urile sunt globale pentru toate modelele: fiecare loadMTL ia din același contor.
+    // RenderQueue::makeKey păstrează doar 14 biți (& 0x3FFF): de la materialul 16384 încolo
+    // id-urile se suprapun cu ale celor vechi. Randarea rămâne corectă (rulările compară
+    // pointerul materialului), dar materialele cu același id se amestecă la sortare și
+    // schimbările de stare cresc.
+    static int nextSortId()
+    {
+        static int next = 0;
+        if (++next == 0x4000) {
+            std::cout << "WARNING: more than 16383 materials, RenderQueue sort ids now alias" << std::endl;
+        }
+        return next;
+    }
 };
 
 struct MaterialGroup {
     std::string materialName;
-    GLuint VAO, VBO;
     std::vector<float> vertices;
-    int vertexCount;
+    int vertexCount; // colțurile triunghiurilor = numărul de indici
+    int firstIndex;  // primul indice al grupului în GeometryPool::meshes()
+    int depthFirst;  // primul indice al grupului în GeometryPool::positions()
 
-    MaterialGroup() : VAO(0), VBO(0), vertexCount(0) {}
+    MaterialGroup() : vertexCount(0), firstIndex(0), depthFirst(0) {}
 };
 
 class Model
@@ -47,8 +68,15 @@ public:
     std::map<std::string, Material> materials;
     std::string modelDirectory;
     bool hasTexture;
+    glm::vec3 boundsMin;
+    glm::vec3 boundsMax;
+
+    // Locul modelului în bufferele comune: vârfurile complete și copia doar
+    // cu poziții (12 bytes/vertex) pentru shadow map / depth prepass
+    PoolAllocation mesh;
+    PoolAllocation depthMesh;
 
-    Model() : hasTexture(false) {}
+    Model() : hasTexture(false), boundsMin(0.0f), boundsMax(0.0f) {}
 
     bool loadOBJ(const std::string& path)
     {
@@ -144,7 +172,24 @@ public:
 
         file.close();
 
-        // Creează VAO/VBO pentru fiecare material
+        // Bounding box în spațiul local al modelului (folosit pentru culling)
+        boundsMin = glm::vec3(FLT_MAX);
+        boundsMax = glm::vec3(-FLT_MAX);
+        for (auto& pair : materialVertices)
+        {
+            const std::vector<float>& v = pair.second;
+            for (size_t i = 0; i + 2 < v.size(); i += 11)
+            {
+                glm::vec3 p(v[i], v[i + 1], v[i + 2]);
+                boundsMin = glm::min(boundsMin, p);
+                boundsMax = glm::max(boundsMax, p);
+            }
+        }
+        if (materialVertices.empty()) {
+            boundsMin = boundsMax = glm::vec3(0.0f);
+        }
+
+        // Un grup per material, toate în bufferele comune din GeometryPool
         for (auto& pair : materialVertices)
         {
             MaterialGroup group;
@@ -152,75 +197,92 @@ public:
             group.vertices = pair.second;
             group.vertexCount = pair.second.size() / 11;
 
-            setupMaterialGroup(group);
             materialGroups.push_back(group);
 
             std::cout << "  - Material group: " << group.materialName
                 << " (" << group.vertexCount << " vertices)" << std::endl;
         }
 
+        uploadToPools();
+        std::cout << "  - " << mesh.vertexCount << " unique vertices, "
+            << depthMesh.vertexCount << " unique positions" << std::endl;
+
         std::cout << "OBJ loaded successfully:  " << path
             << " (" << materialGroups.size() << " material groups)" << std::endl;
 
         return true;
     }
 
+    // nullptr când grupul nu are material (se desenează alb, fără textură)
+    const Material* findMaterial(const MaterialGroup& group) const
+    {
+        auto it = materials.find(group.materialName);
+        return it != materials.end() ? &it->second : nullptr;
+    }
+
+    // Uniformele de material din basic.frag / gbuffer.frag; nullptr = alb, fără textură
+    static void applyMaterial(Shader& shader, const Material* mat)
+    {
+        GLState::activeTexture(GL_TEXTURE0);
+
+        if (mat)
+        {
+            shader.setBool("hasEmission", mat->hasEmission);
+            shader.setVec3("emissionColor", mat->emissionColor);
+
+            if (mat->hasTexture && mat->textureID != 0) {
+                GLState::bindTexture(GL_TEXTURE_2D, mat->textureID);
+                shader.setInt("diffuseTexture", 0);
+                shader.setBool("useTexture", true);
+                shader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
+            }
+            else {
+                GLState::bindTexture(GL_TEXTURE_2D, 0);
+                shader.setBool("useTexture", false);
+                shader.setVec3("objectColor", mat->diffuseColor);
+            }
+        }
+        else {
+            GLState::bindTexture(GL_TEXTURE_2D, 0);
+            shader.setBool("useTexture", false);
+            shader.setBool("hasEmission", false);
+            shader.setVec3("emissionColor", glm::vec3(0.0f, 0.0f, 0.0f));
+            shader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
+        }
+    }
+
     void draw(Shader& shader)
     {
         static bool debugOnce = true;
         
         for (auto& group : materialGroups)
         {
-            // Bind textura materialului
-            glActiveTexture(GL_TEXTURE0);
-            
-            auto it = materials.find(group.materialName);
-            if (it != materials.end())
-            {
-                Material& mat = it->second;
-                
-                // Setează emission
-                shader.setBool("hasEmission", mat.hasEmission);
-                shader.setVec3("emissionColor", mat.emissionColor);
-                
-                if (mat.hasTexture && mat.textureID != 0) {
-                    if (debugOnce) {
-                        std::cout << "Drawing " << group.materialName << " with texture ID " << mat.textureID << std::endl;
-                    }
-                    glBindTexture(GL_TEXTURE_2D, mat.textureID);
-                    shader.setInt("diffuseTexture", 0);
-                    shader.setBool("useTexture", true);
-                    shader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
-                }
-                else {
-                    if (debugOnce) {
-                        std::cout << "Drawing " << group.materialName << " without texture, color: " 
-                                  << mat.diffuseColor.r << "," << mat.diffuseColor.g << "," << mat.diffuseColor.b 
-                                  << " emission: " << mat.hasEmission << std::endl;
-                    }
-                    glBindTexture(GL_TEXTURE_2D, 0);
-                    shader.setBool("useTexture", false);
-                    shader.setVec3("objectColor", mat.diffuseColor);
-                }
-            }
-            else {
-                if (debugOnce) {
-                    std::cout << "Drawing " << group.materialName << " - material NOT FOUND!" << std::endl;
-                }
-                glBindTexture(GL_TEXTURE_2D, 0);
-                shader.setBool("useTexture", false);
-                shader.setBool("hasEmission", false);
-                shader.setVec3("emissionColor", glm::vec3(0.0f, 0.0f, 0.0f));
-                shader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
+            const Material* mat = findMaterial(group);
+            if (debugOnce) {
+                printMaterialGroup(group, mat);
             }
+            applyMaterial(shader, mat);
 
-            glBindVertexArray(group.VAO);
-            glDrawArrays(GL_TRIANGLES, 0, group.vertexCount);
-            glBindVertexArray(0);
+            GeometryPool::meshes().draw(group.vertexCount, group.firstIndex, mesh.baseVertex);
         }
         
         debugOnce = false;
-        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+
+    // Diagnosticul afișat pentru fiecare material group la primul Model::draw din program
+    static void printMaterialGroup(const MaterialGroup& group, const Material* mat)
+    {
+        if (!mat) {
+            std::cout << "Drawing " << group.materialName << " - material NOT FOUND!" << std::endl;
+        }
+        else if (mat->hasTexture && mat->textureID != 0) {
+            std::cout << "Drawing " << group.materialName << " with texture ID " << mat->textureID << std::endl;
+        }
+        else {
+            std::cout << "Drawing " << group.materialName << " without texture, color: " 
+                      << mat->diffuseColor.r << "," << mat->diffuseColor.g << "," << mat->diffuseColor.b 
+                      << " emission: " << mat->hasEmission << std::endl;
+        }
     }
 
     int vertexCount() const {
@@ -238,40 +300,10 @@ public:
         {
             if (group.materialName != materialName) continue;
             
-            glActiveTexture(GL_TEXTURE0);
-            
-            auto it = materials.find(group.materialName);
-            if (it != materials.end())
-            {
-                Material& mat = it->second;
-                shader.setBool("hasEmission", mat.hasEmission);
-                shader.setVec3("emissionColor", mat.emissionColor);
-                
-                if (mat.hasTexture && mat.textureID != 0) {
-                    glBindTexture(GL_TEXTURE_2D, mat.textureID);
-                    shader.setInt("diffuseTexture", 0);
-                    shader.setBool("useTexture", true);
-                    shader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
-                }
-                else {
-                    glBindTexture(GL_TEXTURE_2D, 0);
-                    shader.setBool("useTexture", false);
-                    shader.setVec3("objectColor", mat.diffuseColor);
-                }
-            }
-            else {
-                glBindTexture(GL_TEXTURE_2D, 0);
-                shader.setBool("useTexture", false);
-                shader.setBool("hasEmission", false);
-                shader.setVec3("emissionColor", glm::vec3(0.0f, 0.0f, 0.0f));
-                shader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
-            }
+            bindMaterial(shader, group);
 
-            glBindVertexArray(group.VAO);
-            glDrawArrays(GL_TRIANGLES, 0, group.vertexCount);
-            glBindVertexArray(0);
+            GeometryPool::meshes().draw(group.vertexCount, group.firstIndex, mesh.baseVertex);
         }
-        glBindTexture(GL_TEXTURE_2D, 0);
     }
 
     // Desenează toate componentele EXCEPTÂND un anumit material
@@ -281,43 +313,130 @@ public:
         {
             if (group.materialName == excludeMaterial) continue;
             
-            glActiveTexture(GL_TEXTURE0);
-            
-            auto it = materials.find(group.materialName);
-            if (it != materials.end())
-            {
-                Material& mat = it->second;
-                shader.setBool("hasEmission", mat.hasEmission);
-                shader.setVec3("emissionColor", mat.emissionColor);
-                
-                if (mat.hasTexture && mat.textureID != 0) {
-                    glBindTexture(GL_TEXTURE_2D, mat.textureID);
-                    shader.setInt("diffuseTexture", 0);
-                    shader.setBool("useTexture", true);
-                    shader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
-                }
-                else {
-                    glBindTexture(GL_TEXTURE_2D, 0);
-                    shader.setBool("useTexture", false);
-                    shader.setVec3("objectColor", mat.diffuseColor);
-                }
+            bindMaterial(shader, group);
+
+            GeometryPool::meshes().draw(group.vertexCount, group.firstIndex, mesh.baseVertex);
+        }
+    }
+
+    // Leagă bufferul cu matricile per-instanță (locațiile 4-7) la VAO-urile comune,
+    // începând de la offset octeți
+    void bindInstanceBuffer(GLuint buffer, size_t offset = 0)
+    {
+        GeometryPool::meshes().bindInstanceBuffer(buffer, offset);
+        GeometryPool::positions().bindInstanceBuffer(buffer, offset);
+    }
+
+    // Desenează instanceCount copii ale modelului, un singur draw call per material group.
+    // Matricile vin din bufferul legat cu bindInstanceBuffer (shaderul trebuie să aibă useInstancing = true)
+    void drawInstanced(Shader& shader, int instanceCount)
+    {
+        if (instanceCount <= 0) return;
+
+        for (auto& group : materialGroups)
+        {
+            bindMaterial(shader, group);
+
+            GeometryPool::meshes().draw(group.vertexCount, group.firstIndex, mesh.baseVertex, instanceCount);
+        }
+        RenderStats::frame().instancesDrawn += instanceCount;
+    }
+
+    // Adaugă vârful (floats valori) în out doar dacă nu există deja; întoarce indicele lui
+    static unsigned int addUniqueVertex(const float* vertex, int floats, std::vector<float>& out,
+        std::unordered_map<std::string, unsigned int>& lookup)
+    {
+        std::string key((const char*)vertex, floats * sizeof(float));
+        auto it = lookup.find(key);
+        if (it != lookup.end()) return it->second;
+
+        unsigned int index = (unsigned int)(out.size() / floats);
+        out.insert(out.end(), vertex, vertex + floats);
+        lookup[key] = index;
+        return index;
+    }
+
+    // Depth-only: tot modelul dintr-un singur draw, fără texturi sau uniforme de material
+    void drawDepth()
+    {
+        if (!depthMesh.valid()) return;
+
+        GeometryPool::positions().draw(depthMesh.indexCount, depthMesh.firstIndex, depthMesh.baseVertex);
+    }
+
+    void drawDepthInstanced(int instanceCount)
+    {
+        if (!depthMesh.valid() || instanceCount <= 0) return;
+
+        GeometryPool::positions().draw(depthMesh.indexCount, depthMesh.firstIndex, depthMesh.baseVertex, instanceCount);
+        RenderStats::frame().instancesDrawn += instanceCount;
+    }
+
+    // Variantele depth-only pentru drawMaterialGroup / drawExcept
+    void drawDepthMaterialGroup(const std::string& materialName)
+    {
+        if (!depthMesh.valid()) return;
+
+        for (const auto& group : materialGroups)
+        {
+            if (group.materialName != materialName) continue;
+            GeometryPool::positions().draw(group.vertexCount, group.depthFirst, depthMesh.baseVertex);
+        }
+    }
+
+    void drawDepthExcept(const std::string& excludeMaterial)
+    {
+        if (!depthMesh.valid()) return;
+
+        // Grupurile consecutive sunt unite într-un singur draw
+        GeometryPool& pool = GeometryPool::positions();
+        int first = 0, count = 0;
+        for (const auto& group : materialGroups)
+        {
+            if (group.materialName == excludeMaterial) {
+                pool.draw(count, first, depthMesh.baseVertex);
+                count = 0;
+                continue;
             }
-            else {
-                glBindTexture(GL_TEXTURE_2D, 0);
-                shader.setBool("useTexture", false);
-                shader.setBool("hasEmission", false);
-                shader.setVec3("emissionColor", glm::vec3(0.0f, 0.0f, 0.0f));
-                shader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
+            if (count == 0) first = group.depthFirst;
+            count += group.vertexCount;
+        }
+        pool.draw(count, first, depthMesh.baseVertex);
+    }
+
+private:
+    // Vârfurile identice sunt unite (indexare), apoi modelul primește câte un
+    // interval în fiecare GeometryPool; grupurile devin intervale de indici
+    void uploadToPools()
+    {
+        std::vector<float> meshVertices, depthVertices;
+        std::vector<unsigned int> meshIndices, depthIndices;
+        std::unordered_map<std::string, unsigned int> meshLookup, depthLookup;
+        for (auto& group : materialGroups)
+        {
+            group.firstIndex = (int)meshIndices.size();
+            group.depthFirst = (int)depthIndices.size();
+            for (size_t i = 0; i + 10 < group.vertices.size(); i += 11)
+            {
+                meshIndices.push_back(addUniqueVertex(&group.vertices[i], 11, meshVertices, meshLookup));
+                depthIndices.push_back(addUniqueVertex(&group.vertices[i], 3, depthVertices, depthLookup));
             }
+        }
 
-            glBindVertexArray(group.VAO);
-            glDrawArrays(GL_TRIANGLES, 0, group.vertexCount);
-            glBindVertexArray(0);
+        mesh = GeometryPool::meshes().allocate(meshVertices, meshIndices);
+        depthMesh = GeometryPool::positions().allocate(depthVertices, depthIndices);
+        for (auto& group : materialGroups)
+        {
+            group.firstIndex += mesh.firstIndex;
+            group.depthFirst += depthMesh.firstIndex;
         }
-        glBindTexture(GL_TEXTURE_2D, 0);
     }
 
-private:
+    void bindMaterial(Shader& shader, const MaterialGroup& group)
+    {
+        applyMaterial(shader, findMaterial(group));
+    }
+
 void loadMTL(const std::string& mtlPath)
 {
     std::ifstream file(mtlPath);
@@ -405,6 +524,7 @@ void loadMTL(const std::string& mtlPath)
         if (emissionStrength > 0.1f && !mat.hasTexture && diffuseStrength < 0.1f) {
             mat.hasEmission = true;
         }
+        mat.sortId = Material::nextSortId();
     }
     
     std::cout << "MTL loading complete. Total materials: " << materials.size() << std::endl;
@@ -470,35 +590,6 @@ void loadMTL(const std::string& mtlPath)
         outVertices.push_back(1.0f);
         outVertices.push_back(1.0f);
     }
-
-    void setupMaterialGroup(MaterialGroup& group)
-    {
-        glGenVertexArrays(1, &group.VAO);
-        glGenBuffers(1, &group.VBO);
-
-        glBindVertexArray(group.VAO);
-        glBindBuffer(GL_ARRAY_BUFFER, group.VBO);
-        glBufferData(GL_ARRAY_BUFFER, group.vertices.size() * sizeof(float),
-            group.vertices.data(), GL_STATIC_DRAW);
-
-        // Position
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 11 * sizeof(float), (void*)0);
-        glEnableVertexAttribArray(0);
-
-        // Normal
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 11 * sizeof(float), (void*)(3 * sizeof(float)));
-        glEnableVertexAttribArray(1);
-
-        // Texture coords
-        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 11 * sizeof(float), (void*)(6 * sizeof(float)));
-        glEnableVertexAttribArray(2);
-
-        // Color
-        glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, 11 * sizeof(float), (void*)(8 * sizeof(float)));
-        glEnableVertexAttribArray(3);
-
-        glBindVertexArray(0);
-    }
 };
 
 #endif
\ No newline at end of file
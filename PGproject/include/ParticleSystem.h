@@ -0,0 +1,474 @@
+#pragma once
+#ifndef ParticleSystem_h
+#define ParticleSystem_h
+
+#if defined (__APPLE__)
+#define GLFW_INCLUDE_GLCOREARB
+#else
+#define GLEW_STATIC
+#include <GL/glew.h>
+#endif
+
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+#include <functional>
+#include <cmath>
+#include <iostream>
+#include <iomanip>
+#include "Camera.h"
+#include "Culling.h"
+#include "Shader.h"
+#include "GLState.h"
+#include "StreamBuffer.h"
+#include "RenderStats.h"
+#include "RainSimulation.h"
+
+// Tot ce descrie un fel de particulă. Emițătoarele cu aceeași definiție o
+// împart; fiecare emițător adaugă doar o poziție.
+struct ParticleEmitterDef {
+    std::string name;
+    int capacity;                 // particule pe emițător, fixat la creare
+    float spawnRate;              // particule pe secundă pe emițător
+    float lifeMin, lifeMax;       // secunde
+    glm::vec3 spawnExtent;        // jumătatea cutiei de apariție, dacă emițătorul nu are una proprie
+    glm::vec3 velocityMin, velocityMax;
+    glm::vec3 gravity;
+    float drag;                   // fracțiunea din viteză pierdută pe secundă
+    float attraction;             // atracția înapoi spre emițător (pe secundă)
+    float jitter;                 // accelerație aleatoare, m/s^2
+    float killBelow;              // particulele mor sub această înălțime
+    float size;                   // lățimea billboardului în metri
+    glm::vec4 colorStart, colorEnd; // pe durata vieții, inclusiv alpha
+    bool additive;                // materialul: aditiv sau cu alpha blending
+    bool sortBackToFront;         // necesar doar pentru alpha blending
+
+    ParticleEmitterDef()
+        : capacity(64), spawnRate(10.0f), lifeMin(1.0f), lifeMax(2.0f), spawnExtent(0.5f),
+          velocityMin(-1.0f), velocityMax(1.0f), gravity(0.0f), drag(0.0f), attraction(0.0f), jitter(0.0f),
+          killBelow(-1e9f), size(0.1f), colorStart(1.0f), colorEnd(1.0f, 1.0f, 1.0f, 0.0f), additive(false),
+          sortBackToFront(false) {}
+
+    int material() const { return additive ? 1 : 0; }
+};
+
+// Stocare SoA cu capacitate fixă. Particulele vii stau compacte la început:
+// o apariție ia locul de după ultima, o moarte mută ultima particulă în gaură,
+// deci după inițializare nu se mai alocă nimic.
+class ParticlePool
+{
+public:
+    enum Field { PX, PY, PZ, VX, VY, VZ, AGE, LIFE, FIELD_COUNT };
+
+    int capacity;
+    int alive;
+
+    ParticlePool() : capacity(0), alive(0) {}
+
+    void init(int particleCapacity)
+    {
+        capacity = particleCapacity;
+        alive = 0;
+        data.assign((size_t)capacity * FIELD_COUNT, 0.0f);
+    }
+
+    float* field(Field f) { return data.data() + (size_t)f * capacity; }
+    const float* field(Field f) const { return data.data() + (size_t)f * capacity; }
+
+    // Indicele noii particule, -1 când rezerva e plină
+    int spawn() { return alive < capacity ? alive++ : -1; }
+
+    void kill(int i)
+    {
+        int last = --alive;
+        if (i == last) return;
+        for (int f = 0; f < FIELD_COUNT; f++) {
+            float* values = field((Field)f);
+            values[i] = values[last];
+        }
+    }
+
+private:
+    std::vector<float> data;
+};
+
+// O definiție, multe emițătoare, fiecare cu rezerva lui, ca eliminarea să
+// poată sări un emițător întreg după limitele lui.
+class ParticleSystem
+{
+public:
+    struct Emitter {
+        glm::vec3 position;
+        glm::vec3 spawnExtent;
+        ParticlePool pool;
+        float spawnDebt;
+        AABB bounds;  // ale particulelor vii după ultima actualizare
+        bool visible; // setat de gather
+    };
+
+    ParticleEmitterDef def;
+    std::vector<Emitter> emitters;
+
+    // Ultimul cadru
+    int aliveCount;
+    int visibleEmitters;
+    int rejectedSpawns; // rezerva era plină
+    double updateMs, sortMs;
+
+    explicit ParticleSystem(const ParticleEmitterDef& definition)
+        : def(definition), aliveCount(0), visibleEmitters(0), rejectedSpawns(0), updateMs(0.0), sortMs(0.0),
+          reportFrames(0), reportAlive(0), reportVisible(0), reportUpdateMs(0.0), reportSortMs(0.0)
+    {
+        rng.seed(std::hash<std::string>()(def.name));
+    }
+
+    void addEmitter(const glm::vec3& position) { addEmitter(position, def.spawnExtent); }
+
+    void addEmitter(const glm::vec3& position, const glm::vec3& spawnExtent)
+    {
+        Emitter e;
+        e.position = position;
+        e.spawnExtent = spawnExtent;
+        e.pool.init(def.capacity);
+        e.spawnDebt = 0.0f;
+        e.bounds = AABB(position, position);
+        e.visible = false;
+        emitters.push_back(e);
+    }
+
+    void update(float dt)
+    {
+        double start = glfwGetTime();
+        aliveCount = 0;
+        rejectedSpawns = 0;
+        for (Emitter& e : emitters) {
+            spawn(e, dt);
+            integrate(e, dt);
+            aliveCount += e.pool.alive;
+        }
+        updateMs = (glfwGetTime() - start) * 1000.0;
+    }
+
+    // Adaugă particulele emițătoarelor din frustum ca instanțe (centru +
+    // mărime, culoare; câte 8 float-uri). Sistemele sortate ies din spate
+    // spre față de-a lungul lui viewDir.
+    void gather(const Frustum& frustum, const glm::vec3& eye, const glm::vec3& viewDir, std::vector<float>& instances)
+    {
+        visibleEmitters = 0;
+        size_t first = instances.size() / 8;
+        for (Emitter& e : emitters) {
+            e.visible = e.pool.alive > 0 && frustum.intersects(e.bounds);
+            if (!e.visible) continue;
+            visibleEmitters++;
+            appendInstances(e, instances);
+        }
+        sortMs = 0.0;
+        if (def.sortBackToFront) {
+            double sortStart = glfwGetTime();
+            sortBackToFront(instances, first, eye, viewDir);
+            sortMs = (glfwGetTime() - sortStart) * 1000.0;
+        }
+        reportFrames++;
+        reportAlive += aliveCount;
+        reportVisible += visibleEmitters;
+        reportUpdateMs += updateMs;
+        reportSortMs += sortMs;
+    }
+
+    // Mediile de la ultimul apel, o linie pe sistem
+    static void printReport(std::vector<ParticleSystem*>& systems)
+    {
+        std::cout << std::fixed << std::setprecision(3) << "[particles]";
+        for (ParticleSystem* s : systems) {
+            int frames = std::max(s->reportFrames, 1);
+            std::cout << " " << s->def.name << ": " << s->reportAlive / frames << " alive, "
+                      << s->reportVisible / frames << "/" << s->emitters.size() << " emitters visible, update "
+                      << s->reportUpdateMs / frames << " ms, sort " << s->reportSortMs / frames << " ms |";
+        }
+        std::cout << std::endl;
+        resetReport(systems);
+    }
+
+    static void resetReport(std::vector<ParticleSystem*>& systems)
+    {
+        for (ParticleSystem* s : systems) {
+            s->reportFrames = s->reportAlive = s->reportVisible = 0;
+            s->reportUpdateMs = s->reportSortMs = 0.0;
+        }
+    }
+
+private:
+    RainRng rng;
+    std::vector<uint32_t> keys, tempKeys, order, tempOrder;
+    std::vector<float> sorted;
+    int reportFrames, reportAlive, reportVisible;
+    double reportUpdateMs, reportSortMs;
+
+    float random(float min, float max) { return min + rng.next01(0) * (max - min); }
+
+    void spawn(Emitter& e, float dt)
+    {
+        e.spawnDebt += def.spawnRate * dt;
+        ParticlePool& pool = e.pool;
+        while (e.spawnDebt >= 1.0f) {
+            e.spawnDebt -= 1.0f;
+            int i = pool.spawn();
+            if (i < 0) {
+                rejectedSpawns++;
+                continue;
+            }
+            pool.field(ParticlePool::PX)[i] = e.position.x + random(-e.spawnExtent.x, e.spawnExtent.x);
+            pool.field(ParticlePool::PY)[i] = e.position.y + random(-e.spawnExtent.y, e.spawnExtent.y);
+            pool.field(ParticlePool::PZ)[i] = e.position.z + random(-e.spawnExtent.z, e.spawnExtent.z);
+            pool.field(ParticlePool::VX)[i] = random(def.velocityMin.x, def.velocityMax.x);
+            pool.field(ParticlePool::VY)[i] = random(def.velocityMin.y, def.velocityMax.y);
+            pool.field(ParticlePool::VZ)[i] = random(def.velocityMin.z, def.velocityMax.z);
+            pool.field(ParticlePool::AGE)[i] = 0.0f;
+            pool.field(ParticlePool::LIFE)[i] = random(def.lifeMin, def.lifeMax);
+        }
+    }
+
+    void integrate(Emitter& e, float dt)
+    {
+        ParticlePool& pool = e.pool;
+        float* px = pool.field(ParticlePool::PX);
+        float* py = pool.field(ParticlePool::PY);
+        float* pz = pool.field(ParticlePool::PZ);
+        float* vx = pool.field(ParticlePool::VX);
+        float* vy = pool.field(ParticlePool::VY);
+        float* vz = pool.field(ParticlePool::VZ);
+        float* age = pool.field(ParticlePool::AGE);
+        const float* life = pool.field(ParticlePool::LIFE);
+
+        float damping = std::max(0.0f, 1.0f - def.drag * dt);
+        float pull = def.attraction * dt;
+        float kick = def.jitter * dt;
+        glm::vec3 g = def.gravity * dt;
+
+        // Mișcarea: bucle simple peste tablourile câmpurilor
+        int n = pool.alive;
+        for (int i = 0; i < n; i++) {
+            vx[i] = (vx[i] + g.x + (e.position.x - px[i]) * pull) * damping;
+            vy[i] = (vy[i] + g.y + (e.position.y - py[i]) * pull) * damping;
+            vz[i] = (vz[i] + g.z + (e.position.z - pz[i]) * pull) * damping;
+            px[i] += vx[i] * dt;
+            py[i] += vy[i] * dt;
+            pz[i] += vz[i] * dt;
+            age[i] += dt;
+        }
+        if (kick > 0.0f) {
+            for (int i = 0; i < n; i++) {
+                vx[i] += random(-kick, kick);
+                vy[i] += random(-kick, kick);
+                vz[i] += random(-kick, kick);
+            }
+        }
+
+        // Morțile, apoi limitele a ce a rămas
+        for (int i = 0; i < pool.alive;) {
+            if (age[i] >= life[i] || py[i] < def.killBelow) {
+                pool.kill(i);
+            }
+            else {
+                i++;
+            }
+        }
+        n = pool.alive;
+        if (n == 0) {
+            e.bounds = AABB(e.position, e.position);
+            return;
+        }
+        glm::vec3 lo(px[0], py[0], pz[0]), hi = lo;
+        for (int i = 1; i < n; i++) {
+            lo = glm::min(lo, glm::vec3(px[i], py[i], pz[i]));
+            hi = glm::max(hi, glm::vec3(px[i], py[i], pz[i]));
+        }
+        glm::vec3 half(def.size * 0.5f);
+        e.bounds = AABB(lo - half, hi + half);
+    }
+
+    void appendInstances(const Emitter& e, std::vector<float>& instances) const
+    {
+        const ParticlePool& pool = e.pool;
+        const float* px = pool.field(ParticlePool::PX);
+        const float* py = pool.field(ParticlePool::PY);
+        const float* pz = pool.field(ParticlePool::PZ);
+        const float* age = pool.field(ParticlePool::AGE);
+        const float* life = pool.field(ParticlePool::LIFE);
+
+        size_t base = instances.size();
+        instances.resize(base + (size_t)pool.alive * 8);
+        float* out = instances.data() + base;
+        for (int i = 0; i < pool.alive; i++, out += 8) {
+            float t = std::min(age[i] / life[i], 1.0f);
+            glm::vec4 color = def.colorStart + (def.colorEnd - def.colorStart) * t;
+            out[0] = px[i];
+            out[1] = py[i];
+            out[2] = pz[i];
+            out[3] = def.size;
+            out[4] = color.r;
+            out[5] = color.g;
+            out[6] = color.b;
+            out[7] = color.a;
+        }
+    }
+
+    // Float -> cheie fără semn cu aceeași ordine, inclusiv pentru negative
+    static uint32_t orderedBits(float value)
+    {
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        return bits ^ ((bits >> 31) ? 0xFFFFFFFFu : 0x80000000u);
+    }
+
+    // Radix sort LSD al instanțelor de la `first` încolo după adâncimea în
+    // vedere, cele îndepărtate primele. 8 biți pe trecere; trecerile în care
+    // toate cheile au același octet sunt sărite, ca în RenderQueue::sort.
+    void sortBackToFront(std::vector<float>& instances, size_t first, const glm::vec3& eye, const glm::vec3& viewDir)
+    {
+        size_t n = instances.size() / 8 - first;
+        if (n < 2) return;
+        keys.resize(n);
+        order.resize(n);
+        tempKeys.resize(n);
+        tempOrder.resize(n);
+        const float* in = instances.data() + first * 8;
+        for (size_t i = 0; i < n; i++) {
+            float depth = (in[i * 8] - eye.x) * viewDir.x + (in[i * 8 + 1] - eye.y) * viewDir.y
+                + (in[i * 8 + 2] - eye.z) * viewDir.z;
+            keys[i] = ~orderedBits(depth);
+            order[i] = (uint32_t)i;
+        }
+
+        for (int shift = 0; shift < 32; shift += 8) {
+            size_t histogram[256] = { 0 };
+            for (size_t i = 0; i < n; i++) histogram[(keys[i] >> shift) & 0xFF]++;
+            if (histogram[(keys[0] >> shift) & 0xFF] == n) continue;
+
+            size_t offset = 0;
+            for (int b = 0; b < 256; b++) {
+                size_t c = histogram[b];
+                histogram[b] = offset;
+                offset += c;
+            }
+            for (size_t i = 0; i < n; i++) {
+                size_t slot = histogram[(keys[i] >> shift) & 0xFF]++;
+                tempKeys[slot] = keys[i];
+                tempOrder[slot] = order[i];
+            }
+            keys.swap(tempKeys);
+            order.swap(tempOrder);
+        }
+
+        sorted.resize(n * 8);
+        for (size_t i = 0; i < n; i++) {
+            memcpy(&sorted[i * 8], in + (size_t)order[i] * 8, 8 * sizeof(float));
+        }
+        memcpy(instances.data() + first * 8, sorted.data(), n * 8 * sizeof(float));
+    }
+};
+
+// Desenează toate sistemele de particule ca pătrate orientate spre cameră: un
+// desen instanțiat pe material (întâi alpha blending, apoi aditiv), oricâte
+// sisteme și emițătoare ar fi. Datele instanțelor trec prin stream buffer.
+class ParticleRenderer
+{
+public:
+    static const int MATERIAL_COUNT = 2; // alpha blending, aditiv
+
+    ParticleRenderer() : vao(0), quadBuffer(0), instanceBuffer(0), instanceCapacity(0) {}
+
+    void init()
+    {
+        shader.loadShader("shaders/particle.vert", "shaders/particle.frag");
+
+        float corners[] = { -0.5f, -0.5f, 0.5f, -0.5f, -0.5f, 0.5f, 0.5f, 0.5f };
+        glGenVertexArrays(1, &vao);
+        glGenBuffers(1, &quadBuffer);
+        glGenBuffers(1, &instanceBuffer);
+        GLState::bindVertexArray(vao);
+        GLState::bindBuffer(GL_ARRAY_BUFFER, quadBuffer);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(0);
+        for (int a = 1; a <= 2; a++) {
+            glEnableVertexAttribArray(a);
+            glVertexAttribDivisor(a, 1);
+        }
+        GLState::bindVertexArray(0);
+    }
+
+    // Trebuie apelat cât contextul GL încă există
+    void release()
+    {
+        GLState::deleteVertexArrays(1, &vao);
+        GLuint buffers[2] = { quadBuffer, instanceBuffer };
+        GLState::deleteBuffers(2, buffers);
+        GLState::deleteProgram(shader.shaderProgram);
+        vao = quadBuffer = instanceBuffer = 0;
+    }
+
+    void draw(std::vector<ParticleSystem*>& systems, const glm::mat4& view, const glm::mat4& projection,
+        const glm::vec3& eye)
+    {
+        Frustum frustum = Frustum::fromMatrix(projection * view);
+        glm::vec3 viewDir(-view[0][2], -view[1][2], -view[2][2]);
+
+        shader.useShaderProgram();
+        shader.setMat4("view", view);
+        shader.setMat4("projection", projection);
+        GLState::bindVertexArray(vao);
+        GLState::enable(GL_BLEND);
+        GLState::depthMask(GL_FALSE);
+
+        for (int material = 0; material < MATERIAL_COUNT; material++) {
+            instances.clear();
+            for (ParticleSystem* system : systems) {
+                if (system->def.material() == material) system->gather(frustum, eye, viewDir, instances);
+            }
+            int count = (int)(instances.size() / 8);
+            if (count == 0) continue;
+
+            upload(count);
+            // Alpha păstrează transmitanța, pentru compunerea la rezoluție redusă
+            if (material == 1) GLState::blendFuncSeparate(GL_SRC_ALPHA, GL_ONE, GL_ZERO, GL_ONE);
+            else GLState::blendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ZERO, GL_ONE_MINUS_SRC_ALPHA);
+            glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, count);
+            RenderStats::frame().drawCalls++;
+            RenderStats::frame().instancesDrawn += count;
+        }
+
+        GLState::depthMask(GL_TRUE);
+        GLState::disable(GL_BLEND);
+        GLState::bindVertexArray(0);
+    }
+
+private:
+    Shader shader;
+    GLuint vao, quadBuffer, instanceBuffer;
+    size_t instanceCapacity;
+    std::vector<float> instances;
+
+    // Scrie instanțele și îndreaptă spre ele atributele 1 (centru + mărime) și
+    // 2 (culoare); VAO-ul e legat
+    void upload(int count)
+    {
+        size_t bytes = (size_t)count * 8 * sizeof(float);
+        StreamAllocation a;
+        if (StreamBuffer::get().enabled) a = StreamBuffer::get().upload(instances.data(), bytes);
+        if (!a.valid()) {
+            StreamBuffer::orphanUpload(GL_ARRAY_BUFFER, instanceBuffer, instanceCapacity, instances.data(), bytes);
+            a.buffer = instanceBuffer;
+            a.offset = 0;
+        }
+        GLState::bindBuffer(GL_ARRAY_BUFFER, a.buffer);
+        glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)a.offset);
+        glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(a.offset + 4 * sizeof(float)));
+    }
+};
+
+#endif
@@ -0,0 +1,144 @@
+#pragma once
+#ifndef RainOcclusion_h
+#define RainOcclusion_h
+
+#if defined (__APPLE__)
+#define GLFW_INCLUDE_GLCOREARB
+#else
+#define GLEW_STATIC
+#include <GL/glew.h>
+#endif
+
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include <algorithm>
+#include <iostream>
+#include "Camera.h"
+#include "Shader.h"
+#include "GLState.h"
+#include "RainSimulation.h"
+
+// Harta de adâncime a scenei statice văzută de sus, randată o dată la
+// încărcare cu o proiecție ortografică drept în jos. Fiecare texel ține
+// înălțimea celei mai înalte suprafețe de deasupra lui (acoperiș, coroană,
+// lampă), ca actualizarea ploii să oprească picăturile acolo: pe GPU prin
+// eșantionarea texturii, pe CPU printr-o copie citită înapoi în heights.
+//
+// Utilizare: begin() întoarce matricea pentru shaderul de adâncime, se
+// desenează geometria statică, apoi end().
+class RainOcclusion
+{
+public:
+    int resolution;
+    GLuint fbo, texture;
+    std::vector<float> heights; // copia de pe CPU, pe rânduri, cu z ca rând
+    float minX, minZ, sizeX, sizeZ;
+    float bottom, top;          // înălțimile în lume la adâncimea 1 și la adâncimea 0
+
+    RainOcclusion() : resolution(256), fbo(0), texture(0), minX(0.0f), minZ(0.0f), sizeX(1.0f), sizeZ(1.0f),
+        bottom(0.0f), top(1.0f) {}
+
+    bool ready() const { return !heights.empty(); }
+
+    glm::mat4 begin(const AABB& bounds)
+    {
+        if (!fbo) create();
+        minX = bounds.min.x;
+        minZ = bounds.min.z;
+        sizeX = std::max(bounds.max.x - bounds.min.x, 1.0f);
+        sizeZ = std::max(bounds.max.z - bounds.min.z, 1.0f);
+        bottom = std::min(bounds.min.y, 0.0f);
+        top = bounds.max.y + 1.0f;
+
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        glViewport(0, 0, resolution, resolution);
+        glClear(GL_DEPTH_BUFFER_BIT);
+
+        // x -> clip x, z -> clip y, înălțimea -> adâncime (top = 0, bottom = 1)
+        glm::mat4 topDown(0.0f);
+        topDown[0][0] = 2.0f / sizeX;
+        topDown[2][1] = 2.0f / sizeZ;
+        topDown[1][2] = -2.0f / (top - bottom);
+        topDown[3][0] = -2.0f * minX / sizeX - 1.0f;
+        topDown[3][1] = -2.0f * minZ / sizeZ - 1.0f;
+        topDown[3][2] = 2.0f * top / (top - bottom) - 1.0f;
+        topDown[3][3] = 1.0f;
+        return topDown;
+    }
+
+    // Citește harta înapoi o dată, pentru calea de pe CPU; lasă legat
+    // framebufferul implicit (apelantul își refă viewportul)
+    void end()
+    {
+        heights.resize((size_t)resolution * resolution);
+        glReadPixels(0, 0, resolution, resolution, GL_DEPTH_COMPONENT, GL_FLOAT, heights.data());
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+        int covered = 0;
+        for (float& h : heights) {
+            if (h < 1.0f) covered++;
+            h = top - h * (top - bottom);
+        }
+        std::cout << "Rain occlusion map: " << resolution << "x" << resolution << " over " << sizeX << " x "
+                  << sizeZ << " m (" << sizeX / resolution << " m texels), " << covered * 100 / (int)heights.size()
+                  << "% covered" << std::endl;
+    }
+
+    RainHeightField heightField() const
+    {
+        RainHeightField field;
+        field.heights = heights.data();
+        field.resolution = resolution;
+        field.minX = minX;
+        field.minZ = minZ;
+        field.texelsPerMeterX = resolution / sizeX;
+        field.texelsPerMeterZ = resolution / sizeZ;
+        return field;
+    }
+
+    // Uniformele din rain_update.vert; harta merge pe unitatea de textură `unit`
+    void apply(Shader& shader, int unit)
+    {
+        GLState::activeTexture(GL_TEXTURE0 + unit);
+        GLState::bindTexture(GL_TEXTURE_2D, texture);
+        shader.setInt("occlusionMap", unit);
+        shader.setVec4("occlusionRect", glm::vec4(minX, minZ, 1.0f / sizeX, 1.0f / sizeZ));
+        shader.setFloat("occlusionTop", top);
+        shader.setFloat("occlusionBottom", bottom);
+    }
+
+    // Trebuie apelat cât contextul GL încă există
+    void release()
+    {
+        if (fbo) glDeleteFramebuffers(1, &fbo);
+        GLState::deleteTextures(1, &texture);
+        fbo = texture = 0;
+        heights.clear();
+    }
+
+private:
+    void create()
+    {
+        glGenTextures(1, &texture);
+        GLState::bindTexture(GL_TEXTURE_2D, texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, resolution, resolution, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        // În afara hărții e doar solul: adâncimea 1 = bottom
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+        float border[] = { 1.0f, 1.0f, 1.0f, 1.0f };
+        glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, border);
+        GLState::bindTexture(GL_TEXTURE_2D, 0);
+
+        glGenFramebuffers(1, &fbo);
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, texture, 0);
+        glDrawBuffer(GL_NONE);
+        glReadBuffer(GL_NONE);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+};
+
+#endif
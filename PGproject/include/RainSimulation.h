@@ -0,0 +1,527 @@
+#pragma once
+#ifndef RainSimulation_h
+#define RainSimulation_h
+
+#if defined (__APPLE__)
+#define GLFW_INCLUDE_GLCOREARB
+#else
+#define GLEW_STATIC
+#include <GL/glew.h>
+#endif
+
+#include <GLFW/glfw3.h>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
+#include <iostream>
+#include <cstdint>
+#include <cstdlib>
+
+#if defined(__AVX2__)
+#define RAIN_SIMD_WIDTH 8
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RAIN_SIMD_WIDTH 4
+#include <emmintrin.h>
+#else
+#define RAIN_SIMD_WIDTH 1
+#endif
+
+// xoshiro128+ cu câte o stare independentă pe fiecare bandă SIMD. Fiecare fir
+// de lucru are unul, deci reapariția picăturilor nu cere blocări (spre
+// deosebire de rand()).
+struct RainRng {
+    uint32_t s[4][RAIN_SIMD_WIDTH]; // s[cuvânt][bandă]
+
+    void seed(uint64_t seedValue)
+    {
+        // splitmix64 extinde seedul în stări diferite pentru fiecare bandă
+        for (int lane = 0; lane < RAIN_SIMD_WIDTH; lane++) {
+            for (int w = 0; w < 4; w++) {
+                seedValue += 0x9E3779B97F4A7C15ull;
+                uint64_t z = seedValue;
+                z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+                z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+                s[w][lane] = (uint32_t)((z ^ (z >> 31)) >> 16) | 1u;
+            }
+        }
+    }
+
+    // Pasul scalar al unei benzi, pentru coadă și pentru compilarea fără SIMD
+    float next01(int lane)
+    {
+        uint32_t result = s[0][lane] + s[3][lane];
+        uint32_t t = s[1][lane] << 9;
+        s[2][lane] ^= s[0][lane];
+        s[3][lane] ^= s[1][lane];
+        s[1][lane] ^= s[2][lane];
+        s[0][lane] ^= s[3][lane];
+        s[2][lane] ^= t;
+        s[3][lane] = (s[3][lane] << 11) | (s[3][lane] >> 21);
+        return toFloat01(result);
+    }
+
+    // Cei mai de sus 23 de biți ca mantisă a unui float din [1, 2), minus 1
+    static float toFloat01(uint32_t bits)
+    {
+        union { uint32_t u; float f; } v;
+        v.u = (bits >> 9) | 0x3F800000u;
+        return v.f - 1.0f;
+    }
+};
+
+// Cutia în care trăiesc picăturile. O picătură care iese pe jos reintră sus, la
+// un x / z nou aleator, iar pe x / z cutia se închide în sine, așa că poate
+// urma camera și rămâne plină: picăturile de care camera se depărtează
+// reapar în partea spre care merge.
+struct RainVolume {
+    float minX, minY, minZ;
+    float sizeX, sizeY, sizeZ;
+
+    // Parcul: 100 x 100 m de la sol până la 55 m
+    static RainVolume world()
+    {
+        RainVolume v = { -50.0f, 0.0f, -50.0f, 100.0f, 55.0f, 100.0f };
+        return v;
+    }
+
+    // width x width x height centrat pe ochi, niciodată sub sol
+    static RainVolume around(float eyeX, float eyeY, float eyeZ, float width, float height)
+    {
+        RainVolume v = { eyeX - width * 0.5f, std::max(0.0f, eyeY - height * 0.5f), eyeZ - width * 0.5f,
+            width, height, width };
+        return v;
+    }
+
+    float cubicMeters() const { return sizeX * sizeY * sizeZ; }
+};
+
+// Copia de pe CPU a hărții de ocluzie văzute de sus (RainOcclusion): înălțimea
+// celei mai înalte suprafețe pe texel, pe rânduri, cu z ca rând. Picăturile se
+// opresc acolo în loc de fundul volumului. În afara hărții, și când heights e
+// null, doar fundul volumului le oprește.
+struct RainHeightField {
+    const float* heights;
+    int resolution;
+    float minX, minZ;
+    float texelsPerMeterX, texelsPerMeterZ;
+
+    RainHeightField() : heights(nullptr), resolution(0), minX(0.0f), minZ(0.0f),
+        texelsPerMeterX(0.0f), texelsPerMeterZ(0.0f) {}
+
+    float heightAt(float x, float z, float fallback) const
+    {
+        float fx = (x - minX) * texelsPerMeterX;
+        float fz = (z - minZ) * texelsPerMeterZ;
+        if (!(fx >= 0.0f && fx < (float)resolution && fz >= 0.0f && fz < (float)resolution)) return fallback;
+        return std::max(fallback, heights[(int)fz * resolution + (int)fx]);
+    }
+};
+
+// Simularea ploii pe CPU, cu particulele în formă structure-of-arrays: un
+// bloc de float-uri așezat ca x[capacity] y[capacity] z[capacity] speed[capacity].
+// Partea de poziții e încărcată pe GPU așa cum e (rain.vert citește x, y și z
+// ca trei atribute float). Actualizările rulează pe lățimea SIMD și, pentru
+// multe particule, pe felii, pe un mic grup de fire de lucru.
+class RainSimulation
+{
+public:
+    static const int LANES = RAIN_SIMD_WIDTH;
+    static const int PARALLEL_THRESHOLD = 65536; // sub acest număr un singur fir e mai rapid
+
+    int count;
+    int capacity; // count rotunjit în sus la vectori SIMD întregi
+    std::vector<float> data;
+
+    RainSimulation() : count(0), capacity(0), workerCount(0), stopping(false), generation(0), pending(0),
+        frameDeltaTime(0.0f), frameWindX(0.0f), frameWindZ(0.0f), frameVolume(RainVolume::world()) {}
+
+    ~RainSimulation() { stopWorkers(); }
+
+    float* x() { return data.data(); }
+    float* y() { return data.data() + capacity; }
+    float* z() { return data.data() + 2 * capacity; }
+    float* speed() { return data.data() + 3 * capacity; }
+
+    // Pozițiile tuturor particulelor: blocurile x, y și z, de câte capacity float-uri
+    const float* positions() const { return data.data(); }
+    size_t positionBytes() const { return (size_t)capacity * 3 * sizeof(float); }
+
+    // Picăturile pornesc împrăștiate uniform în volum
+    void init(int particleCount, const RainVolume& volume, unsigned int threads = 0)
+    {
+        stopWorkers();
+        count = particleCount;
+        capacity = (particleCount + LANES - 1) / LANES * LANES;
+        data.assign((size_t)capacity * 4, 0.0f);
+
+        if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+        if (count < PARALLEL_THRESHOLD) threads = 1;
+        rngs.resize(threads);
+        for (unsigned int t = 0; t < threads; t++) rngs[t].seed(0x5EED0000ull + t);
+
+        // Benzile de completare sunt simulate ca celelalte, dar nu sunt desenate niciodată
+        for (int i = 0; i < capacity; i++) {
+            RainRng& rng = rngs[0];
+            int lane = i % LANES;
+            x()[i] = volume.minX + rng.next01(lane) * volume.sizeX;
+            y()[i] = volume.minY + rng.next01(lane) * volume.sizeY;
+            z()[i] = volume.minZ + rng.next01(lane) * volume.sizeZ;
+            speed()[i] = 25.0f + rng.next01(lane) * 15.0f;
+        }
+
+        for (unsigned int t = 1; t < threads; t++) {
+            workers.push_back(std::thread(&RainSimulation::workerLoop, this, (int)t));
+        }
+        workerCount = (int)workers.size();
+    }
+
+    void update(float deltaTime, float windX, float windZ, const RainVolume& volume,
+        const RainHeightField& field = RainHeightField())
+    {
+        if (workerCount == 0) {
+            updateRange(0, capacity, deltaTime, windX, windZ, volume, field, rngs[0]);
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            frameDeltaTime = deltaTime;
+            frameWindX = windX;
+            frameWindZ = windZ;
+            frameVolume = volume;
+            frameField = field;
+            pending = workerCount;
+            generation++;
+        }
+        wake.notify_all();
+
+        // Firul apelant ia felia 0
+        int begin, end;
+        slice(0, begin, end);
+        updateRange(begin, end, deltaTime, windX, windZ, volume, field, rngs[0]);
+
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [this] { return pending == 0; });
+    }
+
+    // Aceeași muncă în bucla originală pe particulă (AoS, ramificare pe
+    // particulă, rand()), față de calea SIMD pe un fir și pe toate firele
+    static void benchmark(int particleCount, int iterations)
+    {
+        struct Particle { float x, y, z, speed; };
+        std::vector<Particle> aos(particleCount);
+        for (Particle& p : aos) {
+            p.x = (float)(rand() % 100 - 50);
+            p.y = 5.0f + (rand() % 45);
+            p.z = (float)(rand() % 100 - 50);
+            p.speed = 25.0f + (rand() % 15);
+        }
+        const float dt = 1.0f / 60.0f, wind = 0.7f;
+
+        double start = glfwGetTime();
+        for (int it = 0; it < iterations; it++) {
+            for (Particle& p : aos) {
+                p.y -= p.speed * dt;
+                p.x += wind * dt;
+                p.z += wind * 0.2f * dt;
+                if (p.y < 0.0f) {
+                    p.y = 45.0f + (rand() % 10);
+                    p.x = (float)(rand() % 100 - 50);
+                    p.z = (float)(rand() % 100 - 50);
+                    p.speed = 25.0f + (rand() % 15);
+                }
+            }
+        }
+        double referenceMs = (glfwGetTime() - start) * 1000.0;
+
+        const RainVolume volume = RainVolume::world();
+        RainSimulation single;
+        single.init(particleCount, volume, 1);
+        start = glfwGetTime();
+        for (int it = 0; it < iterations; it++) {
+            single.updateRange(0, single.capacity, dt, wind, wind * 0.2f, volume, RainHeightField(), single.rngs[0]);
+        }
+        double singleMs = (glfwGetTime() - start) * 1000.0;
+
+        RainSimulation threaded;
+        threaded.init(particleCount, volume);
+        start = glfwGetTime();
+        for (int it = 0; it < iterations; it++) threaded.update(dt, wind, wind * 0.2f, volume);
+        double threadedMs = (glfwGetTime() - start) * 1000.0;
+
+        double work = (double)particleCount * iterations;
+        std::cout << "Rain update benchmark, " << particleCount << " particles x " << iterations << " steps:" << std::endl;
+        std::cout << "  AoS + rand():        " << (int)(work / referenceMs) << " particles/ms" << std::endl;
+        std::cout << "  SoA, " << LANES << " lanes:       " << (int)(work / singleMs) << " particles/ms" << std::endl;
+        std::cout << "  SoA, " << threaded.workerCount + 1 << " threads:     " << (int)(work / threadedMs)
+                  << " particles/ms" << std::endl;
+    }
+
+private:
+    std::vector<RainRng> rngs; // unul pe fir
+    std::vector<std::thread> workers;
+    int workerCount;
+    std::mutex mutex;
+    std::condition_variable wake, done;
+    bool stopping;
+    unsigned int generation;
+    int pending;
+    float frameDeltaTime, frameWindX, frameWindZ;
+    RainVolume frameVolume;
+    RainHeightField frameField;
+
+    // Felia firului t, în vectori SIMD întregi
+    void slice(int t, int& begin, int& end) const
+    {
+        int vectors = capacity / LANES;
+        int threads = workerCount + 1;
+        begin = (int)((long long)vectors * t / threads) * LANES;
+        end = (int)((long long)vectors * (t + 1) / threads) * LANES;
+    }
+
+    void workerLoop(int t)
+    {
+        unsigned int seen = 0;
+        for (;;) {
+            float dt, windX, windZ;
+            RainVolume volume;
+            RainHeightField field;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [&] { return stopping || generation != seen; });
+                if (stopping) return;
+                seen = generation;
+                dt = frameDeltaTime;
+                windX = frameWindX;
+                windZ = frameWindZ;
+                volume = frameVolume;
+                field = frameField;
+            }
+
+            int begin, end;
+            slice(t, begin, end);
+            updateRange(begin, end, dt, windX, windZ, volume, field, rngs[t]);
+
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--pending == 0) done.notify_one();
+        }
+    }
+
+    void stopWorkers()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread& worker : workers) worker.join();
+        workers.clear();
+        workerCount = 0;
+        stopping = false;
+    }
+
+    // Cădere, deriva cu vântul, ce a ieșit sub volum sau a lovit o suprafață a
+    // câmpului de înălțimi revine sus (x / z și viteză noi), apoi x / z sunt
+    // aduse înapoi în volum. Aducerea mută o picătură cu cel mult o mărime a
+    // cutiei, destul pentru orice viteză a camerei pe care cutia o urmează.
+    // [begin, end) e multiplu de LANES.
+    void updateRange(int begin, int end, float dt, float windX, float windZ, const RainVolume& v,
+        const RainHeightField& field, RainRng& rng)
+    {
+        float* px = x();
+        float* py = y();
+        float* pz = z();
+        float* ps = speed();
+
+#if RAIN_SIMD_WIDTH == 8
+        const __m256 vdt = _mm256_set1_ps(dt);
+        const __m256 dx = _mm256_set1_ps(windX * dt), dz = _mm256_set1_ps(windZ * dt);
+        const __m256 minX = _mm256_set1_ps(v.minX), minY = _mm256_set1_ps(v.minY), minZ = _mm256_set1_ps(v.minZ);
+        const __m256 sizeX = _mm256_set1_ps(v.sizeX), sizeY = _mm256_set1_ps(v.sizeY), sizeZ = _mm256_set1_ps(v.sizeZ);
+        for (int i = begin; i < end; i += 8) {
+            __m256 sp = _mm256_loadu_ps(ps + i);
+            __m256 vy = _mm256_sub_ps(_mm256_loadu_ps(py + i), _mm256_mul_ps(sp, vdt));
+            __m256 vx = _mm256_add_ps(_mm256_loadu_ps(px + i), dx);
+            __m256 vz = _mm256_add_ps(_mm256_loadu_ps(pz + i), dz);
+
+            __m256 stop = field.heights ? surface8(field, vx, vz, minY) : minY;
+            __m256 below = _mm256_cmp_ps(vy, stop, _CMP_LT_OQ);
+            if (_mm256_movemask_ps(below)) {
+                // Reintră sub vârf cu cât a trecut picătura de suprafață
+                __m256 lift = _mm256_sub_ps(_mm256_add_ps(minY, sizeY), stop);
+                vy = _mm256_blendv_ps(vy, _mm256_add_ps(vy, lift), below);
+                vx = _mm256_blendv_ps(vx, madd(next8(rng), v.sizeX, v.minX), below);
+                vz = _mm256_blendv_ps(vz, madd(next8(rng), v.sizeZ, v.minZ), below);
+                sp = _mm256_blendv_ps(sp, madd(next8(rng), 15.0f, 25.0f), below);
+                _mm256_storeu_ps(ps + i, sp);
+            }
+            _mm256_storeu_ps(px + i, wrap(vx, minX, sizeX));
+            _mm256_storeu_ps(py + i, wrap(vy, minY, sizeY));
+            _mm256_storeu_ps(pz + i, wrap(vz, minZ, sizeZ));
+        }
+#elif RAIN_SIMD_WIDTH == 4
+        const __m128 vdt = _mm_set1_ps(dt);
+        const __m128 dx = _mm_set1_ps(windX * dt), dz = _mm_set1_ps(windZ * dt);
+        const __m128 minX = _mm_set1_ps(v.minX), minY = _mm_set1_ps(v.minY), minZ = _mm_set1_ps(v.minZ);
+        const __m128 sizeX = _mm_set1_ps(v.sizeX), sizeY = _mm_set1_ps(v.sizeY), sizeZ = _mm_set1_ps(v.sizeZ);
+        for (int i = begin; i < end; i += 4) {
+            __m128 sp = _mm_loadu_ps(ps + i);
+            __m128 vy = _mm_sub_ps(_mm_loadu_ps(py + i), _mm_mul_ps(sp, vdt));
+            __m128 vx = _mm_add_ps(_mm_loadu_ps(px + i), dx);
+            __m128 vz = _mm_add_ps(_mm_loadu_ps(pz + i), dz);
+
+            __m128 stop = field.heights ? surface4(field, vx, vz, v.minY) : minY;
+            __m128 below = _mm_cmplt_ps(vy, stop);
+            if (_mm_movemask_ps(below)) {
+                // Reintră sub vârf cu cât a trecut picătura de suprafață
+                __m128 lift = _mm_sub_ps(_mm_add_ps(minY, sizeY), stop);
+                vy = select(below, _mm_add_ps(vy, lift), vy);
+                vx = select(below, madd(next4(rng), v.sizeX, v.minX), vx);
+                vz = select(below, madd(next4(rng), v.sizeZ, v.minZ), vz);
+                sp = select(below, madd(next4(rng), 15.0f, 25.0f), sp);
+                _mm_storeu_ps(ps + i, sp);
+            }
+            _mm_storeu_ps(px + i, wrap(vx, minX, sizeX));
+            _mm_storeu_ps(py + i, wrap(vy, minY, sizeY));
+            _mm_storeu_ps(pz + i, wrap(vz, minZ, sizeZ));
+        }
+#else
+        for (int i = begin; i < end; i++) {
+            py[i] -= ps[i] * dt;
+            px[i] += windX * dt;
+            pz[i] += windZ * dt;
+            float stop = field.heights ? field.heightAt(px[i], pz[i], v.minY) : v.minY;
+            if (py[i] < stop) {
+                py[i] += v.minY + v.sizeY - stop;
+                px[i] = v.minX + rng.next01(0) * v.sizeX;
+                pz[i] = v.minZ + rng.next01(0) * v.sizeZ;
+                ps[i] = 25.0f + rng.next01(0) * 15.0f;
+            }
+            px[i] = wrap(px[i], v.minX, v.sizeX);
+            py[i] = wrap(py[i], v.minY, v.sizeY);
+            pz[i] = wrap(pz[i], v.minZ, v.sizeZ);
+        }
+#endif
+    }
+
+    static float wrap(float value, float min, float size)
+    {
+        if (value < min) return value + size;
+        if (value >= min + size) return value - size;
+        return value;
+    }
+
+#if RAIN_SIMD_WIDTH == 8
+    static __m256 madd(__m256 r, float scale, float offset)
+    {
+        return _mm256_add_ps(_mm256_mul_ps(r, _mm256_set1_ps(scale)), _mm256_set1_ps(offset));
+    }
+
+    // Înălțimea suprafeței de sub fiecare bandă: un singur gather, benzile din
+    // afara hărții păstrează fundul volumului
+    static __m256 surface8(const RainHeightField& field, __m256 x, __m256 z, __m256 floorY)
+    {
+        __m256 fx = _mm256_mul_ps(_mm256_sub_ps(x, _mm256_set1_ps(field.minX)), _mm256_set1_ps(field.texelsPerMeterX));
+        __m256 fz = _mm256_mul_ps(_mm256_sub_ps(z, _mm256_set1_ps(field.minZ)), _mm256_set1_ps(field.texelsPerMeterZ));
+        __m256 size = _mm256_set1_ps((float)field.resolution), zero = _mm256_setzero_ps();
+        __m256 inside = _mm256_and_ps(
+            _mm256_and_ps(_mm256_cmp_ps(fx, zero, _CMP_GE_OQ), _mm256_cmp_ps(fx, size, _CMP_LT_OQ)),
+            _mm256_and_ps(_mm256_cmp_ps(fz, zero, _CMP_GE_OQ), _mm256_cmp_ps(fz, size, _CMP_LT_OQ)));
+        __m256i index = _mm256_add_epi32(
+            _mm256_mullo_epi32(_mm256_cvttps_epi32(_mm256_and_ps(fz, inside)), _mm256_set1_epi32(field.resolution)),
+            _mm256_cvttps_epi32(_mm256_and_ps(fx, inside)));
+        __m256 height = _mm256_mask_i32gather_ps(floorY, field.heights, index, inside, 4);
+        return _mm256_max_ps(height, floorY);
+    }
+
+    // Adună size sub min, îl scade la sau peste min + size
+    static __m256 wrap(__m256 value, __m256 min, __m256 size)
+    {
+        __m256 under = _mm256_and_ps(_mm256_cmp_ps(value, min, _CMP_LT_OQ), size);
+        __m256 over = _mm256_and_ps(_mm256_cmp_ps(value, _mm256_add_ps(min, size), _CMP_GE_OQ), size);
+        return _mm256_sub_ps(_mm256_add_ps(value, under), over);
+    }
+
+    // Un pas xoshiro128+ în toate cele 8 benzi, ca float-uri din [0, 1)
+    static __m256 next8(RainRng& rng)
+    {
+        __m256i s0 = _mm256_loadu_si256((const __m256i*)rng.s[0]);
+        __m256i s1 = _mm256_loadu_si256((const __m256i*)rng.s[1]);
+        __m256i s2 = _mm256_loadu_si256((const __m256i*)rng.s[2]);
+        __m256i s3 = _mm256_loadu_si256((const __m256i*)rng.s[3]);
+        __m256i result = _mm256_add_epi32(s0, s3);
+        __m256i t = _mm256_slli_epi32(s1, 9);
+        s2 = _mm256_xor_si256(s2, s0);
+        s3 = _mm256_xor_si256(s3, s1);
+        s1 = _mm256_xor_si256(s1, s2);
+        s0 = _mm256_xor_si256(s0, s3);
+        s2 = _mm256_xor_si256(s2, t);
+        s3 = _mm256_or_si256(_mm256_slli_epi32(s3, 11), _mm256_srli_epi32(s3, 21));
+        _mm256_storeu_si256((__m256i*)rng.s[0], s0);
+        _mm256_storeu_si256((__m256i*)rng.s[1], s1);
+        _mm256_storeu_si256((__m256i*)rng.s[2], s2);
+        _mm256_storeu_si256((__m256i*)rng.s[3], s3);
+
+        __m256i bits = _mm256_or_si256(_mm256_srli_epi32(result, 9), _mm256_set1_epi32(0x3F800000));
+        return _mm256_sub_ps(_mm256_castsi256_ps(bits), _mm256_set1_ps(1.0f));
+    }
+#elif RAIN_SIMD_WIDTH == 4
+    static __m128 madd(__m128 r, float scale, float offset)
+    {
+        return _mm_add_ps(_mm_mul_ps(r, _mm_set1_ps(scale)), _mm_set1_ps(offset));
+    }
+
+    static __m128 select(__m128 mask, __m128 a, __m128 b)
+    {
+        return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+    }
+
+    // Înălțimea suprafeței de sub fiecare bandă; SSE2 nu are gather, deci
+    // căutările sunt scalare
+    static __m128 surface4(const RainHeightField& field, __m128 x, __m128 z, float floorY)
+    {
+        float lx[4], lz[4], height[4];
+        _mm_storeu_ps(lx, x);
+        _mm_storeu_ps(lz, z);
+        for (int lane = 0; lane < 4; lane++) height[lane] = field.heightAt(lx[lane], lz[lane], floorY);
+        return _mm_loadu_ps(height);
+    }
+
+    // Adună size sub min, îl scade la sau peste min + size
+    static __m128 wrap(__m128 value, __m128 min, __m128 size)
+    {
+        __m128 under = _mm_and_ps(_mm_cmplt_ps(value, min), size);
+        __m128 over = _mm_and_ps(_mm_cmpge_ps(value, _mm_add_ps(min, size)), size);
+        return _mm_sub_ps(_mm_add_ps(value, under), over);
+    }
+
+    // Un pas xoshiro128+ în toate cele 4 benzi, ca float-uri din [0, 1)
+    static __m128 next4(RainRng& rng)
+    {
+        __m128i s0 = _mm_loadu_si128((const __m128i*)rng.s[0]);
+        __m128i s1 = _mm_loadu_si128((const __m128i*)rng.s[1]);
+        __m128i s2 = _mm_loadu_si128((const __m128i*)rng.s[2]);
+        __m128i s3 = _mm_loadu_si128((const __m128i*)rng.s[3]);
+        __m128i result = _mm_add_epi32(s0, s3);
+        __m128i t = _mm_slli_epi32(s1, 9);
+        s2 = _mm_xor_si128(s2, s0);
+        s3 = _mm_xor_si128(s3, s1);
+        s1 = _mm_xor_si128(s1, s2);
+        s0 = _mm_xor_si128(s0, s3);
+        s2 = _mm_xor_si128(s2, t);
+        s3 = _mm_or_si128(_mm_slli_epi32(s3, 11), _mm_srli_epi32(s3, 21));
+        _mm_storeu_si128((__m128i*)rng.s[0], s0);
+        _mm_storeu_si128((__m128i*)rng.s[1], s1);
+        _mm_storeu_si128((__m128i*)rng.s[2], s2);
+        _mm_storeu_si128((__m128i*)rng.s[3], s3);
+
+        __m128i bits = _mm_or_si128(_mm_srli_epi32(result, 9), _mm_set1_epi32(0x3F800000));
+        return _mm_sub_ps(_mm_castsi128_ps(bits), _mm_set1_ps(1.0f));
+    }
+#endif
+};
+
+#endif
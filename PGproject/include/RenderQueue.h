@@ -0,0 +1,435 @@
+#pragma once
+#ifndef RenderQueue_h
+#define RenderQueue_h
+
+#if defined (__APPLE__)
+#define GLFW_INCLUDE_GLCOREARB
+#else
+#define GLEW_STATIC
+#include <GL/glew.h>
+#endif
+
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <vector>
+#include <unordered_map>
+#include <string>
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
+#include "Model.h"
+#include "InstanceBatch.h"
+#include "GeometryPool.h"
+#include "Shader.h"
+#include "RenderStats.h"
+#include "GLState.h"
+#include "GLCapabilities.h"
+#include "StreamBuffer.h"
+
+// Un desen al trecerii opace: un interval de indici din GeometryPool::meshes()
+// cu starea de care are nevoie. Coada nu deține date de mesh.
+struct RenderItem {
+    uint64_t key;
+    int firstIndex, indexCount, baseVertex;
+    bool twoSided;            // desenat fără face culling
+    const Material* material; // nullptr = alb, fără textură
+    glm::mat4 model;
+    InstanceBatch* batch;     // setat pentru elementele instanțiate
+};
+
+// Adună desenele opace ale unui cadru, le sortează după o cheie de 64 de biți
+// și le trimite emițând doar starea care se schimbă între elemente
+// consecutive. Structura cheii, de la biții cei mai semnificativi:
+//   63-62 trecere | 61-58 variantă (instanțiat, două fețe) | 57-46 textură |
+//   45-32 material | 31-16 treapta de adâncime (din față spre spate) | 15-0 nefolosiți
+//
+// Cu GL_ARB_multi_draw_indirect + GL_ARB_base_instance fiecare element devine
+// o comandă indirectă ale cărei matrice stau într-un buffer pe cadru, și
+// fiecare șir de elemente cu același material pleacă într-un singur
+// glMultiDrawElementsIndirect. Pe GL 4.1 simplu elementele se desenează unul
+// câte unul și doar șirurile care au și aceeași matrice de model sunt unite
+// în glMultiDrawElementsBaseVertex.
+class RenderQueue
+{
+public:
+    static const int PASS_OPAQUE = 0;
+
+    std::vector<RenderItem> items;
+    float maxDepth; // distanța de vedere care cade în ultima treaptă de adâncime
+    bool indirectSupported;
+    bool indirectEnabled;
+
+    RenderQueue() : maxDepth(500.0f), indirectSupported(false), indirectEnabled(false),
+        matrixBuffer(0), commandBuffer(0), matrixCapacity(0), commandCapacity(0) {}
+
+    void init()
+    {
+        indirectSupported = GLCapabilities::get().multiDrawIndirect;
+        indirectEnabled = GLCapabilities::get().useMultiDrawIndirect;
+        glGenBuffers(1, &matrixBuffer);
+        glGenBuffers(1, &commandBuffer);
+    }
+
+    // Trebuie apelat cât contextul GL încă există
+    void release()
+    {
+        GeometryPool::meshes().forgetInstanceBuffer(matrixBuffer);
+        GLuint buffers[2] = { matrixBuffer, commandBuffer };
+        GLState::deleteBuffers(2, buffers);
+        matrixBuffer = commandBuffer = 0;
+    }
+
+    void clear() { items.clear(); }
+
+    // Toate grupurile de material ale unui model; onlyMaterial / exceptMaterial
+    // aleg părțile animate la fel ca drawMaterialGroup / drawExcept
+    void addModel(Model* model, const glm::mat4& matrix, float depth,
+        const char* onlyMaterial = nullptr, const char* exceptMaterial = nullptr)
+    {
+        for (const MaterialGroup& group : model->materialGroups) {
+            if (onlyMaterial && group.materialName != onlyMaterial) continue;
+            if (exceptMaterial && group.materialName == exceptMaterial) continue;
+            RenderItem item = makeItem(group.firstIndex, group.vertexCount, model->mesh.baseVertex,
+                model->findMaterial(group), matrix);
+            item.key = makeKey(PASS_OPAQUE, false, false, item.material, depth);
+            items.push_back(item);
+        }
+    }
+
+    // Un element instanțiat pe grup de material; un lot acoperă multe
+    // adâncimi, așa că intră în prima treaptă de adâncime a materialului său
+    void addInstanced(InstanceBatch& batch)
+    {
+        if (!batch.model || batch.count() == 0) return;
+        Model* model = batch.model;
+        for (const MaterialGroup& group : model->materialGroups) {
+            RenderItem item = makeItem(group.firstIndex, group.vertexCount, model->mesh.baseVertex,
+                model->findMaterial(group), glm::mat4(1.0f));
+            item.batch = &batch;
+            item.key = makeKey(PASS_OPAQUE, true, false, item.material, 0.0f);
+            items.push_back(item);
+        }
+    }
+
+    void addMesh(const PoolAllocation& mesh, const Material* material, const glm::mat4& matrix,
+        float depth, bool twoSided)
+    {
+        RenderItem item = makeItem(mesh.firstIndex, mesh.indexCount, mesh.baseVertex, material, matrix);
+        item.twoSided = twoSided;
+        item.key = makeKey(PASS_OPAQUE, false, twoSided, material, depth);
+        items.push_back(item);
+    }
+
+    // Radix sort LSD pe chei, câte 8 biți pe trecere. Trecerile în care toate
+    // cheile au același octet sunt sărite, deci biții nefolosiți nu costă nimic.
+    void sort()
+    {
+        size_t n = items.size();
+        order.resize(n);
+        keys.resize(n);
+        for (size_t i = 0; i < n; i++) {
+            order[i] = (unsigned int)i;
+            keys[i] = items[i].key;
+        }
+        tempOrder.resize(n);
+        tempKeys.resize(n);
+
+        for (int shift = 0; shift < 64; shift += 8) {
+            size_t histogram[256] = { 0 };
+            for (size_t i = 0; i < n; i++) histogram[(keys[i] >> shift) & 0xFF]++;
+            if (n == 0 || histogram[(keys[0] >> shift) & 0xFF] == n) continue;
+
+            size_t offset = 0;
+            for (int b = 0; b < 256; b++) {
+                size_t c = histogram[b];
+                histogram[b] = offset;
+                offset += c;
+            }
+            for (size_t i = 0; i < n; i++) {
+                size_t slot = histogram[(keys[i] >> shift) & 0xFF]++;
+                tempKeys[slot] = keys[i];
+                tempOrder[slot] = order[i];
+            }
+            keys.swap(tempKeys);
+            order.swap(tempOrder);
+        }
+    }
+
+    // Desenează elementele sortate cu programul legat acum. La GL pleacă
+    // doar starea care diferă de elementul anterior.
+    void submit(Shader& shader)
+    {
+        if (order.empty()) return;
+        SubmitState state(shader.shaderProgram);
+        shader.setInt("diffuseTexture", 0);
+        GLState::activeTexture(GL_TEXTURE0);
+        GeometryPool::meshes().bind();
+
+        if (indirectEnabled && indirectSupported) {
+            submitIndirect(state);
+        }
+        else {
+            submitDirect(state);
+        }
+
+        GLState::enable(GL_CULL_FACE);
+        state.setInstanced(false);
+    }
+
+private:
+    struct DrawElementsIndirectCommand {
+        GLuint count;
+        GLuint instanceCount;
+        GLuint firstIndex;
+        GLint baseVertex;
+        GLuint baseInstance;
+    };
+
+    // Ultimele valori trimise la GL într-un submit; -1 / ~0 înseamnă „netrimis încă”
+    struct SubmitState {
+        GLint modelLoc, instancingLoc, objectColorLoc, useTextureLoc, hasEmissionLoc, emissionColorLoc;
+        int instanced, twoSided, useTexture, hasEmission;
+        GLuint texture;
+        glm::vec3 objectColor, emissionColor;
+        const Material* material;
+        bool firstItem;
+
+        explicit SubmitState(GLuint program)
+            : instanced(-1), twoSided(-1), useTexture(-1), hasEmission(-1), texture(~0u),
+              objectColor(-1.0f), emissionColor(-1.0f), material(nullptr), firstItem(true)
+        {
+            modelLoc = glGetUniformLocation(program, "model");
+            instancingLoc = glGetUniformLocation(program, "useInstancing");
+            objectColorLoc = glGetUniformLocation(program, "objectColor");
+            useTextureLoc = glGetUniformLocation(program, "useTexture");
+            hasEmissionLoc = glGetUniformLocation(program, "hasEmission");
+            emissionColorLoc = glGetUniformLocation(program, "emissionColor");
+        }
+
+        void setInstanced(bool on)
+        {
+            if ((int)on == instanced) return;
+            instanced = on;
+            glUniform1i(instancingLoc, instanced);
+            RenderStats::frame().uniformUploads++;
+        }
+
+        // Starea de culling și valorile pe care le-ar încărca bindMaterial din Model
+        void apply(const RenderItem& item)
+        {
+            RenderStats& stats = RenderStats::frame();
+            if ((int)item.twoSided != twoSided) {
+                twoSided = item.twoSided;
+                if (item.twoSided) GLState::disable(GL_CULL_FACE);
+                else GLState::enable(GL_CULL_FACE);
+            }
+            if (!firstItem && item.material == material) return;
+            material = item.material;
+            firstItem = false;
+
+            bool textured = material && material->hasTexture && material->textureID != 0;
+            GLuint itemTexture = textured ? material->textureID : 0;
+            glm::vec3 itemColor = material && !textured ? material->diffuseColor : glm::vec3(1.0f);
+            int itemEmission = material ? material->hasEmission : 0;
+            glm::vec3 itemEmissionColor = material ? material->emissionColor : glm::vec3(0.0f);
+
+            if (itemTexture != texture) {
+                texture = itemTexture;
+                GLState::bindTexture(GL_TEXTURE_2D, texture);
+                stats.stateBinds++;
+            }
+            if ((int)textured != useTexture) {
+                useTexture = textured;
+                glUniform1i(useTextureLoc, useTexture);
+                stats.uniformUploads++;
+            }
+            if (itemColor != objectColor) {
+                objectColor = itemColor;
+                glUniform3fv(objectColorLoc, 1, glm::value_ptr(objectColor));
+                stats.uniformUploads++;
+            }
+            if (itemEmission != hasEmission) {
+                hasEmission = itemEmission;
+                glUniform1i(hasEmissionLoc, hasEmission);
+                stats.uniformUploads++;
+            }
+            if (itemEmissionColor != emissionColor) {
+                emissionColor = itemEmissionColor;
+                glUniform3fv(emissionColorLoc, 1, glm::value_ptr(emissionColor));
+                stats.uniformUploads++;
+            }
+        }
+    };
+
+    std::vector<unsigned int> order, tempOrder;
+    std::vector<uint64_t> keys, tempKeys;
+    GLuint matrixBuffer, commandBuffer;
+    size_t matrixCapacity, commandCapacity;
+    std::vector<glm::mat4> frameMatrices;
+    std::unordered_map<const InstanceBatch*, GLuint> batchBaseInstances; // prima matrice a fiecărui lot în frameMatrices
+    std::vector<DrawElementsIndirectCommand> commands;
+    std::vector<GLsizei> runCounts;
+    std::vector<const void*> runOffsets;
+    std::vector<GLint> runBaseVertices;
+
+    static bool sameRun(const RenderItem& a, const RenderItem& b)
+    {
+        return a.material == b.material && a.twoSided == b.twoSided;
+    }
+
+    void submitIndirect(SubmitState& state)
+    {
+        RenderStats& stats = RenderStats::frame();
+        GeometryPool& pool = GeometryPool::meshes();
+
+        // Fiecare element e un interval de instanțe dintr-un buffer comun de
+        // matrice; baseInstance alege intervalul. Grupurile de material ale
+        // unui model instanțiat sunt elemente separate ale aceluiași lot:
+        // matricele lui sunt scrise o dată și folosite de toate.
+        frameMatrices.clear();
+        batchBaseInstances.clear();
+        commands.clear();
+        for (unsigned int index : order) {
+            const RenderItem& item = items[index];
+            DrawElementsIndirectCommand command;
+            command.count = item.indexCount;
+            command.firstIndex = item.firstIndex;
+            command.baseVertex = item.baseVertex;
+            command.baseInstance = (GLuint)frameMatrices.size();
+            if (item.batch) {
+                command.instanceCount = item.batch->count();
+                auto inserted = batchBaseInstances.insert(std::make_pair(item.batch, command.baseInstance));
+                if (inserted.second) {
+                    frameMatrices.insert(frameMatrices.end(), item.batch->matrices.begin(), item.batch->matrices.end());
+                }
+                command.baseInstance = inserted.first->second;
+            }
+            else {
+                command.instanceCount = 1;
+                frameMatrices.push_back(item.model);
+            }
+            commands.push_back(command);
+        }
+        StreamAllocation matrixRange = upload(GL_ARRAY_BUFFER, matrixBuffer, matrixCapacity, frameMatrices.data(),
+            frameMatrices.size() * sizeof(glm::mat4));
+        StreamAllocation commandRange = upload(GL_DRAW_INDIRECT_BUFFER, commandBuffer, commandCapacity, commands.data(),
+            commands.size() * sizeof(DrawElementsIndirectCommand));
+
+        if (pool.bindInstanceBuffer(matrixRange.buffer, matrixRange.offset)) stats.stateBinds++;
+        GLState::bindBuffer(GL_DRAW_INDIRECT_BUFFER, commandRange.buffer);
+        state.setInstanced(true);
+
+#if !defined(__APPLE__)
+        size_t runStart = 0;
+        for (size_t i = 1; i <= order.size(); i++) {
+            if (i < order.size() && sameRun(items[order[i]], items[order[runStart]])) continue;
+            state.apply(items[order[runStart]]);
+            glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT,
+                (const void*)(commandRange.offset + runStart * sizeof(DrawElementsIndirectCommand)),
+                (GLsizei)(i - runStart), 0);
+            stats.drawCalls++;
+            runStart = i;
+        }
+#endif
+        stats.instancesDrawn += (int)frameMatrices.size();
+    }
+
+    void submitDirect(SubmitState& state)
+    {
+        RenderStats& stats = RenderStats::frame();
+        GeometryPool& pool = GeometryPool::meshes();
+
+        size_t i = 0;
+        while (i < order.size()) {
+            const RenderItem& item = items[order[i]];
+            state.apply(item);
+
+            if (item.batch) {
+                if (pool.bindInstanceBuffer(item.batch->drawBuffer, item.batch->drawOffset)) stats.stateBinds++;
+                state.setInstanced(true);
+                pool.draw(item.indexCount, item.firstIndex, item.baseVertex, item.batch->count());
+                stats.instancesDrawn += item.batch->count();
+                i++;
+                continue;
+            }
+
+            // Fără date pe desen se pot uni doar desenele cu același material și aceeași matrice
+            size_t end = i + 1;
+            while (end < order.size()) {
+                const RenderItem& next = items[order[end]];
+                if (next.batch || !sameRun(next, item) || memcmp(&next.model, &item.model, sizeof(glm::mat4)) != 0) break;
+                end++;
+            }
+
+            state.setInstanced(false);
+            glUniformMatrix4fv(state.modelLoc, 1, GL_FALSE, glm::value_ptr(item.model));
+            stats.uniformUploads++;
+            if (end - i == 1) {
+                pool.draw(item.indexCount, item.firstIndex, item.baseVertex);
+            }
+            else {
+                runCounts.clear();
+                runOffsets.clear();
+                runBaseVertices.clear();
+                for (size_t j = i; j < end; j++) {
+                    const RenderItem& merged = items[order[j]];
+                    runCounts.push_back(merged.indexCount);
+                    runOffsets.push_back((const void*)((size_t)merged.firstIndex * sizeof(unsigned int)));
+                    runBaseVertices.push_back(merged.baseVertex);
+                }
+                glMultiDrawElementsBaseVertex(GL_TRIANGLES, runCounts.data(), GL_UNSIGNED_INT,
+                    runOffsets.data(), (GLsizei)runCounts.size(), runBaseVertices.data());
+                stats.drawCalls++;
+            }
+            i = end;
+        }
+    }
+
+    // Scrie în stream buffer, sau orfanizează la fiecare cadru bufferul cozii,
+    // ca driverul să nu aștepte desenele cadrului anterior
+    static StreamAllocation upload(GLenum target, GLuint buffer, size_t& capacity, const void* data, size_t bytes)
+    {
+        StreamBuffer& stream = StreamBuffer::get();
+        if (stream.enabled) {
+            StreamAllocation a = stream.upload(data, bytes);
+            if (a.valid()) return a;
+        }
+        StreamBuffer::orphanUpload(target, buffer, capacity, data, bytes);
+        StreamAllocation a;
+        a.buffer = buffer;
+        a.bytes = bytes;
+        return a;
+    }
+
+    static RenderItem makeItem(int firstIndex, int indexCount, int baseVertex, const Material* material,
+        const glm::mat4& matrix)
+    {
+        RenderItem item;
+        item.key = 0;
+        item.firstIndex = firstIndex;
+        item.indexCount = indexCount;
+        item.baseVertex = baseVertex;
+        item.twoSided = false;
+        item.material = material;
+        item.model = matrix;
+        item.batch = nullptr;
+        return item;
+    }
+
+    uint64_t makeKey(int pass, bool instanced, bool twoSided, const Material* material, float depth) const
+    {
+        // Trimiterea indirectă desenează totul ca instanțe, deci elementele
+        // instanțiate și cele simple ale unui material trebuie să fie în același șir
+        bool splitInstanced = instanced && !(indirectEnabled && indirectSupported);
+        uint64_t variant = (splitInstanced ? 1u : 0u) | (twoSided ? 2u : 0u);
+        uint64_t texture = material && material->hasTexture ? material->textureID & 0xFFF : 0;
+        // Globale pentru toate modelele (Material::nextSortId); id-urile peste 16383 se suprapun cu cele dinainte
+        uint64_t materialId = material ? (uint64_t)material->sortId & 0x3FFF : 0;
+        float t = std::min(std::max(depth / maxDepth, 0.0f), 1.0f);
+        uint64_t depthBucket = (uint64_t)(t * 65535.0f);
+        return ((uint64_t)pass << 62) | (variant << 58) | (texture << 46) | (materialId << 32) | (depthBucket << 16);
+    }
+};
+
+#endif
@@ -0,0 +1,197 @@
+#pragma once
+#ifndef RenderStats_h
+#define RenderStats_h
+
+#include <iostream>
+#include <iomanip>
+
+// Contoarele de randare ale unui cadru. Sunt resetate la începutul fiecărui
+// cadru și incrementate de funcțiile de desenare (Model, InstanceBatch, ...).
+struct RenderStats {
+    int drawCalls;
+    int instancesDrawn;
+    int objectsVisible;
+    int objectsCulled;
+    int shadowCasters;
+    int shadowCastersCulled;
+    int shadowLayersRebuilt;
+    int pointLights;
+    int clusterLightRefs;
+    int depthPrepassFrames;
+    int programSwitches;
+    int uniformUploads;
+    int stateBinds; // legările de texturi și VAO emise de RenderQueue
+    int glCallsIssued; // apelurile de stare care au ajuns la GL prin GLState
+    int glCallsElided; // ... și cele redundante pe care le-a omis
+    int rainParticles;
+    size_t rainUploadBytes; // datele particulelor trimise la GPU
+    size_t streamBytes;     // datele dinamice scrise în cadru (StreamBuffer sau buffere orfanizate)
+    double cullMs;
+    double lightBinMs;
+    double shadowGpuMs;
+    double shadowRebuildGpuMs; // straturile statice ale cascadelor redesenate de cache-ul de umbre
+    double shadowFilterGpuMs;
+    double colorGpuMs;
+    double particleGpuMs; // ploaia + particulele, inclusiv compunerea la rezoluție redusă
+    double fogVolumeGpuMs; // împrăștierea în froxeli, integrarea și aplicarea
+    double upscaleGpuMs;   // upscale-ul temporal al țintei cu rezoluție dinamică
+    double renderScale;    // din mărimea ferestrei, 1 fără rezoluție dinamică
+    double overdraw;
+    double rainCpuMs;
+    double streamUploadMs; // timpul CPU în încărcările dinamice ...
+    double streamWaitMs;   // ... și blocat pe fence-urile din StreamBuffer
+    double cpuFrameMs;
+
+    RenderStats() { reset(); }
+
+    void reset()
+    {
+        drawCalls = 0;
+        instancesDrawn = 0;
+        objectsVisible = 0;
+        objectsCulled = 0;
+        shadowCasters = 0;
+        shadowCastersCulled = 0;
+        shadowLayersRebuilt = 0;
+        pointLights = 0;
+        clusterLightRefs = 0;
+        depthPrepassFrames = 0;
+        programSwitches = 0;
+        uniformUploads = 0;
+        stateBinds = 0;
+        glCallsIssued = 0;
+        glCallsElided = 0;
+        rainParticles = 0;
+        rainUploadBytes = 0;
+        streamBytes = 0;
+        cullMs = 0.0;
+        lightBinMs = 0.0;
+        shadowGpuMs = 0.0;
+        shadowRebuildGpuMs = 0.0;
+        shadowFilterGpuMs = 0.0;
+        colorGpuMs = 0.0;
+        particleGpuMs = 0.0;
+        fogVolumeGpuMs = 0.0;
+        upscaleGpuMs = 0.0;
+        renderScale = 0.0;
+        overdraw = 0.0;
+        rainCpuMs = 0.0;
+        streamUploadMs = 0.0;
+        streamWaitMs = 0.0;
+        cpuFrameMs = 0.0;
+    }
+
+    void accumulate(const RenderStats& other)
+    {
+        drawCalls += other.drawCalls;
+        instancesDrawn += other.instancesDrawn;
+        objectsVisible += other.objectsVisible;
+        objectsCulled += other.objectsCulled;
+        shadowCasters += other.shadowCasters;
+        shadowCastersCulled += other.shadowCastersCulled;
+        shadowLayersRebuilt += other.shadowLayersRebuilt;
+        pointLights += other.pointLights;
+        clusterLightRefs += other.clusterLightRefs;
+        depthPrepassFrames += other.depthPrepassFrames;
+        programSwitches += other.programSwitches;
+        uniformUploads += other.uniformUploads;
+        stateBinds += other.stateBinds;
+        glCallsIssued += other.glCallsIssued;
+        glCallsElided += other.glCallsElided;
+        rainParticles += other.rainParticles;
+        rainUploadBytes += other.rainUploadBytes;
+        streamBytes += other.streamBytes;
+        cullMs += other.cullMs;
+        lightBinMs += other.lightBinMs;
+        shadowGpuMs += other.shadowGpuMs;
+        shadowRebuildGpuMs += other.shadowRebuildGpuMs;
+        shadowFilterGpuMs += other.shadowFilterGpuMs;
+        colorGpuMs += other.colorGpuMs;
+        particleGpuMs += other.particleGpuMs;
+        fogVolumeGpuMs += other.fogVolumeGpuMs;
+        upscaleGpuMs += other.upscaleGpuMs;
+        renderScale += other.renderScale;
+        overdraw += other.overdraw;
+        rainCpuMs += other.rainCpuMs;
+        streamUploadMs += other.streamUploadMs;
+        streamWaitMs += other.streamWaitMs;
+        cpuFrameMs += other.cpuFrameMs;
+    }
+
+    static RenderStats& frame()
+    {
+        static RenderStats stats;
+        return stats;
+    }
+};
+
+// Face media RenderStats pe o secundă și o afișează în consolă.
+class StatsReporter {
+public:
+    bool enabled;
+
+    StatsReporter() : enabled(false), windowStart(0.0), frames(0) {}
+
+    // Adevărat când acest cadru a încheiat o fereastră și a afișat-o
+    bool endFrame(double now)
+    {
+        if (!enabled) {
+            windowStart = now;
+            frames = 0;
+            sum.reset();
+            return false;
+        }
+
+        sum.accumulate(RenderStats::frame());
+        frames++;
+
+        if (now - windowStart >= 1.0 && frames > 0) {
+            print(now - windowStart);
+            windowStart = now;
+            frames = 0;
+            sum.reset();
+            return true;
+        }
+        return false;
+    }
+
+private:
+    double windowStart;
+    int frames;
+    RenderStats sum;
+
+    void print(double elapsed) const
+    {
+        std::cout << std::fixed << std::setprecision(2)
+                  << "[stats] fps: " << frames / elapsed
+                  << " | draw calls: " << sum.drawCalls / frames
+                  << " | instances: " << sum.instancesDrawn / frames
+                  << " | programs/uniforms/binds: " << sum.programSwitches / frames << "/"
+                  << sum.uniformUploads / frames << "/" << sum.stateBinds / frames
+                  << " | gl state calls issued/elided: " << sum.glCallsIssued / frames << "/" << sum.glCallsElided / frames
+                  << " | visible/culled: " << sum.objectsVisible / frames << "/" << sum.objectsCulled / frames
+                  << " | casters/culled: " << sum.shadowCasters / frames << "/" << sum.shadowCastersCulled / frames
+                  << " (cull " << sum.cullMs / frames << " ms)"
+                  << " | shadow gpu: " << sum.shadowGpuMs / frames << " ms"
+                  << " (" << sum.shadowLayersRebuilt << " cached layers rebuilt, "
+                  << sum.shadowRebuildGpuMs / frames << " ms)"
+                  << " | shadow filter gpu: " << sum.shadowFilterGpuMs / frames << " ms"
+                  << " | color gpu: " << sum.colorGpuMs / frames << " ms"
+                  << " | particles gpu: " << sum.particleGpuMs / frames << " ms"
+                  << " | volumetric fog gpu: " << sum.fogVolumeGpuMs / frames << " ms"
+                  << " | upscale gpu: " << sum.upscaleGpuMs / frames << " ms (render scale "
+                  << sum.renderScale / frames << ")"
+                  << " | overdraw: " << sum.overdraw / frames
+                  << " (prepass " << sum.depthPrepassFrames * 100 / frames << "% of frames)"
+                  << " | lights: " << sum.pointLights / frames << " (" << sum.clusterLightRefs / frames
+                  << " cluster refs, bin " << sum.lightBinMs / frames << " ms)"
+                  << " | rain: " << sum.rainParticles / frames << " drops (cpu " << sum.rainCpuMs / frames
+                  << " ms, upload " << sum.rainUploadBytes / (size_t)frames / 1024 << " KB)"
+                  << " | dynamic uploads: " << sum.streamBytes / (size_t)frames / 1024 << " KB ("
+                  << sum.streamUploadMs / frames << " ms, fence wait " << sum.streamWaitMs / frames << " ms)"
+                  << " | cpu frame: " << sum.cpuFrameMs / frames << " ms"
+                  << std::endl;
+    }
+};
+
+#endif
@@ -6,6 +6,7 @@
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <vector>
 
 #if defined (__APPLE__)
 #define GLFW_INCLUDE_GLCOREARB
@@ -17,88 +18,164 @@
 #include <GLFW/glfw3.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include "RenderStats.h"
+#include "GLState.h"
+#include "GLCapabilities.h"
 
 class Shader
 {
 public:
     GLuint shaderProgram;
 
-    Shader() {}
+    Shader() : shaderProgram(0), vertexShader(0), fragmentShader(0), pendingCheck(false) {}
 
     void loadShader(const std::string& vertexShaderFileName, const std::string& fragmentShaderFileName)
     {
         // Read vertex shader from file
-        std::string vertexShaderString;
-        std::ifstream vertexShaderFile(vertexShaderFileName.c_str());
-        std::stringstream vertexShaderStream;
-        vertexShaderStream << vertexShaderFile.rdbuf();
-        vertexShaderFile.close();
-        vertexShaderString = vertexShaderStream.str();
+        std::string vertexShaderString = readShaderSource(vertexShaderFileName);
         const char* vertexShaderSource = vertexShaderString.c_str();
 
         // Read fragment shader from file
-        std::string fragmentShaderString;
-        std::ifstream fragmentShaderFile(fragmentShaderFileName.c_str());
-        std::stringstream fragmentShaderStream;
-        fragmentShaderStream << fragmentShaderFile.rdbuf();
-        fragmentShaderFile.close();
-        fragmentShaderString = fragmentShaderStream.str();
+        std::string fragmentShaderString = readShaderSource(fragmentShaderFileName);
         const char* fragmentShaderSource = fragmentShaderString.c_str();
 
         // Compile vertex shader
-        GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
+        vertexShader = glCreateShader(GL_VERTEX_SHADER);
         glShaderSource(vertexShader, 1, &vertexShaderSource, NULL);
         glCompileShader(vertexShader);
-        checkCompileErrors(vertexShader, "VERTEX");
 
         // Compile fragment shader
-        GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+        fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
         glShaderSource(fragmentShader, 1, &fragmentShaderSource, NULL);
         glCompileShader(fragmentShader);
-        checkCompileErrors(fragmentShader, "FRAGMENT");
 
         // Link shaders
         shaderProgram = glCreateProgram();
         glAttachShader(shaderProgram, vertexShader);
         glAttachShader(shaderProgram, fragmentShader);
         glLinkProgram(shaderProgram);
-        checkCompileErrors(shaderProgram, "PROGRAM");
 
-        glDeleteShader(vertexShader);
-        glDeleteShader(fragmentShader);
+        // With parallel compilation the status queries would wait for the
+        // driver threads, so they are postponed to the first use and the
+        // remaining shaders and assets load in the meantime
+        pendingCheck = true;
+        if (!GLCapabilities::get().useParallelShaderCompile) finishCompile();
+    }
+
+    // Vertex-only program whose outputs are captured with transform
+    // feedback (interleaved, in the order given); draw it with
+    // GL_RASTERIZER_DISCARD enabled
+    void loadFeedbackShader(const std::string& vertexShaderFileName, const std::vector<const char*>& varyings)
+    {
+        std::string vertexShaderString = readShaderSource(vertexShaderFileName);
+        const char* vertexShaderSource = vertexShaderString.c_str();
+
+        vertexShader = glCreateShader(GL_VERTEX_SHADER);
+        glShaderSource(vertexShader, 1, &vertexShaderSource, NULL);
+        glCompileShader(vertexShader);
+
+        shaderProgram = glCreateProgram();
+        glAttachShader(shaderProgram, vertexShader);
+        glTransformFeedbackVaryings(shaderProgram, (GLsizei)varyings.size(), varyings.data(), GL_INTERLEAVED_ATTRIBS);
+        glLinkProgram(shaderProgram);
+
+        pendingCheck = true;
+        if (!GLCapabilities::get().useParallelShaderCompile) finishCompile();
     }
 
     void useShaderProgram()
     {
-        glUseProgram(shaderProgram);
+        if (pendingCheck) finishCompile();
+        GLState::useProgram(shaderProgram);
     }
 
     void setMat4(const std::string& name, const glm::mat4& mat)
     {
         glUniformMatrix4fv(glGetUniformLocation(shaderProgram, name.c_str()), 1, GL_FALSE, glm::value_ptr(mat));
+        RenderStats::frame().uniformUploads++;
+    }
+
+    void setVec2(const std::string& name, const glm::vec2& value)
+    {
+        glUniform2fv(glGetUniformLocation(shaderProgram, name.c_str()), 1, glm::value_ptr(value));
+        RenderStats::frame().uniformUploads++;
     }
 
     void setVec3(const std::string& name, const glm::vec3& value)
     {
         glUniform3fv(glGetUniformLocation(shaderProgram, name.c_str()), 1, glm::value_ptr(value));
+        RenderStats::frame().uniformUploads++;
+    }
+
+    void setVec4(const std::string& name, const glm::vec4& value)
+    {
+        glUniform4fv(glGetUniformLocation(shaderProgram, name.c_str()), 1, glm::value_ptr(value));
+        RenderStats::frame().uniformUploads++;
     }
 
     void setInt(const std::string& name, int value)
     {
         glUniform1i(glGetUniformLocation(shaderProgram, name.c_str()), value);
+        RenderStats::frame().uniformUploads++;
     }
 
     void setBool(const std::string& name, bool value)
     {
         glUniform1i(glGetUniformLocation(shaderProgram, name.c_str()), (int)value);
+        RenderStats::frame().uniformUploads++;
     }
 
     void setFloat(const std::string& name, float value)
     {
         glUniform1f(glGetUniformLocation(shaderProgram, name.c_str()), value);
+        RenderStats::frame().uniformUploads++;
     }
 
 private:
+    GLuint vertexShader, fragmentShader;
+    bool pendingCheck;
+
+    void finishCompile()
+    {
+        pendingCheck = false;
+        checkCompileErrors(vertexShader, "VERTEX");
+        if (fragmentShader) checkCompileErrors(fragmentShader, "FRAGMENT");
+        checkCompileErrors(shaderProgram, "PROGRAM");
+
+        glDeleteShader(vertexShader);
+        if (fragmentShader) glDeleteShader(fragmentShader);
+        vertexShader = fragmentShader = 0;
+    }
+
+    // Reads a shader file and expands `#include "file"` lines (paths are
+    // relative to the including file), so shaders can share GLSL functions
+    static std::string readShaderSource(const std::string& fileName, int depth = 0)
+    {
+        std::ifstream file(fileName.c_str());
+        if (!file.is_open()) {
+            std::cout << "ERROR: could not open shader file " << fileName << std::endl;
+            return "";
+        }
+
+        std::string directory;
+        size_t slash = fileName.find_last_of("/\\");
+        if (slash != std::string::npos) directory = fileName.substr(0, slash + 1);
+
+        std::stringstream source;
+        std::string line;
+        while (std::getline(file, line)) {
+            size_t open = line.find("#include \"");
+            if (open != std::string::npos && depth < 8) {
+                size_t close = line.find('"', open + 10);
+                source << readShaderSource(directory + line.substr(open + 10, close - open - 10), depth + 1) << "\n";
+            }
+            else {
+                source << line << "\n";
+            }
+        }
+        return source.str();
+    }
+
     void checkCompileErrors(GLuint shader, std::string type)
     {
         GLint success;
@@ -0,0 +1,112 @@
+#pragma once
+#ifndef ShadowCascades_h
+#define ShadowCascades_h
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <cmath>
+
+// O felie a frustumului camerei și matricea de lumină care o acoperă
+struct ShadowCascade {
+    glm::mat4 lightSpaceMatrix;
+    float splitNear; // distanța în spațiul vederii
+    float splitFar;
+    float radius;    // jumătatea laturii proiecției luminii (sfera feliei plus banda de siguranță)
+    float depthRange; // unitățile de lume acoperite de adâncimea proiecției luminii
+};
+
+// Hărți de umbră în cascadă pentru o lumină direcțională. Adâncimea vederii
+// până la shadowDistance e împărțită în `count` felii; fiecare felie primește
+// propria matrice ortografică de lumină, potrivită pe sfera care o cuprinde.
+//
+// O sferă nu își schimbă mărimea când camera se rotește, iar centrul ei e
+// aliniat la texeli întregi ai hărții de umbră în spațiul luminii, deci
+// matricele se schimbă doar în pași discreți și marginile umbrelor nu
+// tremură în mișcare.
+//
+// Cu guardBand > 0 centrul e aliniat în schimb la o grilă mult mai rară:
+// celule de guardBand x radius (rotunjite în jos la texeli întregi), cu
+// proiecția mărită cu aceeași cantitate ca sfera să încapă mereu. Matricea
+// unei cascade rămâne atunci aceeași cât camera se mișcă sau se rotește în
+// aceeași celulă, ceea ce permite cache-ului de umbre statice să își
+// refolosească straturile; prețul e guardBand / (1 + guardBand) din texeli.
+class ShadowCascades
+{
+public:
+    static const int MAX_CASCADES = 4;
+
+    int count;
+    int resolution;       // texeli pe latură în fiecare strat de cascadă
+    float shadowDistance; // fără umbre dincolo de această adâncime a vederii
+    float splitLambda;    // 1 = împărțire logaritmică, 0 = împărțire uniformă
+    float casterMargin;   // adâncime în plus în spatele fiecărei felii pentru obiectele din afara ecranului
+    float guardBand;      // celula de aliniere și marginea proiecției, ca fracție din rază (0 = aliniere la texel)
+    ShadowCascade cascades[MAX_CASCADES];
+
+    ShadowCascades()
+        : count(3), resolution(2048), shadowDistance(90.0f), splitLambda(0.75f), casterMargin(50.0f),
+          guardBand(0.0f) {}
+
+    void update(const glm::mat4& view, float fovY, float aspect, float nearPlane, const glm::vec3& lightDir)
+    {
+        glm::mat4 inverseView = glm::inverse(view);
+        float tanY = tan(fovY * 0.5f);
+        float tanX = tanY * aspect;
+
+        // Baza luminii: doar rotație, folosită la alinierea centrelor feliilor la texeli
+        glm::vec3 direction = glm::normalize(lightDir);
+        glm::vec3 up = fabs(direction.y) > 0.99f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+        glm::mat4 lightRotation = glm::lookAt(glm::vec3(0.0f), direction, up);
+        glm::mat4 inverseLightRotation = glm::inverse(lightRotation);
+
+        float splitStart = nearPlane;
+        for (int i = 0; i < count; i++) {
+            float splitEnd = splitDistance(i + 1, nearPlane);
+            ShadowCascade& cascade = cascades[i];
+            cascade.splitNear = splitStart;
+            cascade.splitFar = splitEnd;
+
+            // Sfera care cuprinde felia, în spațiul vederii. Centrul stă pe axa
+            // vederii, deci doar raza depinde de proiecție.
+            float centerZ = (splitStart + splitEnd) * 0.5f;
+            glm::vec3 nearCorner(tanX * splitStart, tanY * splitStart, splitStart - centerZ);
+            glm::vec3 farCorner(tanX * splitEnd, tanY * splitEnd, splitEnd - centerZ);
+            float radius = std::max(glm::length(nearCorner), glm::length(farCorner));
+            radius = ceil(radius * 16.0f) / 16.0f;
+            float extent = radius * (1.0f + guardBand);
+            cascade.radius = extent;
+
+            glm::vec3 center = glm::vec3(inverseView * glm::vec4(0.0f, 0.0f, -centerZ, 1.0f));
+
+            // Aliniază centrul la texeli întregi ai acestei cascade, în pași de
+            // un texel sau de banda de siguranță. Alinierea îl mută cu mai puțin
+            // de un pas pe axă, pe care banda de siguranță îl acoperă.
+            float texelSize = 2.0f * extent / (float)resolution;
+            float snapStep = std::max(floor(radius * guardBand / texelSize), 1.0f) * texelSize;
+            glm::vec3 lightCenter = glm::vec3(lightRotation * glm::vec4(center, 1.0f));
+            lightCenter = glm::floor(lightCenter / snapStep) * snapStep;
+            center = glm::vec3(inverseLightRotation * glm::vec4(lightCenter, 1.0f));
+
+            float backDistance = extent + casterMargin;
+            glm::mat4 lightView = glm::lookAt(center - direction * backDistance, center, up);
+            cascade.depthRange = backDistance + extent;
+            glm::mat4 lightProjection = glm::ortho(-extent, extent, -extent, extent, 0.0f, cascade.depthRange);
+            cascade.lightSpaceMatrix = lightProjection * lightView;
+
+            splitStart = splitEnd;
+        }
+    }
+
+private:
+    // Amestec între pozițiile logaritmice și cele uniforme ale feliilor (Zhang et al.)
+    float splitDistance(int index, float nearPlane) const
+    {
+        float t = (float)index / (float)count;
+        float logSplit = nearPlane * pow(shadowDistance / nearPlane, t);
+        float uniformSplit = nearPlane + (shadowDistance - nearPlane) * t;
+        return splitLambda * logSplit + (1.0f - splitLambda) * uniformSplit;
+    }
+};
+
+#endif
@@ -0,0 +1,138 @@
+#pragma once
+#ifndef ShadowFilter_h
+#define ShadowFilter_h
+
+#if defined (__APPLE__)
+#define GLFW_INCLUDE_GLCOREARB
+#else
+#define GLEW_STATIC
+#include <GL/glew.h>
+#endif
+
+#include <GLFW/glfw3.h>
+#include "Shader.h"
+#include "GLState.h"
+
+// Hărți de umbră exponențiale. Fiecare strat de cascadă din textura de
+// adâncime devine exp(exponent * depth) și e estompat cu un filtru gaussian
+// separabil de 9 eșantioane, la rezoluția hărții de umbră. basic.frag are
+// apoi nevoie de un singur eșantion biliniar pe fragment în loc de o buclă
+// PCF 3x3.
+class EsmShadowFilter
+{
+public:
+    GLuint esmTexture;  // texture array R32F, un strat pe cascadă
+    float exponent;
+
+    EsmShadowFilter() : esmTexture(0), exponent(80.0f), fbo(0), tempTexture(0), emptyVAO(0),
+        resolution(0), layerCount(0) {}
+
+    void init(int size, int layers)
+    {
+        blurShader.loadShader("shaders/fullscreen.vert", "shaders/esm_blur.frag");
+        glGenFramebuffers(1, &fbo);
+        // Profilul core cere un VAO legat chiar și când vârfurile vin din gl_VertexID
+        glGenVertexArrays(1, &emptyVAO);
+        resize(size, layers);
+    }
+
+    void resize(int size, int layers)
+    {
+        deleteTextures();
+        resolution = size;
+        layerCount = layers;
+
+        glGenTextures(1, &esmTexture);
+        GLState::bindTexture(GL_TEXTURE_2D_ARRAY, esmTexture);
+        glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_R32F, size, size, layers, 0, GL_RED, GL_FLOAT, NULL);
+        setFilterParameters(GL_TEXTURE_2D_ARRAY);
+
+        glGenTextures(1, &tempTexture);
+        GLState::bindTexture(GL_TEXTURE_2D, tempTexture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, size, size, 0, GL_RED, GL_FLOAT, NULL);
+        setFilterParameters(GL_TEXTURE_2D);
+    }
+
+    // Convertește și estompează primele `count` straturi din depthArray în esmTexture
+    void filter(GLuint depthArray, int count)
+    {
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        glViewport(0, 0, resolution, resolution);
+        GLState::disable(GL_DEPTH_TEST);
+        GLState::disable(GL_CULL_FACE);
+        GLState::bindVertexArray(emptyVAO);
+
+        blurShader.useShaderProgram();
+        blurShader.setFloat("exponent", exponent);
+        blurShader.setInt("depthLayers", 0);
+        blurShader.setInt("source", 1);
+        GLState::activeTexture(GL_TEXTURE0);
+        GLState::bindTexture(GL_TEXTURE_2D_ARRAY, depthArray);
+        GLState::bindSampler(0, 0);
+        GLState::activeTexture(GL_TEXTURE1);
+        GLState::bindSampler(1, 0);
+
+        float texel = 1.0f / (float)resolution;
+        for (int layer = 0; layer < count && layer < layerCount; layer++) {
+            // Orizontal: stratul de adâncime -> exp(c * depth) -> temp
+            // (temp e dezlegat cât e țintă de randare, ca să nu apară o buclă de feedback)
+            GLState::bindTexture(GL_TEXTURE_2D, 0);
+            glFramebufferTexture(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, tempTexture, 0);
+            blurShader.setBool("fromDepth", true);
+            blurShader.setInt("layer", layer);
+            blurShader.setVec2("direction", glm::vec2(texel, 0.0f));
+            glDrawArrays(GL_TRIANGLES, 0, 3);
+
+            // Vertical: temp -> stratul ESM
+            glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, esmTexture, 0, layer);
+            GLState::bindTexture(GL_TEXTURE_2D, tempTexture);
+            blurShader.setBool("fromDepth", false);
+            blurShader.setVec2("direction", glm::vec2(0.0f, texel));
+            glDrawArrays(GL_TRIANGLES, 0, 3);
+        }
+
+        GLState::bindVertexArray(0);
+        GLState::activeTexture(GL_TEXTURE0);
+        GLState::enable(GL_DEPTH_TEST);
+        GLState::enable(GL_CULL_FACE);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+
+    // Trebuie apelat cât contextul GL încă există
+    void release()
+    {
+        deleteTextures();
+        if (fbo) glDeleteFramebuffers(1, &fbo);
+        if (emptyVAO) GLState::deleteVertexArrays(1, &emptyVAO);
+        if (blurShader.shaderProgram) GLState::deleteProgram(blurShader.shaderProgram);
+        fbo = 0;
+        emptyVAO = 0;
+        blurShader.shaderProgram = 0;
+    }
+
+private:
+    Shader blurShader;
+    GLuint fbo;
+    GLuint tempTexture;
+    GLuint emptyVAO;
+    int resolution;
+    int layerCount;
+
+    static void setFilterParameters(GLenum target)
+    {
+        glTexParameteri(target, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(target, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(target, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    }
+
+    void deleteTextures()
+    {
+        if (esmTexture) GLState::deleteTextures(1, &esmTexture);
+        if (tempTexture) GLState::deleteTextures(1, &tempTexture);
+        esmTexture = 0;
+        tempTexture = 0;
+    }
+};
+
+#endif
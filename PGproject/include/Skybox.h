@@ -15,6 +15,7 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include "GLState.h"
 
 // Forward declare stbi functions (implementation is in TextureLoader.h)
 extern "C" {
@@ -32,10 +33,10 @@ public:
     Skybox() : VAO(0), VBO(0), textureID(0), shaderProgram(0) {}
 
     ~Skybox() {
-        if (VAO) glDeleteVertexArrays(1, &VAO);
-        if (VBO) glDeleteBuffers(1, &VBO);
-        if (textureID) glDeleteTextures(1, &textureID);
-        if (shaderProgram) glDeleteProgram(shaderProgram);
+        if (VAO) GLState::deleteVertexArrays(1, &VAO);
+        if (VBO) GLState::deleteBuffers(1, &VBO);
+        if (textureID) GLState::deleteTextures(1, &textureID);
+        if (shaderProgram) GLState::deleteProgram(shaderProgram);
     }
 
     bool load(const std::string& path) {
@@ -88,12 +89,12 @@ public:
         // Create VAO and VBO
         glGenVertexArrays(1, &VAO);
         glGenBuffers(1, &VBO);
-        glBindVertexArray(VAO);
-        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        GLState::bindVertexArray(VAO);
+        GLState::bindBuffer(GL_ARRAY_BUFFER, VBO);
         glBufferData(GL_ARRAY_BUFFER, sizeof(skyboxVertices), &skyboxVertices, GL_STATIC_DRAW);
         glEnableVertexAttribArray(0);
         glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
-        glBindVertexArray(0);
+        GLState::bindVertexArray(0);
 
         // Load cubemap textures
         // Order: +X, -X, +Y, -Y, +Z, -Z (right, left, top, bottom, front, back)
@@ -122,9 +123,9 @@ public:
     }
 
     void draw(const glm::mat4& view, const glm::mat4& projection) {
-        glDepthFunc(GL_LEQUAL);
-        glDepthMask(GL_FALSE); // Disable depth writing
-        glUseProgram(shaderProgram);
+        GLState::depthFunc(GL_LEQUAL);
+        GLState::depthMask(GL_FALSE); // Disable depth writing
+        GLState::useProgram(shaderProgram);
 
         // Remove translation from view matrix
         glm::mat4 viewNoTranslation = glm::mat4(glm::mat3(view));
@@ -134,20 +135,20 @@ public:
         glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(viewNoTranslation));
         glUniformMatrix4fv(projLoc, 1, GL_FALSE, glm::value_ptr(projection));
 
-        glBindVertexArray(VAO);
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_CUBE_MAP, textureID);
+        GLState::bindVertexArray(VAO);
+        GLState::activeTexture(GL_TEXTURE0);
+        GLState::bindTexture(GL_TEXTURE_CUBE_MAP, textureID);
         glDrawArrays(GL_TRIANGLES, 0, 36);
-        glBindVertexArray(0);
-        glDepthMask(GL_TRUE); // Re-enable depth writing
-        glDepthFunc(GL_LESS);
+        GLState::bindVertexArray(0);
+        GLState::depthMask(GL_TRUE); // Re-enable depth writing
+        GLState::depthFunc(GL_LESS);
     }
 
 private:
     GLuint loadCubemap(const std::vector<std::string>& faces) {
         GLuint texture;
         glGenTextures(1, &texture);
-        glBindTexture(GL_TEXTURE_CUBE_MAP, texture);
+        GLState::bindTexture(GL_TEXTURE_CUBE_MAP, texture);
 
         int width, height, nrChannels;
         stbi_set_flip_vertically_on_load(false);
@@ -248,7 +249,7 @@ private:
         glDeleteShader(fragmentShader);
 
         // Set skybox sampler
-        glUseProgram(shaderProgram);
+        GLState::useProgram(shaderProgram);
         glUniform1i(glGetUniformLocation(shaderProgram, "skybox"), 0);
 
         return true;
@@ -0,0 +1,228 @@
+#pragma once
+#ifndef StaticBatcher_h
+#define StaticBatcher_h
+
+#if defined (__APPLE__)
+#define GLFW_INCLUDE_GLCOREARB
+#else
+#define GLEW_STATIC
+#include <GL/glew.h>
+#endif
+
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <unordered_map>
+#include <utility>
+#include <cmath>
+#include <iostream>
+#include "Model.h"
+#include "Camera.h"
+#include "Culling.h"
+#include "GeometryPool.h"
+#include "Shader.h"
+
+// Un material al unui compartiment: un interval de indici din vârfurile compartimentului
+struct StaticBatchRange {
+    const Material* material;
+    PoolAllocation mesh; // baseVertex al compartimentului, firstIndex / indexCount ale intervalului
+};
+
+// Toate obiectele statice a căror poziție cade într-o celulă a grilei,
+// transformate dinainte în spațiul lumii și unite
+struct StaticBatch {
+    int cellX, cellZ;
+    AABB bounds;
+    int objectCount;
+    std::vector<StaticBatchRange> ranges;
+    PoolAllocation mesh;      // vârfuri complete, GeometryPool::meshes()
+    PoolAllocation depthMesh; // doar poziții, un singur interval pentru toate materialele
+};
+
+// Gruparea statică la încărcare. Obiectele care nu se mișcă niciodată sunt
+// copiate în spațiul lumii și unite pe celule bucketSize x bucketSize ale
+// planului XZ, așa că un compartiment costă un desen pe material (un desen în
+// trecerile doar de adâncime) cu matricea de model identitate, și totuși
+// fiecare compartiment poate fi eliminat după cutia lui. Compartimentele mai
+// mari înseamnă mai puține desene, dar mai multă geometrie desenată când doar o
+// parte e vizibilă; fiecare obiect costă și propria copie a vârfurilor, în loc
+// să le împartă pe ale modelului.
+class StaticBatcher
+{
+public:
+    float bucketSize;
+    std::vector<StaticBatch> batches;
+
+    // Completate de build(), vezi printReport()
+    size_t sharedBytes;   // geometria modelelor grupate, comună instanțelor lor
+    size_t batchedBytes;  // geometria tuturor compartimentelor
+    int objectDraws;      // desenele obiectelor unul câte unul
+    int modelDraws;       // desenele obiectelor instanțiate pe model
+    int batchDraws;       // desenele tuturor compartimentelor
+
+    StaticBatcher() : bucketSize(16.0f), sharedBytes(0), batchedBytes(0), objectDraws(0), modelDraws(0),
+        batchDraws(0) {}
+
+    void add(Model* model, const glm::mat4& matrix)
+    {
+        if (!model || !model->mesh.valid()) return;
+        sources.push_back(Source{ model, matrix });
+    }
+
+    bool empty() const { return batches.empty(); }
+
+    void build()
+    {
+        std::map<std::pair<int, int>, std::vector<int>> cells;
+        for (size_t i = 0; i < sources.size(); i++) {
+            glm::vec3 position(sources[i].matrix[3]);
+            int x = (int)std::floor(position.x / bucketSize);
+            int z = (int)std::floor(position.z / bucketSize);
+            cells[std::make_pair(x, z)].push_back((int)i);
+        }
+
+        std::vector<Model*> models;
+        for (auto& cell : cells) {
+            batches.push_back(buildBatch(cell.first.first, cell.first.second, cell.second));
+            for (int i : cell.second) {
+                Model* model = sources[i].model;
+                objectDraws += (int)model->materialGroups.size();
+                if (std::find(models.begin(), models.end(), model) == models.end()) models.push_back(model);
+            }
+        }
+        for (Model* model : models) {
+            modelDraws += (int)model->materialGroups.size();
+            sharedBytes += model->mesh.vertexCount * 11 * sizeof(float) + model->mesh.indexCount * sizeof(unsigned int)
+                + model->depthMesh.vertexCount * 3 * sizeof(float) + model->depthMesh.indexCount * sizeof(unsigned int);
+        }
+        for (const StaticBatch& batch : batches) {
+            batchDraws += (int)batch.ranges.size();
+            batchedBytes += batch.mesh.vertexCount * 11 * sizeof(float) + batch.mesh.indexCount * sizeof(unsigned int)
+                + batch.depthMesh.vertexCount * 3 * sizeof(float) + batch.depthMesh.indexCount * sizeof(unsigned int);
+        }
+        sources.clear();
+    }
+
+    // Trecerea de culoare / G-buffer fără coada de randare; matricea de model
+    // e identitatea. visible are un indicator pe compartiment, nullptr le desenează pe toate.
+    void draw(Shader& shader, const unsigned char* visible)
+    {
+        shader.setMat4("model", glm::mat4(1.0f));
+        for (size_t b = 0; b < batches.size(); b++) {
+            if (visible && !visible[b]) continue;
+            for (const StaticBatchRange& range : batches[b].ranges) {
+                Model::applyMaterial(shader, range.material);
+                GeometryPool::meshes().draw(range.mesh.indexCount, range.mesh.firstIndex, range.mesh.baseVertex);
+            }
+        }
+    }
+
+    // Trecerea de umbră / depth prepass: un compartiment întreg într-un desen
+    void drawDepth(Shader& shader, const unsigned char* visible)
+    {
+        shader.setMat4("model", glm::mat4(1.0f));
+        for (size_t b = 0; b < batches.size(); b++) {
+            if (visible && !visible[b]) continue;
+            const PoolAllocation& depth = batches[b].depthMesh;
+            GeometryPool::positions().draw(depth.indexCount, depth.firstIndex, depth.baseVertex);
+        }
+    }
+
+    void printReport() const
+    {
+        int objects = 0;
+        for (const StaticBatch& batch : batches) objects += batch.objectCount;
+        std::cout << "Static batching: " << objects << " objects in " << batches.size() << " buckets of "
+                  << bucketSize << " m" << std::endl;
+        std::cout << "  draws with everything visible: " << batchDraws << " (one by one " << objectDraws
+                  << ", instanced " << modelDraws << ")" << std::endl;
+        std::cout << "  geometry: " << batchedBytes / 1024 << " KB batched vs " << sharedBytes / 1024
+                  << " KB shared (+" << (batchedBytes > sharedBytes ? (batchedBytes - sharedBytes) / 1024 : 0)
+                  << " KB)" << std::endl;
+    }
+
+    void release()
+    {
+        for (StaticBatch& batch : batches) {
+            GeometryPool::meshes().release(batch.mesh);
+            GeometryPool::positions().release(batch.depthMesh);
+        }
+        batches.clear();
+    }
+
+private:
+    struct Source {
+        Model* model;
+        glm::mat4 matrix;
+    };
+    std::vector<Source> sources;
+
+    StaticBatch buildBatch(int cellX, int cellZ, const std::vector<int>& members)
+    {
+        StaticBatch batch;
+        batch.cellX = cellX;
+        batch.cellZ = cellZ;
+        batch.objectCount = (int)members.size();
+
+        // Triunghiurile fiecărui membru, împărțite pe materiale
+        std::vector<float> vertices, positions;
+        std::unordered_map<std::string, unsigned int> vertexLookup, positionLookup;
+        std::vector<const Material*> materialOrder;
+        std::map<const Material*, std::vector<unsigned int>> materialIndices;
+        std::vector<unsigned int> depthIndices;
+        bool first = true;
+
+        for (int i : members) {
+            const Source& source = sources[i];
+            glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(source.matrix)));
+
+            AABB box = transformAABB(source.model->boundsMin, source.model->boundsMax, source.matrix);
+            if (first) batch.bounds = box;
+            batch.bounds.min = glm::min(batch.bounds.min, box.min);
+            batch.bounds.max = glm::max(batch.bounds.max, box.max);
+            first = false;
+
+            for (const MaterialGroup& group : source.model->materialGroups) {
+                const Material* material = source.model->findMaterial(group);
+                if (materialIndices.find(material) == materialIndices.end()) materialOrder.push_back(material);
+                std::vector<unsigned int>& indices = materialIndices[material];
+
+                for (size_t v = 0; v + 10 < group.vertices.size(); v += 11) {
+                    float vertex[11];
+                    std::copy(&group.vertices[v], &group.vertices[v] + 11, vertex);
+                    glm::vec3 position(source.matrix * glm::vec4(vertex[0], vertex[1], vertex[2], 1.0f));
+                    glm::vec3 normal = glm::normalize(normalMatrix * glm::vec3(vertex[3], vertex[4], vertex[5]));
+                    vertex[0] = position.x; vertex[1] = position.y; vertex[2] = position.z;
+                    vertex[3] = normal.x; vertex[4] = normal.y; vertex[5] = normal.z;
+
+                    indices.push_back(Model::addUniqueVertex(vertex, 11, vertices, vertexLookup));
+                    depthIndices.push_back(Model::addUniqueVertex(vertex, 3, positions, positionLookup));
+                }
+            }
+        }
+
+        std::vector<unsigned int> allIndices;
+        std::vector<std::pair<int, int>> rangeOffsets;
+        for (const Material* material : materialOrder) {
+            const std::vector<unsigned int>& indices = materialIndices[material];
+            rangeOffsets.push_back(std::make_pair((int)allIndices.size(), (int)indices.size()));
+            allIndices.insert(allIndices.end(), indices.begin(), indices.end());
+        }
+
+        batch.mesh = GeometryPool::meshes().allocate(vertices, allIndices);
+        batch.depthMesh = GeometryPool::positions().allocate(positions, depthIndices);
+        for (size_t m = 0; m < materialOrder.size(); m++) {
+            StaticBatchRange range;
+            range.material = materialOrder[m];
+            range.mesh = batch.mesh;
+            range.mesh.firstIndex = batch.mesh.firstIndex + rangeOffsets[m].first;
+            range.mesh.indexCount = rangeOffsets[m].second;
+            batch.ranges.push_back(range);
+        }
+        return batch;
+    }
+};
+
+#endif
@@ -0,0 +1,240 @@
+#pragma once
+#ifndef StreamBuffer_h
+#define StreamBuffer_h
+
+#if defined (__APPLE__)
+#define GLFW_INCLUDE_GLCOREARB
+#else
+#define GLEW_STATIC
+#include <GL/glew.h>
+#endif
+
+#include <GLFW/glfw3.h>
+#include <vector>
+#include <cstring>
+#include <algorithm>
+#include <iostream>
+#include "GLState.h"
+#include "GLCapabilities.h"
+#include "GeometryPool.h"
+#include "RenderStats.h"
+
+// Un interval din stream buffer scris în acest cadru. E valabil până la
+// sfârșitul cadrului; cadrele următoare scriu în alte regiuni.
+struct StreamAllocation {
+    GLuint buffer;
+    size_t offset;
+    size_t bytes;
+
+    StreamAllocation() : buffer(0), offset(0), bytes(0) {}
+    bool valid() const { return buffer != 0; }
+};
+
+// Alocator circular pentru datele care se schimbă la fiecare cadru (matricele
+// instanțelor, comenzile indirecte, pozițiile ploii de pe CPU). Un buffer e
+// împărțit în FRAMES regiuni; un cadru scrie doar în regiunea lui și pune un
+// fence după desenele sale, așa că regiunea e refolosită doar după ce GPU-ul a
+// terminat cu ea și nicio scriere nu așteaptă un desen din cadrul anterior.
+//
+// Cu stocare imutabilă (nivelul azdo) bufferul e mapat o singură dată,
+// persistent și coerent, iar o încărcare e un memcpy. Altfel fiecare încărcare
+// mapează doar intervalul ei cu GL_MAP_UNSYNCHRONIZED_BIT |
+// GL_MAP_INVALIDATE_RANGE_BIT, sigur din același motiv. Când un cadru are
+// nevoie de mai mult decât o regiune, bufferul e înlocuit cu unul mai mare;
+// cel vechi e șters după ce cadrele care l-au folosit s-au terminat.
+//
+// Atât așteptările pe fence-uri cât și încărcările care ocolesc inelul
+// (orphanUpload) sunt cronometrate, ca RenderStats să arate cât stă CPU-ul
+// blocat de datele dinamice cu și fără el.
+class StreamBuffer
+{
+public:
+    static const int FRAMES = 3;
+
+    bool enabled;          // false = consumatorii își orfanizează propriile buffere
+    bool persistent;       // mapat o dată (glBufferStorage) în loc de la fiecare încărcare
+    size_t regionSize;     // octeți pe cadru
+
+    static StreamBuffer& get()
+    {
+        static StreamBuffer stream;
+        return stream;
+    }
+
+    void init(size_t bytesPerFrame = 2 * 1024 * 1024)
+    {
+        regionSize = bytesPerFrame;
+        createBuffer();
+        std::cout << "Stream buffer: " << FRAMES << " x " << regionSize / 1024 << " KB, "
+                  << (persistent ? "persistently mapped" : "unsynchronized map per upload") << std::endl;
+    }
+
+    // Trebuie apelat cât contextul GL încă există
+    void release()
+    {
+        for (int i = 0; i < FRAMES; i++) {
+            if (fences[i]) glDeleteSync(fences[i]);
+            fences[i] = 0;
+        }
+        for (Retired& old : retired) deleteBuffer(old.buffer);
+        retired.clear();
+        deleteBuffer(buffer);
+        buffer = 0;
+        mapped = nullptr;
+    }
+
+    // Trece la regiunea următoare, așteptând GPU-ul dacă încă o citește
+    void beginFrame()
+    {
+        if (!buffer) return;
+        region = (region + 1) % FRAMES;
+        offset = 0;
+
+        if (fences[region]) {
+            GLenum result = glClientWaitSync(fences[region], 0, 0);
+            if (result == GL_TIMEOUT_EXPIRED) {
+                double start = glfwGetTime();
+                do {
+                    result = glClientWaitSync(fences[region], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+                } while (result == GL_TIMEOUT_EXPIRED);
+                RenderStats::frame().streamWaitMs += (glfwGetTime() - start) * 1000.0;
+            }
+            glDeleteSync(fences[region]);
+            fences[region] = 0;
+        }
+
+        for (size_t i = 0; i < retired.size();) {
+            if (--retired[i].framesLeft > 0) {
+                i++;
+                continue;
+            }
+            deleteBuffer(retired[i].buffer);
+            retired.erase(retired.begin() + i);
+        }
+    }
+
+    // După ultimul desen care citește datele acestui cadru
+    void endFrame()
+    {
+        if (!buffer) return;
+        fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+
+    StreamAllocation upload(const void* data, size_t bytes, size_t alignment = 16)
+    {
+        StreamAllocation a;
+        if (!buffer || bytes == 0) return a;
+
+        size_t start = (offset + alignment - 1) / alignment * alignment;
+        if (start + bytes > regionSize) {
+            grow(bytes);
+            start = 0;
+        }
+
+        a.buffer = buffer;
+        a.offset = region * regionSize + start;
+        a.bytes = bytes;
+        offset = start + bytes;
+
+        double begin = glfwGetTime();
+        if (persistent) {
+            memcpy(mapped + a.offset, data, bytes);
+        }
+        else {
+            glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+            void* target = glMapBufferRange(GL_COPY_WRITE_BUFFER, a.offset, bytes,
+                GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+            if (target) memcpy(target, data, bytes);
+            glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+        }
+
+        RenderStats& stats = RenderStats::frame();
+        stats.streamUploadMs += (glfwGetTime() - begin) * 1000.0;
+        stats.streamBytes += bytes;
+        return a;
+    }
+
+    // Calea fără inel: orfanizează bufferul și îl scrie cu glBufferSubData.
+    // capacity crește cât e nevoie; bufferul rămâne legat la target.
+    static void orphanUpload(GLenum target, GLuint buffer, size_t& capacity, const void* data, size_t bytes)
+    {
+        double begin = glfwGetTime();
+        GLState::bindBuffer(target, buffer);
+        if (bytes > capacity) {
+            capacity = std::max(bytes, capacity * 2);
+        }
+        glBufferData(target, capacity, nullptr, GL_STREAM_DRAW);
+        glBufferSubData(target, 0, bytes, data);
+
+        RenderStats& stats = RenderStats::frame();
+        stats.streamUploadMs += (glfwGetTime() - begin) * 1000.0;
+        stats.streamBytes += bytes;
+    }
+
+private:
+    struct Retired {
+        GLuint buffer;
+        int framesLeft;
+    };
+
+    GLuint buffer;
+    unsigned char* mapped;
+    GLsync fences[FRAMES];
+    int region;
+    size_t offset; // următorul octet liber din regiunea curentă
+    std::vector<Retired> retired;
+
+    StreamBuffer() : enabled(true), persistent(false), regionSize(0), buffer(0), mapped(nullptr),
+        region(0), offset(0)
+    {
+        for (int i = 0; i < FRAMES; i++) fences[i] = 0;
+    }
+
+    void createBuffer()
+    {
+        glGenBuffers(1, &buffer);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+        GLsizeiptr bytes = (GLsizeiptr)(regionSize * FRAMES);
+        persistent = false;
+        mapped = nullptr;
+#if !defined(__APPLE__)
+        if (GLCapabilities::get().useBufferStorage) {
+            GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+            glBufferStorage(GL_COPY_WRITE_BUFFER, bytes, nullptr, flags);
+            mapped = (unsigned char*)glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, bytes, flags);
+            persistent = mapped != nullptr;
+        }
+#endif
+        if (!persistent) {
+            glBufferData(GL_COPY_WRITE_BUFFER, bytes, nullptr, GL_STREAM_DRAW);
+        }
+    }
+
+    // Un cadru nu mai încape în regiunea lui: continuă la începutul unui
+    // buffer de două ori mai mare. Fence-urile țin de bufferul vechi, care
+    // trăiește până se termină toate cadrele care au scris în el.
+    void grow(size_t needed)
+    {
+        retired.push_back(Retired{ buffer, FRAMES });
+        for (int i = 0; i < FRAMES; i++) {
+            if (fences[i]) glDeleteSync(fences[i]);
+            fences[i] = 0;
+        }
+        while (regionSize < needed) regionSize *= 2;
+        regionSize *= 2;
+        region = 0;
+        offset = 0;
+        createBuffer();
+        std::cout << "Stream buffer grown to " << FRAMES << " x " << regionSize / 1024 << " KB" << std::endl;
+    }
+
+    static void deleteBuffer(GLuint& name)
+    {
+        if (!name) return;
+        GeometryPool::meshes().forgetInstanceBuffer(name);
+        GeometryPool::positions().forgetInstanceBuffer(name);
+        GLState::deleteBuffers(1, &name);
+    }
+};
+
+#endif
@@ -11,6 +11,8 @@
 
 #include <GLFW/glfw3.h>
 #include <iostream>
+#include "GLState.h"
+#include "GLCapabilities.h"
 
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
@@ -39,8 +41,19 @@ public:
             else if (nrChannels == 4)
                 format = GL_RGBA;
 
-            glBindTexture(GL_TEXTURE_2D, textureID);
-            glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
+            // Driver-compressed when available: 4-8x less memory and bandwidth per sample
+            GLenum internalFormat = format;
+            if (GLCapabilities::get().useCompressedTextures) {
+                if (nrChannels == 1)
+                    internalFormat = GL_COMPRESSED_RED_RGTC1;
+                else if (nrChannels == 3)
+                    internalFormat = GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+                else if (nrChannels == 4)
+                    internalFormat = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+            }
+
+            GLState::bindTexture(GL_TEXTURE_2D, textureID);
+            glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, GL_UNSIGNED_BYTE, data);
             glGenerateMipmap(GL_TEXTURE_2D);
 
             glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
@@ -49,8 +62,7 @@ public:
             glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
             // Anisotropic filtering pentru calitate mai bun? la unghiuri oblice
-            GLfloat maxAniso = 0.0f;
-            glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &maxAniso);
+            GLfloat maxAniso = GLCapabilities::get().maxAnisotropy;
             if (maxAniso > 0.0f) {
                 glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY_EXT, maxAniso);
             }
@@ -63,7 +75,7 @@ public:
         else
         {
             std::cout << "Failed to load texture: " << path << std::endl;
-            glDeleteTextures(1, &textureID);
+            GLState::deleteTextures(1, &textureID);
             return 0;
         }
     }
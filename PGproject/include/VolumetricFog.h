@@ -0,0 +1,308 @@
+#pragma once
+#ifndef VolumetricFog_h
+#define VolumetricFog_h
+
+#if defined (__APPLE__)
+#define GLFW_INCLUDE_GLCOREARB
+#else
+#define GLEW_STATIC
+#include <GL/glew.h>
+#endif
+
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <iostream>
+#include <cmath>
+#include "Shader.h"
+#include "GLState.h"
+#include "RenderStats.h"
+
+// Ceață volumetrică într-un volum de froxeli: o grilă 3D aliniată cu
+// frustumul vederii, SIZE_X x SIZE_Y celule de ecran pe SIZE_Z felii
+// exponențiale de adâncime între volumeNear și volumeFar.
+//
+// La fiecare cadru:
+//   1. scatter: fiecare froxel primește extincția și lumina împrăștiată spre
+//      cameră (ambientală, luna cu umbra ei în cascadă, lămpile din clusterul
+//      lui de lumini). Doar o felie din updateInterval e evaluată, alta la
+//      fiecare cadru, cu un nou decalaj de adâncime. Celelalte sunt
+//      reproiectate din volumul cadrului trecut cu view-projection-ul
+//      anterior, așa că un froxel costă un singur eșantion de textură în
+//      majoritatea cadrelor. Alegerea se face pe felie, nu pe froxel: toate
+//      benzile unui warp de pe GPU iau atunci aceeași ramură, iar feliile
+//      sărite chiar sar peste umbră și lămpi.
+//   2. integrate: din față spre spate, pe fiecare coloană (x, y), într-un al
+//      doilea volum: rgb = lumina împrăștiată până la capătul feliei,
+//      a = transmitanța. După fiecare desen, ultima lui felie e copiată
+//      într-o textură de transport SIZE_X x SIZE_Y de la care pornește
+//      desenul următor, deci fiecare felie e integrată o singură dată.
+//   3. apply: o trecere pe tot ecranul citește adâncimea scenei și amestecă
+//      culoare * transmitanță + lumină, cu un eșantion 3D pe pixel.
+//
+// GL 4.1 nu are compute shaders, deci 1 și 2 sunt treceri de fragmente peste
+// grila SIZE_X x SIZE_Y care scriu câte 8 felii odată prin 8 atașamente de
+// culoare (straturi ale texturii 3D).
+//
+// Shaderul de scatter include lighting.glsl: uniformele lui de iluminare
+// (scatterShader, deja în uz după beginScatter()) se setează înainte de update().
+class VolumetricFog
+{
+public:
+    static const int SIZE_X = 160;
+    static const int SIZE_Y = 90;
+    static const int SIZE_Z = 64;
+    static const int SLICES_PER_DRAW = 8;
+
+    Shader scatterShader;
+    float volumeNear, volumeFar;
+    int updateInterval;     // un froxel e recalculat la fiecare updateInterval cadre
+    float historyWeight;    // partea din valoarea reproiectată păstrată când e recalculat
+    float density;          // extincția pe metru peste tot ...
+    float heightDensity;    // ... plus aceasta la heightBase, împărțită la e la fiecare 1 / heightFalloff metri deasupra
+    float heightFalloff;
+    float heightBase;
+    glm::vec3 ambient;      // culoarea ceții în depărtare
+    float moonScattering;
+    float lampScattering;
+    float anisotropy;       // g din Henyey-Greenstein, > 0 împrăștie înainte (halouri în jurul lămpilor)
+
+    VolumetricFog() : volumeNear(0.5f), volumeFar(120.0f), updateInterval(4), historyWeight(0.5f),
+        density(0.008f), heightDensity(0.03f), heightFalloff(0.35f), heightBase(0.0f), ambient(0.2f, 0.2f, 0.25f),
+        moonScattering(1.5f), lampScattering(6.0f), anisotropy(0.35f), current(0), frameIndex(0),
+        historyValid(false), fbo(0), integratedTexture(0), carryTexture(0), emptyVAO(0), previousViewProjection(1.0f)
+    {
+        scatterTextures[0] = scatterTextures[1] = 0;
+    }
+
+    void init()
+    {
+        scatterShader.loadShader("shaders/fullscreen.vert", "shaders/froxel_scatter.frag");
+        integrateShader.loadShader("shaders/fullscreen.vert", "shaders/froxel_integrate.frag");
+        applyShader.loadShader("shaders/fullscreen.vert", "shaders/volumetric_fog.frag");
+        // Profilul core cere un VAO legat chiar și când vârfurile vin din gl_VertexID
+        glGenVertexArrays(1, &emptyVAO);
+
+        scatterTextures[0] = createVolume();
+        scatterTextures[1] = createVolume();
+        integratedTexture = createVolume();
+        glGenTextures(1, &carryTexture);
+        GLState::bindTexture(GL_TEXTURE_2D, carryTexture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, SIZE_X, SIZE_Y, 0, GL_RGBA, GL_FLOAT, NULL);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glGenFramebuffers(1, &fbo);
+        std::cout << "Volumetric fog: " << SIZE_X << "x" << SIZE_Y << "x" << SIZE_Z << " froxels, "
+                  << volumeNear << "-" << volumeFar << " m, each recomputed every " << updateInterval
+                  << " frames" << std::endl;
+    }
+
+    Shader& beginScatter()
+    {
+        scatterShader.useShaderProgram();
+        return scatterShader;
+    }
+
+    // Pașii 1 și 2 pentru camera acestui cadru. Lasă legat framebufferul
+    // implicit; viewportul e refăcut de apply().
+    void update(const glm::mat4& view, const glm::mat4& projection, float fovY, float aspect, bool heightFog)
+    {
+        int previous = current;
+        current = 1 - current;
+        glm::vec2 tanHalfFov(tan(fovY * 0.5f) * aspect, tan(fovY * 0.5f));
+
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        glViewport(0, 0, SIZE_X, SIZE_Y);
+        GLState::disable(GL_DEPTH_TEST);
+        GLState::disable(GL_BLEND);
+        GLState::bindVertexArray(emptyVAO);
+        GLenum drawBuffers[SLICES_PER_DRAW];
+        for (int i = 0; i < SLICES_PER_DRAW; i++) drawBuffers[i] = GL_COLOR_ATTACHMENT0 + i;
+        glDrawBuffers(SLICES_PER_DRAW, drawBuffers);
+
+        // 1. Împrăștierea, cu volumul cadrului trecut ca istoric
+        Shader& scatter = scatterShader;
+        scatter.useShaderProgram();
+        bindVolume(HISTORY_UNIT, scatterTextures[previous]);
+        scatter.setInt("history", HISTORY_UNIT);
+        scatter.setBool("historyValid", historyValid);
+        scatter.setMat4("previousViewProjection", previousViewProjection);
+        scatter.setMat4("inverseView", glm::inverse(view));
+        scatter.setVec2("tanHalfFov", tanHalfFov);
+        setVolumeUniforms(scatter);
+        scatter.setInt("frameIndex", frameIndex);
+        scatter.setInt("updateInterval", updateInterval);
+        scatter.setFloat("sliceJitter", jitter(frameIndex));
+        scatter.setFloat("historyWeight", historyWeight);
+        scatter.setFloat("fogDensity", density);
+        scatter.setFloat("heightFogDensity", heightFog ? heightDensity : 0.0f);
+        scatter.setFloat("heightFogFalloff", heightFalloff);
+        scatter.setFloat("heightFogBase", heightBase);
+        scatter.setVec3("ambientLight", ambient);
+        scatter.setFloat("moonScattering", moonScattering);
+        scatter.setFloat("lampScattering", lampScattering);
+        scatter.setFloat("anisotropy", anisotropy);
+        drawSlices(scatter, scatterTextures[current]);
+
+        // 2. Integrarea din față spre spate
+        integrateShader.useShaderProgram();
+        bindVolume(HISTORY_UNIT, scatterTextures[current]);
+        integrateShader.setInt("scattering", HISTORY_UNIT);
+        integrateShader.setVec2("tanHalfFov", tanHalfFov);
+        setVolumeUniforms(integrateShader);
+        drawIntegration();
+
+        glDrawBuffer(GL_COLOR_ATTACHMENT0);
+        GLState::bindVertexArray(0);
+        GLState::enable(GL_DEPTH_TEST);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+        previousViewProjection = projection * view;
+        historyValid = true;
+        frameIndex++;
+    }
+
+    // Pasul 3 peste framebufferul implicit (w x h); nearPlane și farPlane sunt
+    // cele ale proiecției cu care a fost randată adâncimea scenei
+    void apply(GLuint sceneDepth, int w, int h, float nearPlane, float farPlane)
+    {
+        glViewport(0, 0, w, h);
+        GLState::disable(GL_DEPTH_TEST);
+        GLState::enable(GL_BLEND);
+        GLState::blendFunc(GL_ONE, GL_SRC_ALPHA); // scena * transmitanța + lumina împrăștiată
+
+        applyShader.useShaderProgram();
+        bindVolume(HISTORY_UNIT, integratedTexture);
+        applyShader.setInt("integratedVolume", HISTORY_UNIT);
+        GLState::activeTexture(GL_TEXTURE0 + DEPTH_UNIT);
+        GLState::bindTexture(GL_TEXTURE_2D, sceneDepth);
+        GLState::bindSampler(DEPTH_UNIT, 0);
+        GLState::activeTexture(GL_TEXTURE0);
+        applyShader.setInt("sceneDepth", DEPTH_UNIT);
+        applyShader.setFloat("nearPlane", nearPlane);
+        applyShader.setFloat("farPlane", farPlane);
+        applyShader.setFloat("volumeNear", volumeNear);
+        applyShader.setFloat("volumeFar", volumeFar);
+        applyShader.setInt("volumeSlices", SIZE_Z);
+        GLState::bindVertexArray(emptyVAO);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        GLState::bindVertexArray(0);
+        RenderStats::frame().drawCalls++;
+
+        GLState::disable(GL_BLEND);
+        GLState::enable(GL_DEPTH_TEST);
+    }
+
+    // După un salt (sau cât ceața a fost oprită) istoricul nu mai are sens
+    void invalidateHistory() { historyValid = false; }
+
+    // Trebuie apelat cât contextul GL încă există
+    void release()
+    {
+        if (fbo) glDeleteFramebuffers(1, &fbo);
+        GLuint textures[4] = { scatterTextures[0], scatterTextures[1], integratedTexture, carryTexture };
+        GLState::deleteTextures(4, textures);
+        if (emptyVAO) GLState::deleteVertexArrays(1, &emptyVAO);
+        Shader* shaders[3] = { &scatterShader, &integrateShader, &applyShader };
+        for (Shader* shader : shaders) {
+            if (shader->shaderProgram) GLState::deleteProgram(shader->shaderProgram);
+            shader->shaderProgram = 0;
+        }
+        fbo = emptyVAO = integratedTexture = carryTexture = 0;
+        scatterTextures[0] = scatterTextures[1] = 0;
+        historyValid = false;
+    }
+
+private:
+    // Peste unitățile folosite de setLightingUniforms (0-6) și G-buffer-ul deferred (7-9)
+    static const int HISTORY_UNIT = 10;
+    static const int DEPTH_UNIT = 11;
+    static const int CARRY_UNIT = 15; // peste upscale-ul rezoluției dinamice (12-14)
+
+    Shader integrateShader, applyShader;
+    GLuint scatterTextures[2]; // ping-pong: cadrul acesta / cadrul trecut
+    int current;
+    int frameIndex;
+    bool historyValid;
+    GLuint fbo, integratedTexture, carryTexture, emptyVAO;
+    glm::mat4 previousViewProjection;
+
+    // Poziția în froxel pe z: șirul van der Corput în baza 2
+    static float jitter(int frame)
+    {
+        float value = 0.0f, base = 0.5f;
+        for (unsigned n = (unsigned)frame & 255u; n; n >>= 1, base *= 0.5f) {
+            if (n & 1u) value += base;
+        }
+        return value;
+    }
+
+    static GLuint createVolume()
+    {
+        GLuint texture;
+        glGenTextures(1, &texture);
+        GLState::bindTexture(GL_TEXTURE_3D, texture);
+        glTexImage3D(GL_TEXTURE_3D, 0, GL_RGBA16F, SIZE_X, SIZE_Y, SIZE_Z, 0, GL_RGBA, GL_FLOAT, NULL);
+        glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+        GLState::bindTexture(GL_TEXTURE_3D, 0);
+        return texture;
+    }
+
+    static void bindVolume(int unit, GLuint texture)
+    {
+        GLState::activeTexture(GL_TEXTURE0 + unit);
+        GLState::bindTexture(GL_TEXTURE_3D, texture);
+        GLState::bindSampler(unit, 0);
+        GLState::activeTexture(GL_TEXTURE0);
+    }
+
+    void setVolumeUniforms(Shader& shader)
+    {
+        glUniform3i(glGetUniformLocation(shader.shaderProgram, "volumeSize"), SIZE_X, SIZE_Y, SIZE_Z);
+        shader.setFloat("volumeNear", volumeNear);
+        shader.setFloat("volumeFar", volumeFar);
+    }
+
+    // Un desen pe tot ecranul pentru fiecare SLICES_PER_DRAW straturi din target
+    void drawSlices(Shader& shader, GLuint target)
+    {
+        for (int first = 0; first < SIZE_Z; first += SLICES_PER_DRAW) {
+            for (int i = 0; i < SLICES_PER_DRAW; i++) {
+                glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + i, target, 0, first + i);
+            }
+            shader.setInt("firstSlice", first);
+            glDrawArrays(GL_TRIANGLES, 0, 3);
+            RenderStats::frame().drawCalls++;
+        }
+    }
+
+    // drawSlices pentru integrare: starea coloanei la sfârșitul fiecărui desen
+    // (ultima lui felie) e copiată în carryTexture pentru desenul următor.
+    // Copia ține desenele la cele 8 atașamente de culoare garantate de GL 4.1.
+    void drawIntegration()
+    {
+        GLState::activeTexture(GL_TEXTURE0 + CARRY_UNIT);
+        GLState::bindTexture(GL_TEXTURE_2D, carryTexture);
+        GLState::bindSampler(CARRY_UNIT, 0);
+        integrateShader.setInt("carry", CARRY_UNIT);
+        glReadBuffer(GL_COLOR_ATTACHMENT0 + SLICES_PER_DRAW - 1);
+        for (int first = 0; first < SIZE_Z; first += SLICES_PER_DRAW) {
+            for (int i = 0; i < SLICES_PER_DRAW; i++) {
+                glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + i, integratedTexture, 0, first + i);
+            }
+            integrateShader.setInt("firstSlice", first);
+            glDrawArrays(GL_TRIANGLES, 0, 3);
+            RenderStats::frame().drawCalls++;
+            if (first + SLICES_PER_DRAW < SIZE_Z) {
+                glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 0, 0, SIZE_X, SIZE_Y);
+            }
+        }
+        glReadBuffer(GL_COLOR_ATTACHMENT0);
+        GLState::activeTexture(GL_TEXTURE0);
+    }
+};
+
+#endif
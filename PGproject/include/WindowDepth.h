@@ -0,0 +1,77 @@
+#pragma once
+#ifndef WindowDepth_h
+#define WindowDepth_h
+
+#if defined (__APPLE__)
+#define GLFW_INCLUDE_GLCOREARB
+#else
+#define GLEW_STATIC
+#include <GL/glew.h>
+#endif
+
+#include <GLFW/glfw3.h>
+#include "GLState.h"
+
+// Calea forward randează în framebufferul implicit, a cărui adâncime nu poate
+// fi eșantionată, sau în ținta cu rezoluție dinamică, a cărei adâncime rămâne
+// atașată cât ceața și compunerea particulelor desenează în ea. copy() o
+// copiază cu blit într-o textură, pentru trecerile care au nevoie apoi de
+// adâncimea scenei (ceața, particulele la rezoluție redusă). DEPTH24_STENCIL8
+// corespunde biților impliciți de depth/stencil din GLFW, cum cere un blit de adâncime.
+//
+// Se copiază doar colțul w x h; textura are textureWidth x textureHeight,
+// mărimea sursei, deci o mărime de randare care se schimbă nu o realocă.
+class WindowDepth
+{
+public:
+    GLuint texture;
+
+    WindowDepth() : texture(0), fbo(0), width(0), height(0) {}
+
+    GLuint copy(GLuint framebuffer, int w, int h, int textureWidth, int textureHeight)
+    {
+        if (width != textureWidth || height != textureHeight) create(textureWidth, textureHeight);
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, fbo);
+        glBlitFramebuffer(0, 0, w, h, 0, 0, w, h, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        return texture;
+    }
+
+    // Trebuie apelat cât contextul GL încă există
+    void release()
+    {
+        if (fbo) glDeleteFramebuffers(1, &fbo);
+        GLState::deleteTextures(1, &texture);
+        fbo = texture = 0;
+        width = height = 0;
+    }
+
+private:
+    GLuint fbo;
+    int width, height;
+
+    void create(int w, int h)
+    {
+        release();
+        width = w;
+        height = h;
+
+        glGenTextures(1, &texture);
+        GLState::bindTexture(GL_TEXTURE_2D, texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH24_STENCIL8, w, h, 0, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8, NULL);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+        glGenFramebuffers(1, &fbo);
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, texture, 0);
+        glDrawBuffer(GL_NONE);
+        glReadBuffer(GL_NONE);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+};
+
+#endif
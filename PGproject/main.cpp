@@ -16,11 +16,37 @@
 #include "include/TextureLoader.h"
 #include "include/Model.h"
 #include "include/Skybox.h"
+#include "include/InstanceBatch.h"
+#include "include/RenderStats.h"
+#include "include/GLState.h"
+#include "include/GeometryPool.h"
+#include "include/GLCapabilities.h"
+#include "include/StaticBatcher.h"
+#include "include/GpuRain.h"
+#include "include/RainSimulation.h"
+#include "include/RainOcclusion.h"
+#include "include/StreamBuffer.h"
+#include "include/Culling.h"
+#include "include/GpuTimer.h"
+#include "include/ShadowCascades.h"
+#include "include/ShadowFilter.h"
+#include "include/ClusteredLights.h"
+#include "include/GBuffer.h"
+#include "include/GpuSampleCounter.h"
+#include "include/RenderQueue.h"
+#include "include/ParticleSystem.h"
+#include "include/LowResParticles.h"
+#include "include/WindowDepth.h"
+#include "include/FogPass.h"
+#include "include/VolumetricFog.h"
+#include "include/DynamicResolution.h"
 #include <vector>
+#include <algorithm>
 #include <cstdlib>
+#include <cstdio>
 
-const int GL_WINDOW_WIDTH = 1280;
-const int GL_WINDOW_HEIGHT = 720;
+int GL_WINDOW_WIDTH = 1280; // --window WxH
+int GL_WINDOW_HEIGHT = 720;
 
 GLFWwindow* glWindow = NULL;
 
@@ -34,13 +60,53 @@ float lastFrame = 0.0f;
 
 Shader basicShader;
 Shader shadowShader;
-GLuint groundVAO, groundVBO, groundEBO;
+// Calea deferred: trecerea G-buffer + trecerea de iluminare pe tot ecranul
+Shader gBufferShader;
+Shader deferredLightingShader;
+GBuffer gBuffer;
+GLuint fullscreenVAO;
+bool deferredShadingEnabled = false;
+// Depth prepass: întâi adâncimea opacă, apoi trecerea de culoare forward colorează cu GL_EQUAL
+enum DepthPrepassMode { DEPTH_PREPASS_OFF = 0, DEPTH_PREPASS_ON = 1, DEPTH_PREPASS_AUTO = 2 };
+int depthPrepassMode = DEPTH_PREPASS_AUTO;
+const char* depthPrepassNames[] = { "off", "on", "auto" };
+Shader depthPrepassShader;
+bool depthPrepassActive = false;
+float overdrawEstimate = 0.0f; // fragmentele care trec testul de adâncime pe pixel, netezit
+const float PREPASS_ENABLE_OVERDRAW = 1.8f; // modul auto pornește prepass-ul peste această valoare...
+const float PREPASS_DISABLE_OVERDRAW = 1.4f; // ...și îl oprește din nou sub aceasta
+GpuSampleCounter overdrawCounter;
+// Desenele opace ale trecerii de culoare / G-buffer, sortate după stare și adâncime la fiecare cadru
+RenderQueue opaqueQueue;
+bool renderQueueEnabled = true;
+Material groundMaterial;
+PoolAllocation groundMesh;
 GLuint pavementTexture;
 
+// Shadow map în cascadă: câte un strat dintr-un texture array de adâncime pe cascadă
 GLuint shadowMapFBO;
 GLuint shadowMapTexture;
-const unsigned int SHADOW_WIDTH = 2048, SHADOW_HEIGHT = 2048;
-glm::mat4 lightSpaceMatrix;
+ShadowCascades shadowCascades;
+// Straturile statice de umbră: randate pe cascadă, copiate în shadowMapTexture la fiecare cadru.
+// Un strat e refăcut când se schimbă matricea de lumină a cascadei lui; cu cache-ul pornit
+// cascadele se aliniază la celule de un sfert din rază (banda de siguranță), deci asta se
+// întâmplă doar când camera iese dintr-o celulă, nu la fiecare pas sau rotire.
+GLuint staticShadowFBO;
+GLuint staticShadowTexture;
+bool shadowCacheEnabled = true;
+bool staticShadowDirty = true;
+glm::mat4 cachedCascadeMatrices[ShadowCascades::MAX_CASCADES];
+const float SHADOW_CACHE_GUARD_BAND = 0.25f;
+// Filtrarea umbrelor: PCF 3x3 manual, PCF hardware (sampler2DArrayShadow) sau
+// hărți de umbră exponențiale filtrate dinainte
+enum ShadowFilterMode { SHADOW_FILTER_PCF = 0, SHADOW_FILTER_HARDWARE = 1, SHADOW_FILTER_ESM = 2 };
+int shadowFilterMode = SHADOW_FILTER_ESM;
+const char* shadowFilterNames[] = { "3x3 PCF", "hardware PCF", "ESM" };
+EsmShadowFilter esmShadowFilter;
+// Textura de adâncime e legată de două ori, prin samplere cu și fără comparare de adâncime
+GLuint shadowSamplerRaw, shadowSamplerCompare;
+const glm::vec3 moonLightPosition = glm::vec3(15.0f, 35.0f, -30.0f); // Poziția lunii
+const glm::vec3 moonLightTarget = glm::vec3(0.0f, 0.0f, -10.0f);
 
 Model* benchModel;
 Model* lampModel;
@@ -60,6 +126,12 @@ float moonRotation = 0.0f;
 
 // Animation variables
 float lampFlickerTime = 0.0f;
+
+// Luminile punctuale (lămpile și strălucirea lunii), repartizate pe clustere la fiecare cadru
+std::vector<PointLight> pointLights;
+LightClusters lightClusters;
+bool clusteredLightingEnabled = true;
+int extraLampCount = 0; // --extra-lamps N, lămpi cu lumini pentru testarea iluminării pe clustere
 float treeSwayTime = 0.0f;
 float cottonCandyRotation = 0.0f; // Rotația paharului de vată de zahăr
 
@@ -68,23 +140,93 @@ int renderMode = 0;
 
 // Weather effects
 bool fogEnabled = false;
+bool heightFogEnabled = true; // termenul de ceață la sol din fog.frag
+FogPass fogPass;
+VolumetricFog volumetricFog;        // froxeli luminați de lună și lămpi; altfel ceața analitică din FogPass
+bool volumetricFogEnabled = true;
 bool rainEnabled = false;
 float windStrength = 2.0f; // Puterea vântului
 float windTime = 0.0f;
 
-// Rain particle system
-const int MAX_RAIN_PARTICLES = 5000;
-struct RainParticle {
-    glm::vec3 position;
-    float speed;
-};
-std::vector<RainParticle> rainParticles;
+// Sistemul de particule pentru ploaie: simulat pe GPU cu transform feedback, sau
+// pe CPU și încărcat la fiecare cadru. Picăturile trăiesc într-o cutie în jurul
+// camerei care se închide în sine pe x / z, sau (--rain-world) în cutia fixă peste tot parcul.
+bool rainFollowsCamera = true;
+float rainDensity = 0.01f;     // --rain-density D, picături pe metru cub
+float rainBoxWidth = 40.0f;    // --rain-box LxH, cutia din jurul camerei
+float rainBoxHeight = 30.0f;
+int rainParticleCount = -1;    // --rain-drops N; altfel densitate x volum
+RainSimulation cpuRain;
 GLuint rainVAO, rainVBO;
+size_t rainVBOCapacity = 0; // folosit doar când stream buffer-ul e oprit
 Shader rainShader;
+GpuRain gpuRain;
+bool gpuRainEnabled = true;
+bool rainBenchmark = false; // --rain-benchmark: debitul actualizării pe CPU, la pornire
+RainOcclusion rainOcclusion;     // harta de sus a scenei statice: ploaia se oprește pe acoperișuri și coroane
+bool rainOcclusionEnabled = true;
+
+// Particule generice (molii la felinare, frunze din coroane): un pool fix pe emițător,
+// un singur draw instanțiat pe material pentru toate sistemele
+ParticleSystem* mothParticles = nullptr;
+ParticleSystem* leafParticles = nullptr;
+std::vector<ParticleSystem*> particleSystems;
+ParticleRenderer particleRenderer;
+bool particlesEnabled = true;
+LowResParticles lowResParticles; // ploaia și particulele la 1/2 sau 1/4 din rezoluție (--particle-scale N)
+WindowDepth windowDepth;         // copia adâncimii ferestrei pe calea forward (ceață, particule low-res)
+// Scena se randează într-o țintă off-screen la o scară a ferestrei ținută de timpul GPU
+// (--render-scale MIN-MAX, --target-ms MS), apoi e adusă în fereastră cu un upscale temporal
+DynamicResolution dynamicResolution;
 
 // Collision detection
 std::vector<AABB> sceneColliders;
 
+// Instanțele scenei: fiecare bancă, lampă, copac și statuie e o intrare aici.
+// Cu instancing pornit sunt grupate pe Model în InstanceBatch-uri.
+struct SceneInstance {
+    Model* model;
+    glm::vec3 position;
+    float rotationY;
+    float scale;
+    float swayPhase;
+    float swayAmplitude; // grade, 0 = static
+    int batchIndex;
+    bool staticBatched;  // copiat în staticBatcher (bănci, lămpi, statuia, lamp_12)
+};
+std::vector<SceneInstance> sceneInstances;
+std::vector<InstanceBatch*> colorBatches;
+std::vector<InstanceBatch*> shadowBatches[ShadowCascades::MAX_CASCADES];
+bool instancingEnabled = true;
+
+// Static batching: instanțele care nu se mișcă niciodată, transformate dinainte și
+// unite pe compartimente spațiale; compartimentele sunt eliminate ca obiecte separate
+StaticBatcher staticBatcher;
+bool staticBatchingEnabled = true;
+int staticBatchCullId = -1; // cull id-ul primului compartiment
+
+// View-frustum culling: câte o cutie pe instanță a scenei, plus truck-ul și luna,
+// ținute într-un BVH reajustat la fiecare cadru pentru cele animate
+SceneBVH sceneBVH;
+std::vector<AABB> cullBounds;
+std::vector<unsigned char> cullVisible;
+std::vector<unsigned char> shadowVisible[ShadowCascades::MAX_CASCADES];
+std::vector<int> dynamicCullIds;
+int truckCullId = -1;
+int moonCullId = -1;
+bool frustumCullingEnabled = true;
+int extraTreeCount = 0; // --extra-trees N, pentru a măsura cum scalează randarea
+
+StatsReporter statsReporter;
+GpuTimer shadowPassTimer;
+GpuTimer shadowRebuildTimer; // straturile statice refăcute, în afara trecerii de umbră
+GpuTimer shadowFilterTimer;
+GpuTimer colorPassTimer;
+GpuTimer particlePassTimer;
+GpuTimer fogVolumeTimer;
+GpuTimer upscaleTimer;
+bool depthOnlyShadowsEnabled = true; // doar pozițiile în trecerea de umbră
+
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void mouse_callback(GLFWwindow* window, double xpos, double ypos);
@@ -92,11 +234,37 @@ void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
 void processInput(GLFWwindow *window);
 void createGround();
 void initShadowMap();
-void renderSceneDepth(Shader& shader);
+// Ce obiecte care aruncă umbră desenează renderSceneDepth
+enum ShadowCasterSet { CASTERS_ALL, CASTERS_STATIC, CASTERS_DYNAMIC };
+void renderSceneDepth(Shader& shader, ShadowCasterSet casters, int cascade);
+void renderForward(const glm::mat4& view, const glm::mat4& projection);
+void renderDepthPrepass(const glm::mat4& view, const glm::mat4& projection);
+void updateDepthPrepassHeuristic();
+void buildOpaqueQueue(const glm::vec3& eye);
+void renderDeferred(const glm::mat4& view, const glm::mat4& projection);
+void rebuildStaticShadowLayer(int cascade);
+void resizeShadowMaps(int resolution);
 void initRainSystem();
+void buildRainOcclusion();
 void updateRainParticles(float deltaTime);
+void initParticleSystems();
 void renderRain(glm::mat4 view, glm::mat4 projection);
 void initColliders();
+void initSceneInstances();
+void buildStaticBatches();
+void initPointLights();
+void updateInstanceBatches();
+void drawSceneInstances(Shader& shader, bool depthPass, ShadowCasterSet casters = CASTERS_ALL, int cascade = 0);
+void initCulling();
+void cullScene(const glm::mat4& viewProjection);
+glm::mat4 bunnyTruckMatrix(float bobbing);
+glm::mat4 moonMatrix();
+glm::mat4 instanceMatrix(const SceneInstance& instance);
+
+// Desenat ca parte a unui compartiment static batch, nu separat
+bool drawnByStaticBatch(const SceneInstance& instance) {
+    return staticBatchingEnabled && instance.staticBatched;
+}
 
 bool initOpenGLWindow()
 {
@@ -106,11 +274,15 @@ bool initOpenGLWindow()
     }
     
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
     glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
     
-    glWindow = glfwCreateWindow(GL_WINDOW_WIDTH, GL_WINDOW_HEIGHT, "Parc de Distractii - Seara", NULL, NULL);
+    // Cel mai nou context 4.x disponibil, cu 4.1 ca minim (macOS se oprește la 4.1)
+    glWindow = NULL;
+    for (int minor = GLCapabilities::get().preferredContextMinor(); minor >= 1 && !glWindow; minor--) {
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, minor);
+        glWindow = glfwCreateWindow(GL_WINDOW_WIDTH, GL_WINDOW_HEIGHT, "Parc de Distractii - Seara", NULL, NULL);
+    }
     if (!glWindow) {
         fprintf(stderr, "ERROR: could not open window with GLFW3\n");
         glfwTerminate();
@@ -133,887 +305,653 @@ bool initOpenGLWindow()
     const GLubyte* version = glGetString(GL_VERSION);
     printf("Renderer: %s\n", renderer);
     printf("OpenGL version supported %s\n", version);
+
+    // Alege implementarea fiecărui subsistem după ce oferă driverul
+    GLCapabilities::get().probe();
+    GLCapabilities::get().print();
     
-    glEnable(GL_DEPTH_TEST);
+    GLState::enable(GL_DEPTH_TEST);
     
-    glEnable(GL_CULL_FACE);
+    GLState::enable(GL_CULL_FACE);
 
     return true;
 }
 
-void initShadowMap()
+void createShadowDepthTarget(GLuint& fbo, GLuint& texture, int resolution)
 {
     // Creează framebuffer pentru shadow map
-    glGenFramebuffers(1, &shadowMapFBO);
-    
-    // Creează textura pentru depth map
-    glGenTextures(1, &shadowMapTexture);
-    glBindTexture(GL_TEXTURE_2D, shadowMapTexture);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT, SHADOW_WIDTH, SHADOW_HEIGHT, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+    glGenFramebuffers(1, &fbo);
+    
+    // Creează textura pentru depth map (un strat pentru fiecare cascadă)
+    glGenTextures(1, &texture);
+    GLState::bindTexture(GL_TEXTURE_2D_ARRAY, texture);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_DEPTH_COMPONENT24, resolution, resolution,
+        ShadowCascades::MAX_CASCADES, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
     float borderColor[] = { 1.0f, 1.0f, 1.0f, 1.0f };
-    glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, borderColor);
+    glTexParameterfv(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BORDER_COLOR, borderColor);
     
-    // Atașează textura la framebuffer
-    glBindFramebuffer(GL_FRAMEBUFFER, shadowMapFBO);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, shadowMapTexture, 0);
+    // Atașează primul strat; cel curent se alege la fiecare cascadă
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, texture, 0, 0);
     glDrawBuffer(GL_NONE);
     glReadBuffer(GL_NONE);
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
-    
-    std::cout << "Shadow map initialized (" << SHADOW_WIDTH << "x" << SHADOW_HEIGHT << ")" << std::endl;
 }
 
+void initShadowMap()
+{
+    createShadowDepthTarget(shadowMapFBO, shadowMapTexture, shadowCascades.resolution);
+    createShadowDepthTarget(staticShadowFBO, staticShadowTexture, shadowCascades.resolution);
+    esmShadowFilter.init(shadowCascades.resolution, ShadowCascades::MAX_CASCADES);
+
+    glGenSamplers(1, &shadowSamplerRaw);
+    glSamplerParameteri(shadowSamplerRaw, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glSamplerParameteri(shadowSamplerRaw, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glSamplerParameteri(shadowSamplerRaw, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glSamplerParameteri(shadowSamplerRaw, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    // Filtrare liniară + comparare = PCF 2x2 făcut de hardware la fiecare citire
+    glGenSamplers(1, &shadowSamplerCompare);
+    glSamplerParameteri(shadowSamplerCompare, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glSamplerParameteri(shadowSamplerCompare, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glSamplerParameteri(shadowSamplerCompare, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glSamplerParameteri(shadowSamplerCompare, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glSamplerParameteri(shadowSamplerCompare, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+    glSamplerParameteri(shadowSamplerCompare, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+    
+    std::cout << "Shadow map initialized (" << shadowCascades.count << " cascades, "
+              << shadowCascades.resolution << "x" << shadowCascades.resolution << " each, static layer cached)" << std::endl;
+}
 
-void renderScene() {
-
-// Calculează light space matrix (din perspectiva lunii)
-glm::vec3 lightPosition = glm::vec3(15.0f, 35.0f, -30.0f); // Poziția lunii
-float near_plane = 1.0f, far_plane = 100.0f;
-glm::mat4 lightProjection = glm::ortho(-60.0f, 60.0f, -60.0f, 60.0f, near_plane, far_plane);
-glm::mat4 lightView = glm::lookAt(lightPosition, glm::vec3(0.0f, 0.0f, -10.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-lightSpaceMatrix = lightProjection * lightView;
-
-// Render to shadow map
-shadowShader.useShaderProgram();
-shadowShader.setMat4("lightSpaceMatrix", lightSpaceMatrix);
-
-glViewport(0, 0, SHADOW_WIDTH, SHADOW_HEIGHT);
-glBindFramebuffer(GL_FRAMEBUFFER, shadowMapFBO);
-glClear(GL_DEPTH_BUFFER_BIT);
-glCullFace(GL_FRONT);
-renderSceneDepth(shadowShader);
-glCullFace(GL_BACK);
-glBindFramebuffer(GL_FRAMEBUFFER, 0);
+void resizeShadowMaps(int resolution)
+{
+    glDeleteFramebuffers(1, &shadowMapFBO);
+    GLState::deleteTextures(1, &shadowMapTexture);
+    glDeleteFramebuffers(1, &staticShadowFBO);
+    GLState::deleteTextures(1, &staticShadowTexture);
+
+    shadowCascades.resolution = resolution;
+    createShadowDepthTarget(shadowMapFBO, shadowMapTexture, resolution);
+    createShadowDepthTarget(staticShadowFBO, staticShadowTexture, resolution);
+    esmShadowFilter.resize(resolution, ShadowCascades::MAX_CASCADES);
+    staticShadowDirty = true;
+}
 
-glViewport(0, 0, GL_WINDOW_WIDTH, GL_WINDOW_HEIGHT);
+// Randează toate obiectele statice care aruncă umbră (solul, caroseria truck-ului,
+// băncile, lămpile, statuia și copacii care nu se leagănă) în stratul static al
+// unei cascade. E nevoie doar când se schimbă matricea de lumină a cascadei sau
+// geometria statică.
+void rebuildStaticShadowLayer(int cascade)
+{
+    const glm::mat4& lightSpaceMatrix = shadowCascades.cascades[cascade].lightSpaceMatrix;
+    Frustum lightFrustum = Frustum::fromMatrix(lightSpaceMatrix);
+    lightFrustum.planes[4] = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+
+    if (instancingEnabled) {
+        std::vector<InstanceBatch*>& batches = shadowBatches[cascade];
+        for (size_t i = 0; i < batches.size(); i++) {
+            batches[i]->clear();
+        }
+        for (size_t i = 0; i < sceneInstances.size(); i++) {
+            const SceneInstance& instance = sceneInstances[i];
+            if (drawnByStaticBatch(instance)) continue;
+            if (instance.swayAmplitude == 0.0f && lightFrustum.intersects(cullBounds[i])) {
+                batches[instance.batchIndex]->add(instanceMatrix(instance));
+            }
+        }
+        for (size_t i = 0; i < batches.size(); i++) {
+            batches[i]->upload();
+        }
+    }
 
-glClearColor(0.1f, 0.1f, 0.15f, 1.0f); // Dark blue evening sky
-glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    shadowShader.useShaderProgram();
+    shadowShader.setMat4("lightSpaceMatrix", lightSpaceMatrix);
 
-glm::mat4 projection = glm::perspective(glm::radians(camera.Fov),
-    (float)GL_WINDOW_WIDTH / (float)GL_WINDOW_HEIGHT,
-    0.1f,
-    500.0f);
-glm::mat4 view = camera.GetViewMatrix();
-glm::mat4 model = glm::mat4(1.0f);
+    glViewport(0, 0, shadowCascades.resolution, shadowCascades.resolution);
+    glBindFramebuffer(GL_FRAMEBUFFER, staticShadowFBO);
+    glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, staticShadowTexture, 0, cascade);
+    glClear(GL_DEPTH_BUFFER_BIT);
+    GLState::cullFace(GL_FRONT);
+    GLState::enable(GL_DEPTH_CLAMP);
+    renderSceneDepth(shadowShader, CASTERS_STATIC, cascade);
+    GLState::disable(GL_DEPTH_CLAMP);
+    GLState::cullFace(GL_BACK);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
-// Draw skybox
-if (skybox) {
-    skybox->draw(view, projection);
+    cachedCascadeMatrices[cascade] = lightSpaceMatrix;
 }
 
-basicShader.useShaderProgram();
-basicShader.setMat4("projection", projection);
-basicShader.setMat4("view", view);
-
-// Fog uniforms
-basicShader.setBool("fogEnabled", fogEnabled);
-basicShader.setVec3("fogColor", glm::vec3(0.2f, 0.2f, 0.25f));
-basicShader.setFloat("fogDensity", 0.004f);
-basicShader.setVec3("cameraPos", camera.Position);
-
-// Apply render mode
-switch (renderMode) {
-    case 0: // Solid
-        glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-        basicShader.setBool("smoothShading", false);
-        break;
-    case 1: // Wireframe
-        glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-        basicShader.setBool("smoothShading", false);
-        break;
-    case 2: // Points
-        glPolygonMode(GL_FRONT_AND_BACK, GL_POINT);
-        glPointSize(3.0f);
-        basicShader.setBool("smoothShading", false);
-        break;
-    case 3: // Smooth
-        glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-        basicShader.setBool("smoothShading", true);
-        break;
-}
+
+// Uniformele comune pentru iluminare (lighting.glsl): lună, umbre, lumini punctuale
+void setLightingUniforms(Shader& shader) {
+    shader.setBool("smoothShading", renderMode == 3);
 
     // Set lighting uniforms
-    basicShader.setVec3("lightPos", glm::vec3(15.0f, 35.0f, -30.0f)); // Poziția lunii pentru umbre
-    basicShader.setVec3("lightColor", glm::vec3(1.0f, 0.95f, 0.9f)); // Lumină ambientală mai slabă
-    basicShader.setVec3("viewPos", camera.Position);
+    shader.setVec3("lightPos", moonLightPosition); // Poziția lunii pentru umbre
+    shader.setVec3("lightColor", glm::vec3(1.0f, 0.95f, 0.9f)); // Lumină ambientală mai slabă
+    shader.setVec3("viewPos", camera.Position);
     
     // Shadow mapping uniforms
-    basicShader.setMat4("lightSpaceMatrix", lightSpaceMatrix);
-    basicShader.setBool("shadowsEnabled", true);
-    glActiveTexture(GL_TEXTURE1);
-    glBindTexture(GL_TEXTURE_2D, shadowMapTexture);
-    basicShader.setInt("shadowMap", 1);
-    
-    // Set up point lights from lamps
-    float lampHeight = 2.5f;
-    
-    // Lampă 1 pâlpâie
-    float flicker = 0.7f + 0.3f * sin(lampFlickerTime) * sin(lampFlickerTime * 3.7f);
-    
-    glm::vec3 pointLightPositions[8] = {
-        glm::vec3(-8.0f, lampHeight, -20.0f),  // Lampă 1 - pâlpâie
-        glm::vec3(8.0f, lampHeight, -20.0f),   // Lampă 2
-        glm::vec3(-8.0f, lampHeight, 0.0f),    // Lampă 3
-        glm::vec3(8.0f, lampHeight, 0.0f),     // Lampă 4
-        glm::vec3(8.0f, lampHeight, 20.0f),    // Lampă lângă Bunny Truck
-        glm::vec3(-2.0f, 2.5f, -42.0f),        // Lamp12 stânga statuie (mai jos, lămpi mici)
-        glm::vec3(2.0f, 2.5f, -42.0f),         // Lamp12 dreapta statuie
-        glm::vec3(15.0f, 35.0f, -30.0f)        // Luna (lumină slabă)
-    };
-    
-    glm::vec3 pointLightColors[8] = {
-        glm::vec3(1.0f, 0.8f, 0.4f) * flicker * 4.0f,  // Lampă 1 - pâlpâie, galben cald
-        glm::vec3(1.0f, 0.85f, 0.5f) * 4.0f,           // Lampă 2 - galben cald
-        glm::vec3(1.0f, 0.85f, 0.5f) * 4.0f,           // Lampă 3
-        glm::vec3(1.0f, 0.85f, 0.5f) * 4.0f,           // Lampă 4
-        glm::vec3(1.0f, 0.85f, 0.5f) * 4.0f,           // Lampă Bunny Truck
-        glm::vec3(1.0f, 0.7f, 0.3f) * 3.0f,            // Lamp12 stânga - lumină portocalie intensă
-        glm::vec3(1.0f, 0.7f, 0.3f) * 3.0f,            // Lamp12 dreapta - lumină portocalie intensă
-        glm::vec3(0.7f, 0.8f, 1.0f) * 4.0f             // Luna - lumină albăstruie puternică
-    };
-    
-    // Trimite luminile punctuale la shader
-    basicShader.setInt("numPointLights", 8);
-    for (int i = 0; i < 8; i++) {
-        std::string posName = "pointLightPos[" + std::to_string(i) + "]";
-        std::string colorName = "pointLightColor[" + std::to_string(i) + "]";
-        glUniform3fv(glGetUniformLocation(basicShader.shaderProgram, posName.c_str()), 1, glm::value_ptr(pointLightPositions[i]));
-        glUniform3fv(glGetUniformLocation(basicShader.shaderProgram, colorName.c_str()), 1, glm::value_ptr(pointLightColors[i]));
+    shader.setBool("shadowsEnabled", true);
+    shader.setInt("cascadeCount", shadowCascades.count);
+    for (int c = 0; c < shadowCascades.count; c++) {
+        std::string index = "[" + std::to_string(c) + "]";
+        shader.setMat4("cascadeMatrices" + index, shadowCascades.cascades[c].lightSpaceMatrix);
+        shader.setFloat("cascadeSplits" + index, shadowCascades.cascades[c].splitFar);
+        shader.setFloat("cascadeDepthRanges" + index, shadowCascades.cascades[c].depthRange);
+    }
+    shader.setInt("shadowFilter", shadowFilterMode);
+    shader.setFloat("esmExponent", esmShadowFilter.exponent);
+    GLState::activeTexture(GL_TEXTURE1);
+    GLState::bindTexture(GL_TEXTURE_2D_ARRAY, shadowMapTexture);
+    GLState::bindSampler(1, shadowSamplerRaw);
+    shader.setInt("shadowMap", 1);
+    GLState::activeTexture(GL_TEXTURE2);
+    GLState::bindTexture(GL_TEXTURE_2D_ARRAY, shadowMapTexture);
+    GLState::bindSampler(2, shadowSamplerCompare);
+    shader.setInt("shadowMapCompare", 2);
+    GLState::activeTexture(GL_TEXTURE3);
+    GLState::bindTexture(GL_TEXTURE_2D_ARRAY, esmShadowFilter.esmTexture);
+    shader.setInt("shadowMapESM", 3);
+    
+    shader.setInt("numPointLights", (int)pointLights.size());
+    shader.setBool("clusteredLighting", clusteredLightingEnabled);
+    glUniform3i(glGetUniformLocation(shader.shaderProgram, "clusterDims"),
+        LightClusters::DIM_X, LightClusters::DIM_Y, LightClusters::DIM_Z);
+    shader.setFloat("clusterNear", lightClusters.nearPlane);
+    shader.setFloat("clusterFar", lightClusters.farPlane);
+    shader.setVec2("viewportSize", glm::vec2((float)dynamicResolution.width, (float)dynamicResolution.height));
+    GLState::activeTexture(GL_TEXTURE4);
+    GLState::bindTexture(GL_TEXTURE_BUFFER, lightClusters.lightTexture);
+    shader.setInt("lightData", 4);
+    GLState::activeTexture(GL_TEXTURE5);
+    GLState::bindTexture(GL_TEXTURE_BUFFER, lightClusters.gridTexture);
+    shader.setInt("clusterGrid", 5);
+    GLState::activeTexture(GL_TEXTURE6);
+    GLState::bindTexture(GL_TEXTURE_BUFFER, lightClusters.indexTexture);
+    shader.setInt("clusterLightIndices", 6);
+    GLState::activeTexture(GL_TEXTURE0);
+}
+
+// Modul de poligoane al trecerii de geometrie (smooth e o uniformă de iluminare)
+void applyRenderMode() {
+    switch (renderMode) {
+        case 0: // Solid
+            GLState::polygonMode(GL_FILL);
+            break;
+        case 1: // Wireframe
+            GLState::polygonMode(GL_LINE);
+            break;
+        case 2: // Points
+            GLState::polygonMode(GL_POINT);
+            glPointSize(3.0f);
+            break;
+        case 3: // Smooth
+            GLState::polygonMode(GL_FILL);
+            break;
+    }
+}
+
+// Solul, truck-ul, obiectele instanțiate ale scenei și luna, cu uniformele de
+// material din basic.frag / gbuffer.frag
+void drawSceneGeometry(Shader& shader) {
+    if (renderQueueEnabled) {
+        opaqueQueue.submit(shader);
+        return;
     }
 
-    glDisable(GL_CULL_FACE);
+    glm::mat4 model;
+    GLState::disable(GL_CULL_FACE);
     
     model = glm::mat4(1.0f);
-    basicShader.setMat4("model", model);
-    basicShader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
-    basicShader.setBool("useTexture", true);
-    basicShader.setBool("hasEmission", false);
-    basicShader.setVec3("emissionColor", glm::vec3(0.0f, 0.0f, 0.0f));
+    shader.setMat4("model", model);
+    shader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
+    shader.setBool("useTexture", true);
+    shader.setBool("hasEmission", false);
+    shader.setVec3("emissionColor", glm::vec3(0.0f, 0.0f, 0.0f));
 
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, pavementTexture);
-    basicShader.setInt("diffuseTexture", 0);
+    GLState::activeTexture(GL_TEXTURE0);
+    GLState::bindTexture(GL_TEXTURE_2D, pavementTexture);
+    shader.setInt("diffuseTexture", 0);
 
-    glBindVertexArray(groundVAO);
-    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-    glBindVertexArray(0);
+    GeometryPool::meshes().draw(groundMesh.indexCount, groundMesh.firstIndex, groundMesh.baseVertex);
 
-    glBindTexture(GL_TEXTURE_2D, 0);
+    GLState::bindTexture(GL_TEXTURE_2D, 0);
     
-    glEnable(GL_CULL_FACE);
+    GLState::enable(GL_CULL_FACE);
 
     // BUNNY COTTON CANDY TRUCK
-    if (bunnyTruckModel && bunnyTruckModel->vertexCount() > 0) {
+    if (bunnyTruckModel && bunnyTruckModel->vertexCount() > 0 && cullVisible[truckCullId]) {
        
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(8.0f, 0.0f, 28.0f));
-        model = glm::rotate(model, glm::radians(-90.0f), glm::vec3(0.0f, 1.0f, 0.0f)); 
-        model = glm::scale(model, glm::vec3(2.5f, 2.5f, 2.5f));
-        basicShader.setMat4("model", model);
-        basicShader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
-        bunnyTruckModel->drawExcept(basicShader, "Material.003"); 
+        model = bunnyTruckMatrix(0.0f);
+        shader.setMat4("model", model);
+        shader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
+        bunnyTruckModel->drawExcept(shader, "Material.003"); 
         
         float bobbing = sin(cottonCandyRotation * 2.0f) * 0.02f; 
         
-        glm::mat4 bunnyModel = glm::mat4(1.0f);
-        bunnyModel = glm::translate(bunnyModel, glm::vec3(8.0f, bobbing, 28.0f)); 
-        bunnyModel = glm::rotate(bunnyModel, glm::radians(-90.0f), glm::vec3(0.0f, 1.0f, 0.0f)); 
-        bunnyModel = glm::scale(bunnyModel, glm::vec3(2.5f, 2.5f, 2.5f)); 
+        glm::mat4 bunnyModel = bunnyTruckMatrix(bobbing);
         
-        basicShader.setMat4("model", bunnyModel);
-        bunnyTruckModel->drawMaterialGroup(basicShader, "Material.003");
+        shader.setMat4("model", bunnyModel);
+        bunnyTruckModel->drawMaterialGroup(shader, "Material.003");
     }
 
-    // Lampă lângă Bunny Truck
-    if (lampModel && lampModel->vertexCount() > 0) {
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(8.0f, 0.0f, 20.0f));
-        model = glm::scale(model, glm::vec3(0.3f, 0.3f, 0.3f));
-        basicShader.setMat4("model", model);
-        basicShader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
-        lampModel->draw(basicShader);
-    }
-
-    //BENCHES
-    if (benchModel && benchModel->vertexCount() > 0) {
-
-        // Bancă 1
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(-8.0f, 0.0f, -30.0f));
-        model = glm::rotate(model, glm::radians(90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-        model = glm::scale(model, glm::vec3(0.8f, 0.8f, 0.8f));
-        basicShader.setMat4("model", model);
-        basicShader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
-        benchModel->draw(basicShader);
-
-        // Bancă 2
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(-8.0f, 0.0f, -10.0f));
-        model = glm::rotate(model, glm::radians(90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-        model = glm::scale(model, glm::vec3(0.8f, 0.8f, 0.8f));
-        basicShader.setMat4("model", model);
-        basicShader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
-        benchModel->draw(basicShader);
-
-        // Bancă 3
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(8.0f, 0.0f, -30.0f));
-        model = glm::rotate(model, glm::radians(-90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-        model = glm::scale(model, glm::vec3(0.8f, 0.8f, 0.8f));
-        basicShader.setMat4("model", model);
-        basicShader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
-        benchModel->draw(basicShader);
-
-        // Bancă 4
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(8.0f, 0.0f, -10.0f));
-        model = glm::rotate(model, glm::radians(-90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-        model = glm::scale(model, glm::vec3(0.8f, 0.8f, 0.8f));
-        basicShader.setMat4("model", model);
-        basicShader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
-        benchModel->draw(basicShader);
-
-        // Bancă 5
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(-8.0f, 0.0f, 10.0f));
-        model = glm::rotate(model, glm::radians(90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-        model = glm::scale(model, glm::vec3(0.8f, 0.8f, 0.8f));
-        basicShader.setMat4("model", model);
-        basicShader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
-        benchModel->draw(basicShader);
-
-        // Bancă 6
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(8.0f, 0.0f, 10.0f));
-        model = glm::rotate(model, glm::radians(-90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-        model = glm::scale(model, glm::vec3(0.8f, 0.8f, 0.8f));
-        basicShader.setMat4("model", model);
-        basicShader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
-        benchModel->draw(basicShader);
+    // BĂNCI, LĂMPI STRADALE, COPACI, STATUIA ÎNGERULUI, LAMP_12
+    drawSceneInstances(shader, false);
+    if (staticBatchingEnabled && !staticBatcher.empty()) {
+        staticBatcher.draw(shader, &cullVisible[staticBatchCullId]);
+    }
 
+    //  MOON
+    if (moonModel && moonModel->vertexCount() > 0 && cullVisible[moonCullId]) {
+        model = moonMatrix();
+        shader.setMat4("model", model);
+        shader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 0.9f)); 
+        moonModel->draw(shader);
     }
+}
 
-    // STREET LAMPS
-    if (lampModel && lampModel->vertexCount() > 0) {
-
-        // Lampă 1
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(-8.0f, 0.0f, -20.0f));
-        model = glm::rotate(model, glm::radians(180.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-        model = glm::scale(model, glm::vec3(0.3f, 0.3f, 0.3f));
-        basicShader.setMat4("model", model);
-        basicShader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
-        lampModel->draw(basicShader);
-
-        // Lampă 2
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(8.0f, 0.0f, -20.0f));
-        model = glm::scale(model, glm::vec3(0.3f, 0.3f, 0.3f));
-        basicShader.setMat4("model", model);
-        basicShader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
-        lampModel->draw(basicShader);
-
-        // Lampă 3
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(-8.0f, 0.0f, 0.0f));
-        model = glm::rotate(model, glm::radians(180.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-        model = glm::scale(model, glm::vec3(0.3f, 0.3f, 0.3f));
-        basicShader.setMat4("model", model);
-        basicShader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
-        lampModel->draw(basicShader);
-
-        // Lampă 4
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(8.0f, 0.0f, 0.0f));
-        model = glm::scale(model, glm::vec3(0.3f, 0.3f, 0.3f));
-        basicShader.setMat4("model", model);
-        basicShader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
-        lampModel->draw(basicShader);
-
-    }
-
-    //TREES (în spatele băncilor) 
-    
-    // 
-    if (spruceTreeModel && spruceTreeModel->vertexCount() > 0) {
-        float sway = sin(treeSwayTime + 0.0f) * 2.0f;
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(-14.0f, 0.0f, -42.0f));
-        model = glm::rotate(model, glm::radians(sway), glm::vec3(0.0f, 0.0f, 1.0f));
-        model = glm::scale(model, glm::vec3(0.9f, 0.9f, 0.9f));
-        basicShader.setMat4("model", model);
-        basicShader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
-        spruceTreeModel->draw(basicShader);
+void renderForward(const glm::mat4& view, const glm::mat4& projection) {
+    glClearColor(0.1f, 0.1f, 0.15f, 1.0f); // Dark blue evening sky
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    // Prepass-ul are sens doar pentru poligoane pline (nu wireframe / puncte)
+    bool filled = renderMode == 0 || renderMode == 3;
+    bool prepass = filled && depthPrepassActive;
+    if (prepass) {
+        renderDepthPrepass(view, projection);
     }
 
-    if (pineTreeModel && pineTreeModel->vertexCount() > 0) {
-        float sway = sin(treeSwayTime + 1.0f) * 1.8f;
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(-14.0f, 0.0f, -34.0f));
-        model = glm::rotate(model, glm::radians(sway), glm::vec3(0.0f, 0.0f, 1.0f));
-        model = glm::scale(model, glm::vec3(0.85f, 0.85f, 0.85f));
-        basicShader.setMat4("model", model);
-        basicShader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
-        pineTreeModel->draw(basicShader);
+    // Skybox-ul (după prepass umple doar pixelii rămași pe planul îndepărtat)
+    if (skybox) {
+        skybox->draw(view, projection);
+        RenderStats::frame().drawCalls++;
     }
 
-    if (oakTreeModel && oakTreeModel->vertexCount() > 0) {
-        float sway = sin(treeSwayTime + 2.0f) * 1.5f;
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(-14.0f, 0.0f, -26.0f));
-        model = glm::rotate(model, glm::radians(sway), glm::vec3(0.0f, 0.0f, 1.0f));
-        model = glm::scale(model, glm::vec3(0.95f, 0.95f, 0.95f));
-        basicShader.setMat4("model", model);
-        basicShader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
-        oakTreeModel->draw(basicShader);
+    basicShader.useShaderProgram();
+    basicShader.setMat4("projection", projection);
+    basicShader.setMat4("view", view);
+    applyRenderMode();
+    setLightingUniforms(basicShader);
+    if (prepass) {
+        // Fiecare pixel e umbrit o singură dată: doar fragmentul rămas în depth buffer trece
+        GLState::depthFunc(GL_EQUAL);
+        GLState::depthMask(GL_FALSE);
+    }
+    else if (filled) {
+        overdrawCounter.begin();
+    }
+    drawSceneGeometry(basicShader);
+    if (prepass) {
+        GLState::depthMask(GL_TRUE);
+        GLState::depthFunc(GL_LESS);
+    }
+    else if (filled) {
+        overdrawCounter.end();
     }
 
-    if (lindenTreeModel && lindenTreeModel->vertexCount() > 0) {
-        float sway = sin(treeSwayTime + 3.0f) * 2.2f;
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(-14.0f, 0.0f, -18.0f));
-        model = glm::rotate(model, glm::radians(sway), glm::vec3(0.0f, 0.0f, 1.0f));
-        model = glm::scale(model, glm::vec3(0.8f, 0.8f, 0.8f));
-        basicShader.setMat4("model", model);
-        basicShader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
-        lindenTreeModel->draw(basicShader);
+    if (filled) {
+        updateDepthPrepassHeuristic();
     }
+}
 
-    if (pineTreeModel && pineTreeModel->vertexCount() > 0) {
-        float sway = sin(treeSwayTime + 4.0f) * 1.7f;
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(-20.0f, 0.0f, -44.0f));
-        model = glm::rotate(model, glm::radians(sway), glm::vec3(0.0f, 0.0f, 1.0f));
-        model = glm::scale(model, glm::vec3(0.95f, 0.95f, 0.95f));
-        basicShader.setMat4("model", model);
-        basicShader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
-        pineTreeModel->draw(basicShader);
+// Aceleași desene ca drawSceneGeometry, ca elemente ale cozii de randare sortate
+// după trecere / variantă / textură / material / distanța față de cameră
+void buildOpaqueQueue(const glm::vec3& eye) {
+    opaqueQueue.clear();
+    if (!renderQueueEnabled) return;
+
+    groundMaterial.textureID = pavementTexture;
+    groundMaterial.hasTexture = pavementTexture != 0;
+    opaqueQueue.addMesh(groundMesh, &groundMaterial, glm::mat4(1.0f), 0.0f, true);
+
+    if (bunnyTruckModel && bunnyTruckModel->vertexCount() > 0 && cullVisible[truckCullId]) {
+        glm::mat4 body = bunnyTruckMatrix(0.0f);
+        float depth = glm::length(glm::vec3(body[3]) - eye);
+        opaqueQueue.addModel(bunnyTruckModel, body, depth, nullptr, "Material.003");
+        opaqueQueue.addModel(bunnyTruckModel, bunnyTruckMatrix(sin(cottonCandyRotation * 2.0f) * 0.02f), depth,
+            "Material.003");
     }
 
-    if (oakTreeModel && oakTreeModel->vertexCount() > 0) {
-        float sway = sin(treeSwayTime + 5.0f) * 2.0f;
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(-20.0f, 0.0f, -38.0f));
-        model = glm::rotate(model, glm::radians(sway), glm::vec3(0.0f, 0.0f, 1.0f));
-        model = glm::scale(model, glm::vec3(0.88f, 0.88f, 0.88f));
-        basicShader.setMat4("model", model);
-        basicShader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
-        oakTreeModel->draw(basicShader);
+    if (instancingEnabled) {
+        for (InstanceBatch* batch : colorBatches) {
+            opaqueQueue.addInstanced(*batch);
+        }
+    }
+    else {
+        for (size_t i = 0; i < sceneInstances.size(); i++) {
+            if (!cullVisible[i]) continue;
+            const SceneInstance& instance = sceneInstances[i];
+            if (drawnByStaticBatch(instance)) continue;
+            opaqueQueue.addModel(instance.model, instanceMatrix(instance), glm::length(instance.position - eye));
+        }
     }
 
-    if (spruceTreeModel && spruceTreeModel->vertexCount() > 0) {
-        float sway = sin(treeSwayTime + 6.0f) * 1.6f;
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(-20.0f, 0.0f, -30.0f));
-        model = glm::rotate(model, glm::radians(sway), glm::vec3(0.0f, 0.0f, 1.0f));
-        model = glm::scale(model, glm::vec3(0.92f, 0.92f, 0.92f));
-        basicShader.setMat4("model", model);
-        basicShader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
-        spruceTreeModel->draw(basicShader);
-    }
-
-    if (lindenTreeModel && lindenTreeModel->vertexCount() > 0) {
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(-20.0f, 0.0f, -22.0f));
-        model = glm::scale(model, glm::vec3(0.85f, 0.85f, 0.85f));
-        basicShader.setMat4("model", model);
-        basicShader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
-        lindenTreeModel->draw(basicShader);
-    }
-
-    if (pineTreeModel && pineTreeModel->vertexCount() > 0) {
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(-20.0f, 0.0f, -14.0f));
-        model = glm::scale(model, glm::vec3(0.78f, 0.78f, 0.78f));
-        basicShader.setMat4("model", model);
-        basicShader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
-        pineTreeModel->draw(basicShader);
-    }
-
-    if (oakTreeModel && oakTreeModel->vertexCount() > 0) {
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(-26.0f, 0.0f, -40.0f));
-        model = glm::scale(model, glm::vec3(0.9f, 0.9f, 0.9f));
-        basicShader.setMat4("model", model);
-        basicShader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
-        oakTreeModel->draw(basicShader);
-    }
-
-    if (spruceTreeModel && spruceTreeModel->vertexCount() > 0) {
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(-26.0f, 0.0f, -28.0f));
-        model = glm::scale(model, glm::vec3(0.95f, 0.95f, 0.95f));
-        basicShader.setMat4("model", model);
-        basicShader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
-        spruceTreeModel->draw(basicShader);
-    }
-
-    if (lindenTreeModel && lindenTreeModel->vertexCount() > 0) {
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(-26.0f, 0.0f, -18.0f));
-        model = glm::scale(model, glm::vec3(0.82f, 0.82f, 0.82f));
-        basicShader.setMat4("model", model);
-        basicShader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
-        lindenTreeModel->draw(basicShader);
-    }
-
-    if (pineTreeModel && pineTreeModel->vertexCount() > 0) {
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(14.0f, 0.0f, -42.0f));
-        model = glm::scale(model, glm::vec3(0.85f, 0.85f, 0.85f));
-        basicShader.setMat4("model", model);
-        basicShader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
-        pineTreeModel->draw(basicShader);
-    }
-
-    if (oakTreeModel && oakTreeModel->vertexCount() > 0) {
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(14.0f, 0.0f, -34.0f));
-        model = glm::scale(model, glm::vec3(0.9f, 0.9f, 0.9f));
-        basicShader.setMat4("model", model);
-        basicShader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
-        oakTreeModel->draw(basicShader);
-    }
-
-    if (lindenTreeModel && lindenTreeModel->vertexCount() > 0) {
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(14.0f, 0.0f, -26.0f));
-        model = glm::scale(model, glm::vec3(0.8f, 0.8f, 0.8f));
-        basicShader.setMat4("model", model);
-        basicShader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
-        lindenTreeModel->draw(basicShader);
-    }
-
-    if (spruceTreeModel && spruceTreeModel->vertexCount() > 0) {
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(14.0f, 0.0f, -18.0f));
-        model = glm::scale(model, glm::vec3(0.88f, 0.88f, 0.88f));
-        basicShader.setMat4("model", model);
-        basicShader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
-        spruceTreeModel->draw(basicShader);
-    }
-
-    if (spruceTreeModel && spruceTreeModel->vertexCount() > 0) {
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(20.0f, 0.0f, -44.0f));
-        model = glm::scale(model, glm::vec3(0.92f, 0.92f, 0.92f));
-        basicShader.setMat4("model", model);
-        basicShader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
-        spruceTreeModel->draw(basicShader);
-    }
-
-    if (lindenTreeModel && lindenTreeModel->vertexCount() > 0) {
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(20.0f, 0.0f, -38.0f));
-        model = glm::scale(model, glm::vec3(0.85f, 0.85f, 0.85f));
-        basicShader.setMat4("model", model);
-        basicShader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
-        lindenTreeModel->draw(basicShader);
-    }
-
-    if (pineTreeModel && pineTreeModel->vertexCount() > 0) {
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(20.0f, 0.0f, -30.0f));
-        model = glm::scale(model, glm::vec3(0.88f, 0.88f, 0.88f));
-        basicShader.setMat4("model", model);
-        basicShader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
-        pineTreeModel->draw(basicShader);
-    }
-
-    if (oakTreeModel && oakTreeModel->vertexCount() > 0) {
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(20.0f, 0.0f, -22.0f));
-        model = glm::scale(model, glm::vec3(0.95f, 0.95f, 0.95f));
-        basicShader.setMat4("model", model);
-        basicShader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
-        oakTreeModel->draw(basicShader);
-    }
-
-    if (spruceTreeModel && spruceTreeModel->vertexCount() > 0) {
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(20.0f, 0.0f, -14.0f));
-        model = glm::scale(model, glm::vec3(0.75f, 0.75f, 0.75f));
-        basicShader.setMat4("model", model);
-        basicShader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
-        spruceTreeModel->draw(basicShader);
-    }
-
-    if (pineTreeModel && pineTreeModel->vertexCount() > 0) {
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(26.0f, 0.0f, -40.0f));
-        model = glm::scale(model, glm::vec3(0.9f, 0.9f, 0.9f));
-        basicShader.setMat4("model", model);
-        basicShader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
-        pineTreeModel->draw(basicShader);
-    }
-
-    if (lindenTreeModel && lindenTreeModel->vertexCount() > 0) {
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(26.0f, 0.0f, -28.0f));
-        model = glm::scale(model, glm::vec3(0.88f, 0.88f, 0.88f));
-        basicShader.setMat4("model", model);
-        basicShader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
-        lindenTreeModel->draw(basicShader);
-    }
-
-    if (oakTreeModel && oakTreeModel->vertexCount() > 0) {
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(26.0f, 0.0f, -18.0f));
-        model = glm::scale(model, glm::vec3(0.82f, 0.82f, 0.82f));
-        basicShader.setMat4("model", model);
-        basicShader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
-        oakTreeModel->draw(basicShader);
-    }
-
-    if (lindenTreeModel && lindenTreeModel->vertexCount() > 0) {
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(-14.0f, 0.0f, 4.0f));
-        model = glm::scale(model, glm::vec3(0.88f, 0.88f, 0.88f));
-        basicShader.setMat4("model", model);
-        basicShader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
-        lindenTreeModel->draw(basicShader);
-    }
-
-    if (spruceTreeModel && spruceTreeModel->vertexCount() > 0) {
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(-14.0f, 0.0f, -6.0f));
-        model = glm::scale(model, glm::vec3(0.9f, 0.9f, 0.9f));
-        basicShader.setMat4("model", model);
-        basicShader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
-        spruceTreeModel->draw(basicShader);
-    }
-
-    if (pineTreeModel && pineTreeModel->vertexCount() > 0) {
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(-20.0f, 0.0f, 0.0f));
-        model = glm::scale(model, glm::vec3(0.85f, 0.85f, 0.85f));
-        basicShader.setMat4("model", model);
-        basicShader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
-        pineTreeModel->draw(basicShader);
-    }
-
-    if (oakTreeModel && oakTreeModel->vertexCount() > 0) {
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(-20.0f, 0.0f, -8.0f));
-        model = glm::scale(model, glm::vec3(0.92f, 0.92f, 0.92f));
-        basicShader.setMat4("model", model);
-        basicShader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
-        oakTreeModel->draw(basicShader);
-    }
-
-    if (lindenTreeModel && lindenTreeModel->vertexCount() > 0) {
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(-26.0f, 0.0f, -4.0f));
-        model = glm::scale(model, glm::vec3(0.78f, 0.78f, 0.78f));
-        basicShader.setMat4("model", model);
-        basicShader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
-        lindenTreeModel->draw(basicShader);
-    }
-
-    if (oakTreeModel && oakTreeModel->vertexCount() > 0) {
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(14.0f, 0.0f, 4.0f));
-        model = glm::scale(model, glm::vec3(0.9f, 0.9f, 0.9f));
-        basicShader.setMat4("model", model);
-        basicShader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
-        oakTreeModel->draw(basicShader);
-    }
-
-    if (pineTreeModel && pineTreeModel->vertexCount() > 0) {
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(14.0f, 0.0f, -6.0f));
-        model = glm::scale(model, glm::vec3(0.85f, 0.85f, 0.85f));
-        basicShader.setMat4("model", model);
-        basicShader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
-        pineTreeModel->draw(basicShader);
-    }
-
-    if (spruceTreeModel && spruceTreeModel->vertexCount() > 0) {
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(20.0f, 0.0f, 0.0f));
-        model = glm::scale(model, glm::vec3(0.88f, 0.88f, 0.88f));
-        basicShader.setMat4("model", model);
-        basicShader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
-        spruceTreeModel->draw(basicShader);
-    }
-
-    if (lindenTreeModel && lindenTreeModel->vertexCount() > 0) {
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(20.0f, 0.0f, -8.0f));
-        model = glm::scale(model, glm::vec3(0.82f, 0.82f, 0.82f));
-        basicShader.setMat4("model", model);
-        basicShader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
-        lindenTreeModel->draw(basicShader);
-    }
-
-    if (pineTreeModel && pineTreeModel->vertexCount() > 0) {
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(26.0f, 0.0f, -4.0f));
-        model = glm::scale(model, glm::vec3(0.95f, 0.95f, 0.95f));
-        basicShader.setMat4("model", model);
-        basicShader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
-        pineTreeModel->draw(basicShader);
-    }
-
-    if (spruceTreeModel && spruceTreeModel->vertexCount() > 0) {
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(18.0f, 0.0f, 14.0f));
-        model = glm::scale(model, glm::vec3(0.85f, 0.85f, 0.85f));
-        basicShader.setMat4("model", model);
-        basicShader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
-        spruceTreeModel->draw(basicShader);
-    }
-
-    if (oakTreeModel && oakTreeModel->vertexCount() > 0) {
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(18.0f, 0.0f, 6.0f));
-        model = glm::scale(model, glm::vec3(0.9f, 0.9f, 0.9f));
-        basicShader.setMat4("model", model);
-        basicShader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
-        oakTreeModel->draw(basicShader);
-    }
-
-    if (lindenTreeModel && lindenTreeModel->vertexCount() > 0) {
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(20.0f, 0.0f, 18.0f));
-        model = glm::scale(model, glm::vec3(0.88f, 0.88f, 0.88f));
-        basicShader.setMat4("model", model);
-        basicShader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
-        lindenTreeModel->draw(basicShader);
-    }
-
-    if (pineTreeModel && pineTreeModel->vertexCount() > 0) {
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(24.0f, 0.0f, 10.0f));
-        model = glm::scale(model, glm::vec3(0.92f, 0.92f, 0.92f));
-        basicShader.setMat4("model", model);
-        basicShader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
-        pineTreeModel->draw(basicShader);
-    }
-
-    if (spruceTreeModel && spruceTreeModel->vertexCount() > 0) {
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(26.0f, 0.0f, 16.0f));
-        model = glm::scale(model, glm::vec3(0.8f, 0.8f, 0.8f));
-        basicShader.setMat4("model", model);
-        basicShader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
-        spruceTreeModel->draw(basicShader);
-    }
-
-    if (oakTreeModel && oakTreeModel->vertexCount() > 0) {
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(26.0f, 0.0f, 4.0f));
-        model = glm::scale(model, glm::vec3(0.85f, 0.85f, 0.85f));
-        basicShader.setMat4("model", model);
-        basicShader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
-        oakTreeModel->draw(basicShader);
-    }
-
-    if (lindenTreeModel && lindenTreeModel->vertexCount() > 0) {
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(22.0f, 0.0f, 20.0f));
-        model = glm::scale(model, glm::vec3(0.78f, 0.78f, 0.78f));
-        basicShader.setMat4("model", model);
-        basicShader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
-        lindenTreeModel->draw(basicShader);
-    }
-
-    if (pineTreeModel && pineTreeModel->vertexCount() > 0) {
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(16.0f, 0.0f, 18.0f));
-        model = glm::scale(model, glm::vec3(0.95f, 0.95f, 0.95f));
-        basicShader.setMat4("model", model);
-        basicShader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
-        pineTreeModel->draw(basicShader);
-    }
-
-    if (oakTreeModel && oakTreeModel->vertexCount() > 0) {
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(14.0f, 0.0f, 24.0f));
-        model = glm::scale(model, glm::vec3(0.88f, 0.88f, 0.88f));
-        basicShader.setMat4("model", model);
-        basicShader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
-        oakTreeModel->draw(basicShader);
-    }
-
-    if (spruceTreeModel && spruceTreeModel->vertexCount() > 0) {
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(16.0f, 0.0f, 32.0f));
-        model = glm::scale(model, glm::vec3(0.9f, 0.9f, 0.9f));
-        basicShader.setMat4("model", model);
-        basicShader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
-        spruceTreeModel->draw(basicShader);
-    }
-
-    if (pineTreeModel && pineTreeModel->vertexCount() > 0) {
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(20.0f, 0.0f, 28.0f));
-        model = glm::scale(model, glm::vec3(0.85f, 0.85f, 0.85f));
-        basicShader.setMat4("model", model);
-        basicShader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
-        pineTreeModel->draw(basicShader);
-    }
-
-    if (lindenTreeModel && lindenTreeModel->vertexCount() > 0) {
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(24.0f, 0.0f, 24.0f));
-        model = glm::scale(model, glm::vec3(0.82f, 0.82f, 0.82f));
-        basicShader.setMat4("model", model);
-        basicShader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
-        lindenTreeModel->draw(basicShader);
-    }
-
-    if (oakTreeModel && oakTreeModel->vertexCount() > 0) {
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(26.0f, 0.0f, 30.0f));
-        model = glm::scale(model, glm::vec3(0.92f, 0.92f, 0.92f));
-        basicShader.setMat4("model", model);
-        basicShader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
-        oakTreeModel->draw(basicShader);
-    }
-
-    if (spruceTreeModel && spruceTreeModel->vertexCount() > 0) {
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(14.0f, 0.0f, 36.0f));
-        model = glm::scale(model, glm::vec3(0.78f, 0.78f, 0.78f));
-        basicShader.setMat4("model", model);
-        basicShader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
-        spruceTreeModel->draw(basicShader);
-    }
-
-    if (pineTreeModel && pineTreeModel->vertexCount() > 0) {
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(22.0f, 0.0f, 34.0f));
-        model = glm::scale(model, glm::vec3(0.88f, 0.88f, 0.88f));
-        basicShader.setMat4("model", model);
-        basicShader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
-        pineTreeModel->draw(basicShader);
-    }
-
-    if (oakTreeModel && oakTreeModel->vertexCount() > 0) {
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(-14.0f, 0.0f, 20.0f));
-        model = glm::scale(model, glm::vec3(0.9f, 0.9f, 0.9f));
-        basicShader.setMat4("model", model);
-        basicShader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
-        oakTreeModel->draw(basicShader);
-    }
-
-    if (spruceTreeModel && spruceTreeModel->vertexCount() > 0) {
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(-18.0f, 0.0f, 16.0f));
-        model = glm::scale(model, glm::vec3(0.85f, 0.85f, 0.85f));
-        basicShader.setMat4("model", model);
-        basicShader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
-        spruceTreeModel->draw(basicShader);
-    }
-
-    if (pineTreeModel && pineTreeModel->vertexCount() > 0) {
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(-20.0f, 0.0f, 24.0f));
-        model = glm::scale(model, glm::vec3(0.92f, 0.92f, 0.92f));
-        basicShader.setMat4("model", model);
-        basicShader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
-        pineTreeModel->draw(basicShader);
-    }
-
-    if (lindenTreeModel && lindenTreeModel->vertexCount() > 0) {
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(-16.0f, 0.0f, 30.0f));
-        model = glm::scale(model, glm::vec3(0.8f, 0.8f, 0.8f));
-        basicShader.setMat4("model", model);
-        basicShader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
-        lindenTreeModel->draw(basicShader);
-    }
-
-    if (oakTreeModel && oakTreeModel->vertexCount() > 0) {
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(-22.0f, 0.0f, 20.0f));
-        model = glm::scale(model, glm::vec3(0.88f, 0.88f, 0.88f));
-        basicShader.setMat4("model", model);
-        basicShader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
-        oakTreeModel->draw(basicShader);
-    }
-
-    if (spruceTreeModel && spruceTreeModel->vertexCount() > 0) {
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(-24.0f, 0.0f, 28.0f));
-        model = glm::scale(model, glm::vec3(0.78f, 0.78f, 0.78f));
-        basicShader.setMat4("model", model);
-        basicShader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
-        spruceTreeModel->draw(basicShader);
-    }
-
-    if (pineTreeModel && pineTreeModel->vertexCount() > 0) {
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(-14.0f, 0.0f, 34.0f));
-        model = glm::scale(model, glm::vec3(0.95f, 0.95f, 0.95f));
-        basicShader.setMat4("model", model);
-        basicShader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
-        pineTreeModel->draw(basicShader);
-    }
-
-    if (lindenTreeModel && lindenTreeModel->vertexCount() > 0) {
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(-26.0f, 0.0f, 14.0f));
-        model = glm::scale(model, glm::vec3(0.82f, 0.82f, 0.82f));
-        basicShader.setMat4("model", model);
-        basicShader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
-        lindenTreeModel->draw(basicShader);
-    }
-
-    //  ANGEL STATUE 
-    if (angelStatueModel && angelStatueModel->vertexCount() > 0) {
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(0.0f, 0.0f, -45.0f));
-        model = glm::scale(model, glm::vec3(0.8f, 0.8f, 0.8f));
-        basicShader.setMat4("model", model);
-        basicShader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
-        angelStatueModel->draw(basicShader);
-    }
-
-    if (lamp12Model && lamp12Model->vertexCount() > 0) {
-        // Lampă stânga statuii - în față
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(-2.0f, 0.0f, -42.0f));
-        model = glm::scale(model, glm::vec3(5.0f, 5.0f, 5.0f));
-        basicShader.setMat4("model", model);
-        basicShader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
-        lamp12Model->draw(basicShader);
-
-        // Lampă dreapta statuii - în față
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(2.0f, 0.0f, -42.0f));
-        model = glm::scale(model, glm::vec3(5.0f, 5.0f, 5.0f));
-        basicShader.setMat4("model", model);
-        basicShader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
-        lamp12Model->draw(basicShader);
+    if (staticBatchingEnabled) {
+        for (size_t b = 0; b < staticBatcher.batches.size(); b++) {
+            if (!cullVisible[staticBatchCullId + b]) continue;
+            const StaticBatch& batch = staticBatcher.batches[b];
+            float depth = glm::length((batch.bounds.min + batch.bounds.max) * 0.5f - eye);
+            for (const StaticBatchRange& range : batch.ranges) {
+                opaqueQueue.addMesh(range.mesh, range.material, glm::mat4(1.0f), depth, false);
+            }
+        }
     }
 
-    //  MOON
-    if (moonModel && moonModel->vertexCount() > 0) {
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(15.0f, 35.0f, -30.0f)); 
-        model = glm::rotate(model, glm::radians(moonRotation), glm::vec3(0.0f, 1.0f, 0.0f)); 
-        model = glm::scale(model, glm::vec3(0.002f, 0.002f, 0.002f)); 
-        basicShader.setMat4("model", model);
-        basicShader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 0.9f)); 
-        moonModel->draw(basicShader);
+    if (moonModel && moonModel->vertexCount() > 0 && cullVisible[moonCullId]) {
+        glm::mat4 model = moonMatrix();
+        opaqueQueue.addModel(moonModel, model, glm::length(glm::vec3(model[3]) - eye));
     }
-    
+
+    opaqueQueue.sort();
+}
+
+// Geometria opacă, doar adâncime. Transformările trebuie să fie exact cele din
+// drawSceneGeometry, altfel testul GL_EQUAL al trecerii de culoare pierde pixeli.
+void renderDepthPrepass(const glm::mat4& view, const glm::mat4& projection) {
+    depthPrepassShader.useShaderProgram();
+    depthPrepassShader.setMat4("projection", projection);
+    depthPrepassShader.setMat4("view", view);
+    GLState::colorMask(GL_FALSE);
+
+    // Aceleași fragmente trec testul LESS ca într-un pas de culoare fără prepass,
+    // deci numărătoarea măsoară overdraw-ul evitat
+    overdrawCounter.begin();
+
+    GLState::disable(GL_CULL_FACE);
+    depthPrepassShader.setMat4("model", glm::mat4(1.0f));
+    GeometryPool::meshes().draw(groundMesh.indexCount, groundMesh.firstIndex, groundMesh.baseVertex);
+    GLState::enable(GL_CULL_FACE);
+
+    if (bunnyTruckModel && bunnyTruckModel->vertexCount() > 0 && cullVisible[truckCullId]) {
+        depthPrepassShader.setMat4("model", bunnyTruckMatrix(0.0f));
+        bunnyTruckModel->drawDepthExcept("Material.003");
+        depthPrepassShader.setMat4("model", bunnyTruckMatrix(sin(cottonCandyRotation * 2.0f) * 0.02f));
+        bunnyTruckModel->drawDepthMaterialGroup("Material.003");
+    }
+
+    if (instancingEnabled) {
+        depthPrepassShader.setBool("useInstancing", true);
+        for (InstanceBatch* batch : colorBatches) {
+            batch->drawDepth();
+        }
+        depthPrepassShader.setBool("useInstancing", false);
+    }
+    else {
+        for (size_t i = 0; i < sceneInstances.size(); i++) {
+            if (!cullVisible[i] || drawnByStaticBatch(sceneInstances[i])) continue;
+            depthPrepassShader.setMat4("model", instanceMatrix(sceneInstances[i]));
+            sceneInstances[i].model->drawDepth();
+        }
+    }
+    if (staticBatchingEnabled && !staticBatcher.empty()) {
+        staticBatcher.drawDepth(depthPrepassShader, &cullVisible[staticBatchCullId]);
+    }
+
+    if (moonModel && moonModel->vertexCount() > 0 && cullVisible[moonCullId]) {
+        depthPrepassShader.setMat4("model", moonMatrix());
+        moonModel->drawDepth();
+    }
+
+    overdrawCounter.end();
+    GLState::colorMask(GL_TRUE);
+    RenderStats::frame().depthPrepassFrames = 1;
+}
+
+// Overdraw = eșantioanele care au trecut testul de adâncime (în prepass, sau în
+// trecerea de culoare când nu există) pe pixel randat. Modul auto folosește
+// prepass-ul doar când munca în plus pe vârfuri e plătită de shadingul economisit.
+void updateDepthPrepassHeuristic() {
+    if (overdrawCounter.hasResult) {
+        float overdraw = (float)overdrawCounter.lastSamples / (float)(dynamicResolution.width * dynamicResolution.height);
+        overdrawEstimate += (overdraw - overdrawEstimate) * 0.1f;
+    }
+    RenderStats::frame().overdraw = overdrawEstimate;
+
+    if (depthPrepassMode != DEPTH_PREPASS_AUTO) {
+        depthPrepassActive = depthPrepassMode == DEPTH_PREPASS_ON;
+        return;
+    }
+    bool wanted = depthPrepassActive ? overdrawEstimate > PREPASS_DISABLE_OVERDRAW
+                                     : overdrawEstimate > PREPASS_ENABLE_OVERDRAW;
+    if (wanted != depthPrepassActive) {
+        depthPrepassActive = wanted;
+        std::cout << "Depth prepass (auto): " << (wanted ? "on" : "off")
+                  << ", overdraw " << overdrawEstimate << std::endl;
+    }
+}
+
+// Trecerea G-buffer (albedo, normală/emisie, adâncime) urmată de o trecere de
+// iluminare pe tot ecranul care luminează fiecare pixel o dată, cu același lighting.glsl
+void renderDeferred(const glm::mat4& view, const glm::mat4& projection) {
+    // Cât ținta scenei; cadrul folosește doar colțul de la rezoluția curentă
+    if (gBuffer.width != dynamicResolution.targetWidth || gBuffer.height != dynamicResolution.targetHeight) {
+        gBuffer.init(dynamicResolution.targetWidth, dynamicResolution.targetHeight);
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, gBuffer.fbo);
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    gBufferShader.useShaderProgram();
+    gBufferShader.setMat4("projection", projection);
+    gBufferShader.setMat4("view", view);
+    applyRenderMode();
+    drawSceneGeometry(gBufferShader);
+    GLState::polygonMode(GL_FILL);
+
+    dynamicResolution.bind();
+    glClearColor(0.1f, 0.1f, 0.15f, 1.0f); // Dark blue evening sky
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    if (skybox) {
+        skybox->draw(view, projection);
+        RenderStats::frame().drawCalls++;
+    }
+
+    deferredLightingShader.useShaderProgram();
+    setLightingUniforms(deferredLightingShader);
+    deferredLightingShader.setMat4("view", view);
+    deferredLightingShader.setMat4("inverseViewProjection", glm::inverse(projection * view));
+    GLState::activeTexture(GL_TEXTURE7);
+    GLState::bindTexture(GL_TEXTURE_2D, gBuffer.albedoTexture);
+    deferredLightingShader.setInt("gAlbedo", 7);
+    GLState::activeTexture(GL_TEXTURE8);
+    GLState::bindTexture(GL_TEXTURE_2D, gBuffer.normalTexture);
+    deferredLightingShader.setInt("gNormal", 8);
+    GLState::activeTexture(GL_TEXTURE9);
+    GLState::bindTexture(GL_TEXTURE_2D, gBuffer.depthTexture);
+    deferredLightingShader.setInt("gDepth", 9);
+    GLState::activeTexture(GL_TEXTURE0);
+
+    // Testul de adâncime rămâne activ (altfel gl_FragDepth nu se scrie)
+    GLState::depthFunc(GL_ALWAYS);
+    GLState::bindVertexArray(fullscreenVAO);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    GLState::bindVertexArray(0);
+    GLState::depthFunc(GL_LESS);
+    RenderStats::frame().drawCalls++;
+}
+
+void renderScene() {
+
+const float nearPlane = 0.1f;
+const float farPlane = 500.0f;
+glm::mat4 projection = glm::perspective(glm::radians(camera.Fov),
+    (float)GL_WINDOW_WIDTH / (float)GL_WINDOW_HEIGHT,
+    nearPlane,
+    farPlane);
+glm::mat4 view = camera.GetViewMatrix();
+
+// Rezoluția de randare a cadrului; desenele folosesc proiecția decalată sub-pixel
+// pentru upscale-ul temporal, culling-ul și ceața volumetrică pe cea a camerei
+dynamicResolution.beginFrame(GL_WINDOW_WIDTH, GL_WINDOW_HEIGHT, projection * view);
+glm::mat4 jitteredProjection = dynamicResolution.jitterProjection(projection);
+
+// Cascadele de umbră (din perspectiva lunii) urmăresc frustumul camerei; cu
+// cache-ul pornit se mută în pași mari, ca straturile statice să rămână valabile
+shadowCascades.guardBand = shadowCacheEnabled ? SHADOW_CACHE_GUARD_BAND : 0.0f;
+shadowCascades.update(view, glm::radians(camera.Fov), (float)GL_WINDOW_WIDTH / (float)GL_WINDOW_HEIGHT,
+    0.1f, moonLightTarget - moonLightPosition);
+
+cullScene(projection * view);
+
+if (shadowCacheEnabled) {
+    int rebuilt = 0;
+    shadowRebuildTimer.begin();
+    for (int c = 0; c < shadowCascades.count; c++) {
+        if (staticShadowDirty || shadowCascades.cascades[c].lightSpaceMatrix != cachedCascadeMatrices[c]) {
+            rebuildStaticShadowLayer(c);
+            rebuilt++;
+        }
+    }
+    shadowRebuildTimer.end();
+    staticShadowDirty = false;
+    RenderStats::frame().shadowLayersRebuilt = rebuilt;
+    RenderStats::frame().shadowRebuildGpuMs = shadowRebuildTimer.lastMs;
+}
+updateInstanceBatches();
+buildOpaqueQueue(camera.Position);
+
+// Randarea în shadow map, câte un strat pe cascadă
+shadowShader.useShaderProgram();
+int shadowSize = shadowCascades.resolution;
+glViewport(0, 0, shadowSize, shadowSize);
+shadowPassTimer.begin();
+GLState::cullFace(GL_FRONT);
+GLState::enable(GL_DEPTH_CLAMP);
+for (int c = 0; c < shadowCascades.count; c++) {
+    shadowShader.setMat4("lightSpaceMatrix", shadowCascades.cascades[c].lightSpaceMatrix);
+    glBindFramebuffer(GL_FRAMEBUFFER, shadowMapFBO);
+    glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, shadowMapTexture, 0, c);
+    if (shadowCacheEnabled) {
+        // Copiază stratul static, apoi desenează doar obiectele animate peste el
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, staticShadowFBO);
+        glFramebufferTextureLayer(GL_READ_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, staticShadowTexture, 0, c);
+        glBlitFramebuffer(0, 0, shadowSize, shadowSize, 0, 0, shadowSize, shadowSize,
+            GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+        glBindFramebuffer(GL_FRAMEBUFFER, shadowMapFBO);
+    }
+    else {
+        glClear(GL_DEPTH_BUFFER_BIT);
+    }
+    renderSceneDepth(shadowShader, shadowCacheEnabled ? CASTERS_DYNAMIC : CASTERS_ALL, c);
+}
+GLState::disable(GL_DEPTH_CLAMP);
+GLState::cullFace(GL_BACK);
+shadowPassTimer.end();
+RenderStats::frame().shadowGpuMs = shadowPassTimer.lastMs;
+glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+if (shadowFilterMode == SHADOW_FILTER_ESM) {
+    shadowFilterTimer.begin();
+    esmShadowFilter.filter(shadowMapTexture, shadowCascades.count);
+    shadowFilterTimer.end();
+    RenderStats::frame().shadowFilterGpuMs = shadowFilterTimer.lastMs;
+}
+
+dynamicResolution.bind();
+colorPassTimer.begin();
+
+// Luminile punctuale (lampa 1 pâlpâie) sunt împărțite pe clustere o singură dată, pentru ambele căi
+double lightStart = glfwGetTime();
+float flicker = 0.7f + 0.3f * sin(lampFlickerTime) * sin(lampFlickerTime * 3.7f);
+pointLights[0].color = glm::vec3(1.0f, 0.8f, 0.4f) * flicker * 4.0f;
+lightClusters.update(pointLights, view, glm::radians(camera.Fov), (float)GL_WINDOW_WIDTH / (float)GL_WINDOW_HEIGHT);
+RenderStats::frame().pointLights = (int)pointLights.size();
+RenderStats::frame().clusterLightRefs = lightClusters.indexCount;
+RenderStats::frame().lightBinMs = (glfwGetTime() - lightStart) * 1000.0;
+
+if (deferredShadingEnabled) {
+    renderDeferred(view, jitteredProjection);
+}
+else {
+    renderForward(view, jitteredProjection);
+}
+
+    // Adâncimea scenei, pentru ceață și particulele low-res: pe calea deferred e
+    // deja o textură, pe calea forward se copiază o singură dată din fereastră
+    // (sau din ținta scenei, care rămâne legată cât timp se desenează peste ea)
+    bool particlePass = rainEnabled || particlesEnabled;
+    bool lowRes = particlePass && lowResParticles.active();
+    GLuint sceneDepth = 0;
+    if (fogEnabled || lowRes) {
+        sceneDepth = deferredShadingEnabled ? gBuffer.depthTexture
+            : windowDepth.copy(dynamicResolution.framebuffer(), dynamicResolution.width, dynamicResolution.height,
+                dynamicResolution.targetWidth, dynamicResolution.targetHeight);
+    }
+
+    // Ceața: o singură trecere pe ecran, inclusiv peste cer
+    if (fogEnabled && !volumetricFogEnabled) {
+        fogPass.apply(sceneDepth, glm::inverse(jitteredProjection * view), camera.Position, heightFogEnabled);
+    }
+
+    colorPassTimer.end();
+    RenderStats::frame().colorGpuMs = colorPassTimer.lastMs;
+
+    // Ceața volumetrică: volumul de froxeli (cu istoricul reproiectat), apoi o
+    // citire 3D pe pixel; măsurată separat de trecerea de culoare
+    if (fogEnabled && volumetricFogEnabled) {
+        fogVolumeTimer.begin();
+        setLightingUniforms(volumetricFog.beginScatter());
+        volumetricFog.update(view, projection, glm::radians(camera.Fov), (float)GL_WINDOW_WIDTH / (float)GL_WINDOW_HEIGHT,
+            heightFogEnabled);
+        dynamicResolution.bind();
+        volumetricFog.apply(sceneDepth, dynamicResolution.width, dynamicResolution.height, nearPlane, farPlane);
+        fogVolumeTimer.end();
+        RenderStats::frame().fogVolumeGpuMs = fogVolumeTimer.lastMs;
+    }
+    else {
+        volumetricFog.invalidateHistory();
+    }
+
+    // Ploaia și particulele, direct în fereastră sau în ținta low-res compusă
+    // apoi cu upsample bilateral. Alpha ține transmitanța pentru compunere.
+    if (!particlePass) return;
+    particlePassTimer.begin();
+    if (lowRes) {
+        lowResParticles.begin(sceneDepth, dynamicResolution.width, dynamicResolution.height,
+            dynamicResolution.targetWidth, dynamicResolution.targetHeight);
+    }
+
     // RAIN
     if (rainEnabled) {
-        glEnable(GL_BLEND);
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-        glEnable(GL_PROGRAM_POINT_SIZE);
-        renderRain(view, projection);
-        glDisable(GL_BLEND);
+        GLState::enable(GL_BLEND);
+        GLState::blendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ZERO, GL_ONE_MINUS_SRC_ALPHA);
+        GLState::enable(GL_PROGRAM_POINT_SIZE);
+        renderRain(view, jitteredProjection);
+        GLState::disable(GL_BLEND);
+    }
+
+    // Particule: după opace, fără scriere în depth
+    if (particlesEnabled) {
+        particleRenderer.draw(particleSystems, view, jitteredProjection, camera.Position);
+    }
+
+    if (lowRes) {
+        lowResParticles.end(dynamicResolution.framebuffer(), nearPlane, farPlane);
     }
+    particlePassTimer.end();
+    RenderStats::frame().particleGpuMs = particlePassTimer.lastMs;
+}
+
+// Upscale-ul temporal al țintei scenei în fereastră, apoi scara cadrului următor
+// din timpul GPU al trecerilor acestui cadru
+void presentScene() {
+    RenderStats& stats = RenderStats::frame();
+    stats.renderScale = dynamicResolution.activeScale();
+    if (!dynamicResolution.enabled) return;
+
+    upscaleTimer.begin();
+    dynamicResolution.resolve();
+    upscaleTimer.end();
+    stats.upscaleGpuMs = upscaleTimer.lastMs;
+    dynamicResolution.update(stats.shadowRebuildGpuMs + stats.shadowGpuMs + stats.shadowFilterGpuMs + stats.colorGpuMs +
+        stats.fogVolumeGpuMs + stats.particleGpuMs + stats.upscaleGpuMs);
 }
 
 void cleanup() {
@@ -1029,16 +967,53 @@ delete bunnyTruckModel;
 delete moonModel;
 delete skybox;
 
-glDeleteVertexArrays(1, &groundVAO);
-    glDeleteBuffers(1, &groundVBO);
-    glDeleteBuffers(1, &groundEBO);
-    glDeleteTextures(1, &pavementTexture);
+for (size_t i = 0; i < colorBatches.size(); i++) {
+    delete colorBatches[i];
+    for (int c = 0; c < ShadowCascades::MAX_CASCADES; c++) {
+        delete shadowBatches[c][i];
+    }
+}
+
+staticBatcher.release();
+    opaqueQueue.release();
+    GeometryPool::meshes().release();
+    GeometryPool::positions().release();
+    GLState::deleteTextures(1, &pavementTexture);
     
     glDeleteFramebuffers(1, &shadowMapFBO);
-    glDeleteTextures(1, &shadowMapTexture);
-    
-    glDeleteVertexArrays(1, &rainVAO);
-    glDeleteBuffers(1, &rainVBO);
+    GLState::deleteTextures(1, &shadowMapTexture);
+    glDeleteFramebuffers(1, &staticShadowFBO);
+    GLState::deleteTextures(1, &staticShadowTexture);
+    
+    GLState::deleteSamplers(1, &shadowSamplerRaw);
+    GLState::deleteSamplers(1, &shadowSamplerCompare);
+    esmShadowFilter.release();
+    lightClusters.release();
+    gBuffer.release();
+    GLState::deleteVertexArrays(1, &fullscreenVAO);
+    
+    GLState::deleteVertexArrays(1, &rainVAO);
+    GLState::deleteBuffers(1, &rainVBO);
+    gpuRain.release();
+    rainOcclusion.release();
+    particleRenderer.release();
+    lowResParticles.release();
+    windowDepth.release();
+    fogPass.release();
+    volumetricFog.release();
+    dynamicResolution.release();
+    for (ParticleSystem* system : particleSystems) delete system;
+    particleSystems.clear();
+    StreamBuffer::get().release();
+
+    shadowPassTimer.release();
+    shadowRebuildTimer.release();
+    shadowFilterTimer.release();
+    colorPassTimer.release();
+    particlePassTimer.release();
+    fogVolumeTimer.release();
+    upscaleTimer.release();
+    overdrawCounter.release();
 
     glfwDestroyWindow(glWindow);
     glfwTerminate();
@@ -1048,200 +1023,721 @@ void createGround() {
 float groundSize = 50.0f; 
 float texRepeat = 10.0f;  
 
-float groundVertices[] = {
+std::vector<float> groundVertices = {
     -groundSize, 0.0f, -groundSize,  0.0f, 1.0f, 0.0f,  0.0f, 0.0f,          1.0f, 1.0f, 1.0f,
      groundSize, 0.0f, -groundSize,  0.0f, 1.0f, 0.0f,  texRepeat, 0.0f,     1.0f, 1.0f, 1.0f,
      groundSize, 0.0f,  groundSize,  0.0f, 1.0f, 0.0f,  texRepeat, texRepeat, 1.0f, 1.0f, 1.0f,
     -groundSize, 0.0f,  groundSize,  0.0f, 1.0f, 0.0f,  0.0f, texRepeat,     1.0f, 1.0f, 1.0f
 };
 
-    unsigned int groundIndices[] = {
+    std::vector<unsigned int> groundIndices = {
         0, 1, 2,
         2, 3, 0
     };
 
-    glGenVertexArrays(1, &groundVAO);
-    glGenBuffers(1, &groundVBO);
-    glGenBuffers(1, &groundEBO);
-
-    glBindVertexArray(groundVAO);
-
-    glBindBuffer(GL_ARRAY_BUFFER, groundVBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(groundVertices), groundVertices, GL_STATIC_DRAW);
-
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, groundEBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(groundIndices), groundIndices, GL_STATIC_DRAW);
-
-    // Position attribute
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 11 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-
-    // Normal attribute
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 11 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-
-    // Texture coord attribute
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 11 * sizeof(float), (void*)(6 * sizeof(float)));
-    glEnableVertexAttribArray(2);
+    // Același format (poziție, normală, uv, culoare) ca modelele, deci solul
+    // stă în același buffer comun și se desenează fără schimbare de VAO
+    groundMesh = GeometryPool::meshes().allocate(groundVertices, groundIndices);
+}
 
-    // Color attribute
-    glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, 11 * sizeof(float), (void*)(8 * sizeof(float)));
-    glEnableVertexAttribArray(3);
+// RAIN PARTICLE SYSTEM
+RainVolume currentRainVolume() {
+    if (!rainFollowsCamera) return RainVolume::world();
+    return RainVolume::around(camera.Position.x, camera.Position.y, camera.Position.z, rainBoxWidth, rainBoxHeight);
+}
 
-    glBindVertexArray(0);
+// Atributele x / y / z citesc cele trei blocuri care încep la offset în buffer
+// (VAO-ul de ploaie trebuie să fie legat)
+void pointRainAttributes(GLuint buffer, size_t offset) {
+    GLState::bindBuffer(GL_ARRAY_BUFFER, buffer);
+    for (int c = 0; c < 3; c++) {
+        size_t block = offset + (size_t)c * cpuRain.capacity * sizeof(float);
+        glVertexAttribPointer(c, 1, GL_FLOAT, GL_FALSE, sizeof(float), (void*)block);
+    }
 }
 
-// RAIN PARTICLE SYSTEM
 void initRainSystem() {
-    rainParticles.resize(MAX_RAIN_PARTICLES);
-    
-    // Inițializează particulele de ploaie
-    for (int i = 0; i < MAX_RAIN_PARTICLES; i++) {
-        rainParticles[i].position = glm::vec3(
-            (rand() % 100 - 50),           
-            5.0f + (rand() % 45),          
-            (rand() % 100 - 50)           
-        );
-        rainParticles[i].speed = 25.0f + (rand() % 15);
+    // Inițializează particulele de ploaie (SoA: blocuri x / y / z / viteză)
+    RainVolume volume = currentRainVolume();
+    if (rainParticleCount < 0) {
+        rainParticleCount = (int)(rainDensity * volume.cubicMeters() + 0.5f);
     }
+    cpuRain.init(rainParticleCount, volume);
     
-    // Creează VAO/VBO pentru ploaie
+    // Creează VAO/VBO pentru ploaie; fiecare coordonată e un atribut separat
+    // care citește din blocul ei, deci pozițiile se încarcă fără copiere
     glGenVertexArrays(1, &rainVAO);
     glGenBuffers(1, &rainVBO);
     
-    glBindVertexArray(rainVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, rainVBO);
-    glBufferData(GL_ARRAY_BUFFER, MAX_RAIN_PARTICLES * sizeof(glm::vec3), nullptr, GL_DYNAMIC_DRAW);
+    GLState::bindVertexArray(rainVAO);
+    GLState::bindBuffer(GL_ARRAY_BUFFER, rainVBO);
+    rainVBOCapacity = cpuRain.positionBytes();
+    glBufferData(GL_ARRAY_BUFFER, rainVBOCapacity, nullptr, GL_STREAM_DRAW);
     
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)0);
-    glEnableVertexAttribArray(0);
+    for (int c = 0; c < 3; c++) {
+        glEnableVertexAttribArray(c);
+    }
+    pointRainAttributes(rainVBO, 0);
     
-    glBindVertexArray(0);
+    GLState::bindVertexArray(0);
     
-    std::cout << "Rain system initialized with " << MAX_RAIN_PARTICLES << " particles" << std::endl;
+    std::cout << "Rain system initialized with " << rainParticleCount << " particles ("
+              << RainSimulation::LANES << "-wide SIMD update) in a " << volume.sizeX << " x " << volume.sizeY
+              << " x " << volume.sizeZ << " m box " << (rainFollowsCamera ? "around the camera" : "over the park")
+              << ", " << rainParticleCount / volume.cubicMeters() << " drops/m^3" << std::endl;
+
+    // Aceleași picături simulate pe GPU (pornesc cu poziții aleatoare generate în shader)
+    gpuRain.init(rainParticleCount);
+}
+
+// Randează o singură dată, de sus, obiectele statice (camion, bănci, felinare,
+// copaci, statuie) în harta de ocluzie a ploii; luna nu intră
+void buildRainOcclusion() {
+    bool first = true;
+    AABB bounds;
+    for (int id = 0; id < (int)cullBounds.size(); id++) {
+        if (id == moonCullId || (id >= staticBatchCullId && staticBatchCullId >= 0)) continue;
+        if (first) bounds = cullBounds[id];
+        bounds.min = glm::min(bounds.min, cullBounds[id].min);
+        bounds.max = glm::max(bounds.max, cullBounds[id].max);
+        first = false;
+    }
+    if (first) return;
+
+    glm::mat4 topDown = rainOcclusion.begin(bounds);
+    shadowShader.useShaderProgram();
+    shadowShader.setMat4("lightSpaceMatrix", topDown);
+    shadowShader.setBool("useInstancing", false);
+    GLState::disable(GL_CULL_FACE);
+
+    if (bunnyTruckModel && bunnyTruckModel->vertexCount() > 0) {
+        shadowShader.setMat4("model", bunnyTruckMatrix(0.0f));
+        bunnyTruckModel->drawDepth();
+    }
+    for (size_t i = 0; i < sceneInstances.size(); i++) {
+        shadowShader.setMat4("model", instanceMatrix(sceneInstances[i]));
+        sceneInstances[i].model->drawDepth();
+    }
+
+    GLState::enable(GL_CULL_FACE);
+    rainOcclusion.end();
+    glViewport(0, 0, GL_WINDOW_WIDTH, GL_WINDOW_HEIGHT);
+}
+
+// Molii roiesc în jurul fiecărei lumini punctuale; frunzele cad din partea de sus
+// a coroanei fiecărui stejar și tei (cutia de culling a copacului)
+void initParticleSystems() {
+    ParticleEmitterDef moths;
+    moths.name = "moths";
+    moths.capacity = 48;
+    moths.spawnRate = 12.0f;
+    moths.lifeMin = 3.0f;
+    moths.lifeMax = 6.0f;
+    moths.spawnExtent = glm::vec3(0.6f);
+    moths.velocityMin = glm::vec3(-0.8f);
+    moths.velocityMax = glm::vec3(0.8f);
+    moths.drag = 0.8f;
+    moths.attraction = 1.5f;
+    moths.jitter = 60.0f;
+    moths.size = 0.06f;
+    moths.colorStart = glm::vec4(1.0f, 0.85f, 0.55f, 0.9f);
+    moths.colorEnd = glm::vec4(1.0f, 0.7f, 0.4f, 0.0f);
+    moths.additive = true;
+    mothParticles = new ParticleSystem(moths);
+    for (const PointLight& light : pointLights) {
+        mothParticles->addEmitter(light.position);
+    }
+
+    ParticleEmitterDef leaves;
+    leaves.name = "leaves";
+    leaves.capacity = 40;
+    leaves.spawnRate = 3.0f;
+    leaves.lifeMin = 6.0f;
+    leaves.lifeMax = 10.0f;
+    leaves.velocityMin = glm::vec3(-0.4f, -0.6f, -0.4f);
+    leaves.velocityMax = glm::vec3(0.4f, -0.2f, 0.4f);
+    leaves.gravity = glm::vec3(0.0f, -0.6f, 0.0f);
+    leaves.drag = 0.9f;
+    leaves.jitter = 4.0f;
+    leaves.killBelow = 0.0f;
+    leaves.size = 0.12f;
+    leaves.colorStart = glm::vec4(0.55f, 0.45f, 0.15f, 1.0f);
+    leaves.colorEnd = glm::vec4(0.45f, 0.25f, 0.08f, 0.6f);
+    leaves.sortBackToFront = true;
+    leafParticles = new ParticleSystem(leaves);
+    for (size_t i = 0; i < sceneInstances.size(); i++) {
+        Model* model = sceneInstances[i].model;
+        if (model != oakTreeModel && model != lindenTreeModel) continue;
+        const AABB& tree = cullBounds[i];
+        glm::vec3 half = (tree.max - tree.min) * 0.5f;
+        // Doar sfertul de sus al coroanei
+        leafParticles->addEmitter(glm::vec3(tree.min.x + half.x, tree.max.y - half.y * 0.35f, tree.min.z + half.z),
+            glm::vec3(half.x * 0.7f, half.y * 0.25f, half.z * 0.7f));
+    }
+
+    particleSystems.clear();
+    particleSystems.push_back(mothParticles);
+    particleSystems.push_back(leafParticles);
+    particleRenderer.init();
+    lowResParticles.init();
+    fogPass.init();
+    volumetricFog.init();
+    dynamicResolution.init();
+
+    for (ParticleSystem* system : particleSystems) {
+        std::cout << "Particle system '" << system->def.name << "': " << system->emitters.size() << " emitters x "
+                  << system->def.capacity << " particles (" << (system->def.additive ? "additive" : "alpha blended")
+                  << (system->def.sortBackToFront ? ", sorted back to front" : "") << ")" << std::endl;
+    }
 }
 
 void updateRainParticles(float deltaTime) {
+    double start = glfwGetTime();
     float windOffset = sin(windTime) * windStrength * 0.5f; 
-    
-    for (int i = 0; i < MAX_RAIN_PARTICLES; i++) {
-        rainParticles[i].position.y -= rainParticles[i].speed * deltaTime;
-        rainParticles[i].position.x += windOffset * deltaTime;
-        rainParticles[i].position.z += windOffset * 0.2f * deltaTime;
-        
-        if (rainParticles[i].position.y < 0.0f) {
-            rainParticles[i].position.y = 45.0f + (rand() % 10);
-            rainParticles[i].position.x = (rand() % 100 - 50);
-            rainParticles[i].position.z = (rand() % 100 - 50);
-            rainParticles[i].speed = 25.0f + (rand() % 15);
-        }
+
+    if (gpuRainEnabled) {
+        RainOcclusion* occlusion = rainOcclusionEnabled && rainOcclusion.ready() ? &rainOcclusion : nullptr;
+        gpuRain.update(deltaTime, glm::vec2(windOffset, windOffset * 0.2f), currentRainVolume(), occlusion);
     }
+    else {
+        RainHeightField field;
+        if (rainOcclusionEnabled && rainOcclusion.ready()) field = rainOcclusion.heightField();
+        cpuRain.update(deltaTime, windOffset, windOffset * 0.2f, currentRainVolume(), field);
+    }
+
+    RenderStats& stats = RenderStats::frame();
+    stats.rainParticles = rainParticleCount;
+    stats.rainCpuMs = (glfwGetTime() - start) * 1000.0;
 }
 
 void renderRain(glm::mat4 view, glm::mat4 projection) {
     if (!rainEnabled) return;
     
-    // Pregătește datele pentru GPU
-    std::vector<glm::vec3> positions(MAX_RAIN_PARTICLES);
-    for (int i = 0; i < MAX_RAIN_PARTICLES; i++) {
-        positions[i] = rainParticles[i].position;
-    }
-    
-    // Actualizează buffer-ul
-    glBindBuffer(GL_ARRAY_BUFFER, rainVBO);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, positions.size() * sizeof(glm::vec3), positions.data());
-    
-    // Randează ploaia
     rainShader.useShaderProgram();
     rainShader.setMat4("projection", projection);
     rainShader.setMat4("view", view);
+    // Picăturile au aceeași mărime pe ecran în ținta low-res și la orice rezoluție dinamică
+    float pixelScale = lowResParticles.active() ? (float)lowResParticles.scale : 1.0f;
+    rainShader.setFloat("pixelScale", pixelScale / dynamicResolution.activeScale());
+
+    if (gpuRainEnabled) {
+        gpuRain.draw();
+        return;
+    }
+
+    // Încarcă blocurile x / y / z în regiunea cadrului din stream buffer
+    // (sau în rainVBO, orfanizat, când inelul e oprit)
+    double start = glfwGetTime();
+    GLState::bindVertexArray(rainVAO);
+    StreamAllocation positions;
+    if (StreamBuffer::get().enabled) {
+        positions = StreamBuffer::get().upload(cpuRain.positions(), cpuRain.positionBytes());
+    }
+    if (positions.valid()) {
+        pointRainAttributes(positions.buffer, positions.offset);
+    }
+    else {
+        StreamBuffer::orphanUpload(GL_ARRAY_BUFFER, rainVBO, rainVBOCapacity, cpuRain.positions(), cpuRain.positionBytes());
+        pointRainAttributes(rainVBO, 0);
+    }
+    RenderStats::frame().rainUploadBytes = cpuRain.positionBytes();
+    RenderStats::frame().rainCpuMs += (glfwGetTime() - start) * 1000.0;
     
-    glBindVertexArray(rainVAO);
-    glDrawArrays(GL_POINTS, 0, MAX_RAIN_PARTICLES);
-    glBindVertexArray(0);
+    // Randează ploaia
+    glDrawArrays(GL_POINTS, 0, rainParticleCount);
+    GLState::bindVertexArray(0);
+    RenderStats::frame().drawCalls++;
 }
 
-void renderSceneDepth(Shader& shader) {
+void renderSceneDepth(Shader& shader, ShadowCasterSet casters, int cascade) {
 glm::mat4 model;
     
-glDisable(GL_CULL_FACE);
+if (casters != CASTERS_DYNAMIC) {
+GLState::disable(GL_CULL_FACE);
 model = glm::mat4(1.0f);
 shader.setMat4("model", model);
-glBindVertexArray(groundVAO);
-glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-glBindVertexArray(0);
-glEnable(GL_CULL_FACE);
+GeometryPool::meshes().draw(groundMesh.indexCount, groundMesh.firstIndex, groundMesh.baseVertex);
+GLState::enable(GL_CULL_FACE);
+}
     
-    // Bunny Truck
-    if (bunnyTruckModel && bunnyTruckModel->vertexCount() > 0) {
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(8.0f, 0.0f, 28.0f));
-        model = glm::rotate(model, glm::radians(-90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-        model = glm::scale(model, glm::vec3(2.5f, 2.5f, 2.5f));
-        shader.setMat4("model", model);
-        bunnyTruckModel->draw(shader);
-    }
-    
-    // Benches
-    if (benchModel && benchModel->vertexCount() > 0) {
-        glm::vec3 benchPositions[] = {
-            glm::vec3(-8.0f, 0.0f, -30.0f), glm::vec3(-8.0f, 0.0f, -10.0f),
-            glm::vec3(8.0f, 0.0f, -30.0f), glm::vec3(8.0f, 0.0f, -10.0f),
-            glm::vec3(-8.0f, 0.0f, 10.0f), glm::vec3(8.0f, 0.0f, 10.0f)
-        };
-        float benchRotations[] = { 90.0f, 90.0f, -90.0f, -90.0f, 90.0f, -90.0f };
-        for (int i = 0; i < 6; i++) {
-            model = glm::mat4(1.0f);
-            model = glm::translate(model, benchPositions[i]);
-            model = glm::rotate(model, glm::radians(benchRotations[i]), glm::vec3(0.0f, 1.0f, 0.0f));
-            model = glm::scale(model, glm::vec3(0.8f, 0.8f, 0.8f));
+    // Bunny Truck (caroseria e statică, bunny-ul se leagănă)
+    if (bunnyTruckModel && bunnyTruckModel->vertexCount() > 0 &&
+        (casters == CASTERS_STATIC || shadowVisible[cascade][truckCullId])) {
+        if (casters == CASTERS_ALL) {
+            model = bunnyTruckMatrix(0.0f);
+            shader.setMat4("model", model);
+            if (depthOnlyShadowsEnabled) {
+                bunnyTruckModel->drawDepth();
+            }
+            else {
+                bunnyTruckModel->draw(shader);
+            }
+        }
+        else if (casters == CASTERS_STATIC) {
+            model = bunnyTruckMatrix(0.0f);
             shader.setMat4("model", model);
-            benchModel->draw(shader);
-        }
-    }
-    
-    // Street Lamps
-    if (lampModel && lampModel->vertexCount() > 0) {
-        glm::vec3 lampPositions[] = {
-            glm::vec3(-8.0f, 0.0f, -20.0f), glm::vec3(8.0f, 0.0f, -20.0f),
-            glm::vec3(-8.0f, 0.0f, 0.0f), glm::vec3(8.0f, 0.0f, 0.0f),
-            glm::vec3(8.0f, 0.0f, 20.0f)
-        };
-        float lampRotations[] = { 180.0f, 0.0f, 180.0f, 0.0f, 0.0f };
-        for (int i = 0; i < 5; i++) {
-            model = glm::mat4(1.0f);
-            model = glm::translate(model, lampPositions[i]);
-            model = glm::rotate(model, glm::radians(lampRotations[i]), glm::vec3(0.0f, 1.0f, 0.0f));
-            model = glm::scale(model, glm::vec3(0.3f, 0.3f, 0.3f));
+            if (depthOnlyShadowsEnabled) {
+                bunnyTruckModel->drawDepthExcept("Material.003");
+            }
+            else {
+                bunnyTruckModel->drawExcept(shader, "Material.003");
+            }
+        }
+        else {
+            model = bunnyTruckMatrix(sin(cottonCandyRotation * 2.0f) * 0.02f);
             shader.setMat4("model", model);
-            lampModel->draw(shader);
+            if (depthOnlyShadowsEnabled) {
+                bunnyTruckModel->drawDepthMaterialGroup("Material.003");
+            }
+            else {
+                bunnyTruckModel->drawMaterialGroup(shader, "Material.003");
+            }
         }
     }
     
-    // Angel Statue
-    if (angelStatueModel && angelStatueModel->vertexCount() > 0) {
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(0.0f, 0.0f, -45.0f));
-        model = glm::scale(model, glm::vec3(0.8f, 0.8f, 0.8f));
-        shader.setMat4("model", model);
-        angelStatueModel->draw(shader);
+    // Bănci, lămpi stradale, copaci, statuia îngerului, lamp12
+    drawSceneInstances(shader, true, casters, cascade);
+
+    // Bucket-urile statice: în stratul static se testează doar volumul luminii
+    if (staticBatchingEnabled && !staticBatcher.empty() && casters != CASTERS_DYNAMIC) {
+        if (casters == CASTERS_STATIC) {
+            Frustum lightFrustum = Frustum::fromMatrix(shadowCascades.cascades[cascade].lightSpaceMatrix);
+            lightFrustum.planes[4] = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+            std::vector<unsigned char> inLight(staticBatcher.batches.size());
+            for (size_t b = 0; b < inLight.size(); b++) {
+                inLight[b] = lightFrustum.intersects(staticBatcher.batches[b].bounds);
+            }
+            staticBatcher.drawDepth(shader, inLight.data());
+        }
+        else {
+            staticBatcher.drawDepth(shader, &shadowVisible[cascade][staticBatchCullId]);
+        }
     }
-    
-    // Lamp12
-    if (lamp12Model && lamp12Model->vertexCount() > 0) {
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(-2.0f, 0.0f, -42.0f));
-        model = glm::scale(model, glm::vec3(5.0f, 5.0f, 5.0f));
-        shader.setMat4("model", model);
-        lamp12Model->draw(shader);
-        
-        model = glm::mat4(1.0f);
-                model = glm::translate(model, glm::vec3(2.0f, 0.0f, -42.0f));
-                model = glm::scale(model, glm::vec3(5.0f, 5.0f, 5.0f));
-                shader.setMat4("model", model);
-                lamp12Model->draw(shader);
+}
+
+glm::mat4 instanceMatrix(const SceneInstance& instance) {
+    glm::mat4 model = glm::mat4(1.0f);
+    model = glm::translate(model, instance.position);
+    if (instance.swayAmplitude != 0.0f) {
+        float sway = sin(treeSwayTime + instance.swayPhase) * instance.swayAmplitude;
+        model = glm::rotate(model, glm::radians(sway), glm::vec3(0.0f, 0.0f, 1.0f));
+    }
+    if (instance.rotationY != 0.0f) {
+        model = glm::rotate(model, glm::radians(instance.rotationY), glm::vec3(0.0f, 1.0f, 0.0f));
+    }
+    model = glm::scale(model, glm::vec3(instance.scale));
+    return model;
+}
+
+void addSceneInstance(Model* model, glm::vec3 position, float rotationY, float scale,
+    float swayPhase = 0.0f, float swayAmplitude = 0.0f) {
+    if (!model || model->vertexCount() == 0) return;
+
+    SceneInstance instance;
+    instance.model = model;
+    instance.position = position;
+    instance.rotationY = rotationY;
+    instance.scale = scale;
+    instance.swayPhase = swayPhase;
+    instance.swayAmplitude = swayAmplitude;
+    instance.batchIndex = -1;
+    instance.staticBatched = false;
+
+    for (size_t i = 0; i < colorBatches.size(); i++) {
+        if (colorBatches[i]->model == model) {
+            instance.batchIndex = (int)i;
+            break;
+        }
+    }
+    if (instance.batchIndex < 0) {
+        colorBatches.push_back(new InstanceBatch());
+        colorBatches.back()->init(model);
+        for (int c = 0; c < ShadowCascades::MAX_CASCADES; c++) {
+            shadowBatches[c].push_back(new InstanceBatch());
+            shadowBatches[c].back()->init(model);
+        }
+        instance.batchIndex = (int)colorBatches.size() - 1;
+    }
+
+    sceneInstances.push_back(instance);
+}
+
+void addPointLight(glm::vec3 position, glm::vec3 color, float radius) {
+    PointLight light;
+    light.position = position;
+    light.color = color;
+    light.radius = radius;
+    pointLights.push_back(light);
+}
+
+// Raza e distanța de la care lumina nu mai contează (atenuarea e tăiată lin acolo)
+void initPointLights() {
+    float lampHeight = 2.5f;
+    addPointLight(glm::vec3(-8.0f, lampHeight, -20.0f), glm::vec3(1.0f, 0.8f, 0.4f) * 4.0f, 25.0f);  // Lampă 1 - pâlpâie, galben cald
+    addPointLight(glm::vec3(8.0f, lampHeight, -20.0f), glm::vec3(1.0f, 0.85f, 0.5f) * 4.0f, 25.0f);  // Lampă 2 - galben cald
+    addPointLight(glm::vec3(-8.0f, lampHeight, 0.0f), glm::vec3(1.0f, 0.85f, 0.5f) * 4.0f, 25.0f);   // Lampă 3
+    addPointLight(glm::vec3(8.0f, lampHeight, 0.0f), glm::vec3(1.0f, 0.85f, 0.5f) * 4.0f, 25.0f);    // Lampă 4
+    addPointLight(glm::vec3(8.0f, lampHeight, 20.0f), glm::vec3(1.0f, 0.85f, 0.5f) * 4.0f, 25.0f);   // Lampă lângă Bunny Truck
+    addPointLight(glm::vec3(-2.0f, 2.5f, -42.0f), glm::vec3(1.0f, 0.7f, 0.3f) * 3.0f, 20.0f);        // Lamp12 stânga statuie
+    addPointLight(glm::vec3(2.0f, 2.5f, -42.0f), glm::vec3(1.0f, 0.7f, 0.3f) * 3.0f, 20.0f);         // Lamp12 dreapta statuie
+    addPointLight(glm::vec3(15.0f, 35.0f, -30.0f), glm::vec3(0.7f, 0.8f, 1.0f) * 4.0f, 120.0f);      // Luna - lumină albăstruie
+}
+
+void initSceneInstances() {
+    // Lampă lângă Bunny Truck
+    addSceneInstance(lampModel, glm::vec3(8.0f, 0.0f, 20.0f), 0.0f, 0.3f);
+
+    // BENCHES
+    addSceneInstance(benchModel, glm::vec3(-8.0f, 0.0f, -30.0f), 90.0f, 0.8f);
+    addSceneInstance(benchModel, glm::vec3(-8.0f, 0.0f, -10.0f), 90.0f, 0.8f);
+    addSceneInstance(benchModel, glm::vec3(8.0f, 0.0f, -30.0f), -90.0f, 0.8f);
+    addSceneInstance(benchModel, glm::vec3(8.0f, 0.0f, -10.0f), -90.0f, 0.8f);
+    addSceneInstance(benchModel, glm::vec3(-8.0f, 0.0f, 10.0f), 90.0f, 0.8f);
+    addSceneInstance(benchModel, glm::vec3(8.0f, 0.0f, 10.0f), -90.0f, 0.8f);
+
+    // STREET LAMPS
+    addSceneInstance(lampModel, glm::vec3(-8.0f, 0.0f, -20.0f), 180.0f, 0.3f);
+    addSceneInstance(lampModel, glm::vec3(8.0f, 0.0f, -20.0f), 0.0f, 0.3f);
+    addSceneInstance(lampModel, glm::vec3(-8.0f, 0.0f, 0.0f), 180.0f, 0.3f);
+    addSceneInstance(lampModel, glm::vec3(8.0f, 0.0f, 0.0f), 0.0f, 0.3f);
+
+    // TREES (în spatele băncilor) - primii 7 se leagănă în vânt
+    addSceneInstance(spruceTreeModel, glm::vec3(-14.0f, 0.0f, -42.0f), 0.0f, 0.9f, 0.0f, 2.0f);
+    addSceneInstance(pineTreeModel, glm::vec3(-14.0f, 0.0f, -34.0f), 0.0f, 0.85f, 1.0f, 1.8f);
+    addSceneInstance(oakTreeModel, glm::vec3(-14.0f, 0.0f, -26.0f), 0.0f, 0.95f, 2.0f, 1.5f);
+    addSceneInstance(lindenTreeModel, glm::vec3(-14.0f, 0.0f, -18.0f), 0.0f, 0.8f, 3.0f, 2.2f);
+    addSceneInstance(pineTreeModel, glm::vec3(-20.0f, 0.0f, -44.0f), 0.0f, 0.95f, 4.0f, 1.7f);
+    addSceneInstance(oakTreeModel, glm::vec3(-20.0f, 0.0f, -38.0f), 0.0f, 0.88f, 5.0f, 2.0f);
+    addSceneInstance(spruceTreeModel, glm::vec3(-20.0f, 0.0f, -30.0f), 0.0f, 0.92f, 6.0f, 1.6f);
+    addSceneInstance(lindenTreeModel, glm::vec3(-20.0f, 0.0f, -22.0f), 0.0f, 0.85f);
+    addSceneInstance(pineTreeModel, glm::vec3(-20.0f, 0.0f, -14.0f), 0.0f, 0.78f);
+    addSceneInstance(oakTreeModel, glm::vec3(-26.0f, 0.0f, -40.0f), 0.0f, 0.9f);
+    addSceneInstance(spruceTreeModel, glm::vec3(-26.0f, 0.0f, -28.0f), 0.0f, 0.95f);
+    addSceneInstance(lindenTreeModel, glm::vec3(-26.0f, 0.0f, -18.0f), 0.0f, 0.82f);
+    addSceneInstance(pineTreeModel, glm::vec3(14.0f, 0.0f, -42.0f), 0.0f, 0.85f);
+    addSceneInstance(oakTreeModel, glm::vec3(14.0f, 0.0f, -34.0f), 0.0f, 0.9f);
+    addSceneInstance(lindenTreeModel, glm::vec3(14.0f, 0.0f, -26.0f), 0.0f, 0.8f);
+    addSceneInstance(spruceTreeModel, glm::vec3(14.0f, 0.0f, -18.0f), 0.0f, 0.88f);
+    addSceneInstance(spruceTreeModel, glm::vec3(20.0f, 0.0f, -44.0f), 0.0f, 0.92f);
+    addSceneInstance(lindenTreeModel, glm::vec3(20.0f, 0.0f, -38.0f), 0.0f, 0.85f);
+    addSceneInstance(pineTreeModel, glm::vec3(20.0f, 0.0f, -30.0f), 0.0f, 0.88f);
+    addSceneInstance(oakTreeModel, glm::vec3(20.0f, 0.0f, -22.0f), 0.0f, 0.95f);
+    addSceneInstance(spruceTreeModel, glm::vec3(20.0f, 0.0f, -14.0f), 0.0f, 0.75f);
+    addSceneInstance(pineTreeModel, glm::vec3(26.0f, 0.0f, -40.0f), 0.0f, 0.9f);
+    addSceneInstance(lindenTreeModel, glm::vec3(26.0f, 0.0f, -28.0f), 0.0f, 0.88f);
+    addSceneInstance(oakTreeModel, glm::vec3(26.0f, 0.0f, -18.0f), 0.0f, 0.82f);
+
+    // Copaci suplimentari (zona băncilor 5 și 6)
+    addSceneInstance(lindenTreeModel, glm::vec3(-14.0f, 0.0f, 4.0f), 0.0f, 0.88f);
+    addSceneInstance(spruceTreeModel, glm::vec3(-14.0f, 0.0f, -6.0f), 0.0f, 0.9f);
+    addSceneInstance(pineTreeModel, glm::vec3(-20.0f, 0.0f, 0.0f), 0.0f, 0.85f);
+    addSceneInstance(oakTreeModel, glm::vec3(-20.0f, 0.0f, -8.0f), 0.0f, 0.92f);
+    addSceneInstance(lindenTreeModel, glm::vec3(-26.0f, 0.0f, -4.0f), 0.0f, 0.78f);
+    addSceneInstance(oakTreeModel, glm::vec3(14.0f, 0.0f, 4.0f), 0.0f, 0.9f);
+    addSceneInstance(pineTreeModel, glm::vec3(14.0f, 0.0f, -6.0f), 0.0f, 0.85f);
+    addSceneInstance(spruceTreeModel, glm::vec3(20.0f, 0.0f, 0.0f), 0.0f, 0.88f);
+    addSceneInstance(lindenTreeModel, glm::vec3(20.0f, 0.0f, -8.0f), 0.0f, 0.82f);
+    addSceneInstance(pineTreeModel, glm::vec3(26.0f, 0.0f, -4.0f), 0.0f, 0.95f);
+
+    // Copaci în jurul Bunny Truck
+    addSceneInstance(spruceTreeModel, glm::vec3(18.0f, 0.0f, 14.0f), 0.0f, 0.85f);
+    addSceneInstance(oakTreeModel, glm::vec3(18.0f, 0.0f, 6.0f), 0.0f, 0.9f);
+    addSceneInstance(lindenTreeModel, glm::vec3(20.0f, 0.0f, 18.0f), 0.0f, 0.88f);
+    addSceneInstance(pineTreeModel, glm::vec3(24.0f, 0.0f, 10.0f), 0.0f, 0.92f);
+    addSceneInstance(spruceTreeModel, glm::vec3(26.0f, 0.0f, 16.0f), 0.0f, 0.8f);
+    addSceneInstance(oakTreeModel, glm::vec3(26.0f, 0.0f, 4.0f), 0.0f, 0.85f);
+    addSceneInstance(lindenTreeModel, glm::vec3(22.0f, 0.0f, 20.0f), 0.0f, 0.78f);
+    addSceneInstance(pineTreeModel, glm::vec3(16.0f, 0.0f, 18.0f), 0.0f, 0.95f);
+    addSceneInstance(oakTreeModel, glm::vec3(14.0f, 0.0f, 24.0f), 0.0f, 0.88f);
+    addSceneInstance(spruceTreeModel, glm::vec3(16.0f, 0.0f, 32.0f), 0.0f, 0.9f);
+    addSceneInstance(pineTreeModel, glm::vec3(20.0f, 0.0f, 28.0f), 0.0f, 0.85f);
+    addSceneInstance(lindenTreeModel, glm::vec3(24.0f, 0.0f, 24.0f), 0.0f, 0.82f);
+    addSceneInstance(oakTreeModel, glm::vec3(26.0f, 0.0f, 30.0f), 0.0f, 0.92f);
+    addSceneInstance(spruceTreeModel, glm::vec3(14.0f, 0.0f, 36.0f), 0.0f, 0.78f);
+    addSceneInstance(pineTreeModel, glm::vec3(22.0f, 0.0f, 34.0f), 0.0f, 0.88f);
+
+    // Copaci suplimentari stânga
+    addSceneInstance(oakTreeModel, glm::vec3(-14.0f, 0.0f, 20.0f), 0.0f, 0.9f);
+    addSceneInstance(spruceTreeModel, glm::vec3(-18.0f, 0.0f, 16.0f), 0.0f, 0.85f);
+    addSceneInstance(pineTreeModel, glm::vec3(-20.0f, 0.0f, 24.0f), 0.0f, 0.92f);
+    addSceneInstance(lindenTreeModel, glm::vec3(-16.0f, 0.0f, 30.0f), 0.0f, 0.8f);
+    addSceneInstance(oakTreeModel, glm::vec3(-22.0f, 0.0f, 20.0f), 0.0f, 0.88f);
+    addSceneInstance(spruceTreeModel, glm::vec3(-24.0f, 0.0f, 28.0f), 0.0f, 0.78f);
+    addSceneInstance(pineTreeModel, glm::vec3(-14.0f, 0.0f, 34.0f), 0.0f, 0.95f);
+    addSceneInstance(lindenTreeModel, glm::vec3(-26.0f, 0.0f, 14.0f), 0.0f, 0.82f);
+
+    //  ANGEL STATUE
+    addSceneInstance(angelStatueModel, glm::vec3(0.0f, 0.0f, -45.0f), 0.0f, 0.8f);
+
+    // LAMP_12 (stânga și dreapta statuii)
+    addSceneInstance(lamp12Model, glm::vec3(-2.0f, 0.0f, -42.0f), 0.0f, 5.0f);
+    addSceneInstance(lamp12Model, glm::vec3(2.0f, 0.0f, -42.0f), 0.0f, 5.0f);
+
+    // Copaci extra pentru teste de performanță (în afara aleii centrale)
+    Model* treeModels[] = { spruceTreeModel, pineTreeModel, oakTreeModel, lindenTreeModel };
+    for (int i = 0; i < extraTreeCount; i++) {
+        float x = (rand() % 9600) / 100.0f - 48.0f;
+        float z = (rand() % 9600) / 100.0f - 48.0f;
+        if (fabs(x) < 11.0f) x += (x < 0.0f ? -11.0f : 11.0f);
+        float scale = 0.75f + (rand() % 20) / 100.0f;
+        addSceneInstance(treeModels[i % 4], glm::vec3(x, 0.0f, z), 0.0f, scale,
+            (float)(i % 7), (i % 3 == 0) ? 1.8f : 0.0f);
+    }
+
+    // Lămpi extra cu lumină, pentru testarea iluminării pe clustere
+    for (int i = 0; i < extraLampCount; i++) {
+        float x = (rand() % 9600) / 100.0f - 48.0f;
+        float z = (rand() % 9600) / 100.0f - 48.0f;
+        addSceneInstance(lampModel, glm::vec3(x, 0.0f, z), (float)(rand() % 360), 0.3f);
+        addPointLight(glm::vec3(x, 2.5f, z), glm::vec3(1.0f, 0.85f, 0.5f) * 2.5f, 12.0f);
+    }
+
+    std::cout << "Scene instances: " << sceneInstances.size()
+              << " in " << colorBatches.size() << " instance batches" << std::endl;
+}
+
+// Băncile, lămpile, statuia și lamp_12 nu se mișcă niciodată: sunt copiate în
+// coordonate de lume și unite pe bucket-uri (--batch-bucket N metri)
+void buildStaticBatches() {
+    Model* batchable[] = { benchModel, lampModel, angelStatueModel, lamp12Model };
+    for (SceneInstance& instance : sceneInstances) {
+        if (instance.swayAmplitude != 0.0f) continue;
+        if (std::find(std::begin(batchable), std::end(batchable), instance.model) == std::end(batchable)) continue;
+        instance.staticBatched = true;
+        staticBatcher.add(instance.model, instanceMatrix(instance));
+    }
+    staticBatcher.build();
+    staticBatcher.printReport();
+}
+
+void updateInstanceBatches() {
+    if (!instancingEnabled) return;
+
+    int cascadeCount = shadowCascades.count;
+    for (size_t i = 0; i < colorBatches.size(); i++) {
+        colorBatches[i]->clear();
+        for (int c = 0; c < cascadeCount; c++) {
+            shadowBatches[c][i]->clear();
+        }
+    }
+
+    for (size_t i = 0; i < sceneInstances.size(); i++) {
+        const SceneInstance& instance = sceneInstances[i];
+        if (drawnByStaticBatch(instance)) continue;
+        bool dynamicCaster = instance.swayAmplitude != 0.0f;
+        bool castsShadow = false;
+        for (int c = 0; c < cascadeCount; c++) {
+            if (shadowVisible[c][i] && (!shadowCacheEnabled || dynamicCaster)) castsShadow = true;
+        }
+        if (!cullVisible[i] && !castsShadow) continue;
+
+        // Aceeași matrice alimentează atât pasul de culoare cât și cascadele de umbră
+        glm::mat4 model = instanceMatrix(instance);
+        if (cullVisible[i]) {
+            colorBatches[instance.batchIndex]->add(model);
+        }
+        if (!castsShadow) continue;
+        for (int c = 0; c < cascadeCount; c++) {
+            if (shadowVisible[c][i] && (!shadowCacheEnabled || dynamicCaster)) {
+                shadowBatches[c][instance.batchIndex]->add(model);
+            }
+        }
+    }
+
+    for (size_t i = 0; i < colorBatches.size(); i++) {
+        colorBatches[i]->upload();
+        for (int c = 0; c < cascadeCount; c++) {
+            shadowBatches[c][i]->upload();
+        }
+    }
+}
+
+void drawSceneInstances(Shader& shader, bool depthPass, ShadowCasterSet casters, int cascade) {
+    if (instancingEnabled) {
+        std::vector<InstanceBatch*>& batches = depthPass ? shadowBatches[cascade] : colorBatches;
+        shader.setBool("useInstancing", true);
+        for (InstanceBatch* batch : batches) {
+            if (depthPass && depthOnlyShadowsEnabled) {
+                batch->drawDepth();
+            }
+            else {
+                batch->draw(shader);
             }
         }
+        shader.setBool("useInstancing", false);
+        return;
+    }
+
+    for (size_t i = 0; i < sceneInstances.size(); i++) {
+        const SceneInstance& instance = sceneInstances[i];
+        if (drawnByStaticBatch(instance)) continue;
+        if (depthPass) {
+            bool dynamicCaster = instance.swayAmplitude != 0.0f;
+            if (casters == CASTERS_STATIC && dynamicCaster) continue;
+            if (casters == CASTERS_DYNAMIC && !dynamicCaster) continue;
+            if (casters != CASTERS_STATIC && !shadowVisible[cascade][i]) continue;
+        }
+        else if (!cullVisible[i]) {
+            continue;
+        }
+        shader.setMat4("model", instanceMatrix(instance));
+        if (depthPass && depthOnlyShadowsEnabled) {
+            instance.model->drawDepth();
+        }
+        else {
+            instance.model->draw(shader);
+        }
+        RenderStats::frame().instancesDrawn++;
+    }
+}
+
+glm::mat4 bunnyTruckMatrix(float bobbing) {
+    glm::mat4 model = glm::mat4(1.0f);
+    model = glm::translate(model, glm::vec3(8.0f, bobbing, 28.0f));
+    model = glm::rotate(model, glm::radians(-90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    model = glm::scale(model, glm::vec3(2.5f, 2.5f, 2.5f));
+    return model;
+}
+
+glm::mat4 moonMatrix() {
+    glm::mat4 model = glm::mat4(1.0f);
+    model = glm::translate(model, glm::vec3(15.0f, 35.0f, -30.0f));
+    model = glm::rotate(model, glm::radians(moonRotation), glm::vec3(0.0f, 1.0f, 0.0f));
+    model = glm::scale(model, glm::vec3(0.002f, 0.002f, 0.002f));
+    return model;
+}
+
+// Recalculează cutia în lume a unui obiect eliminabil din transformarea lui curentă
+void updateCullBounds(int id) {
+    if (id == truckCullId) {
+        // Bunny-ul se leagănă cu +-0.02 pe Y
+        AABB box = transformAABB(bunnyTruckModel->boundsMin, bunnyTruckModel->boundsMax, bunnyTruckMatrix(0.0f));
+        box.min.y -= 0.02f;
+        box.max.y += 0.02f;
+        cullBounds[id] = box;
+    }
+    else if (id == moonCullId) {
+        cullBounds[id] = transformAABB(moonModel->boundsMin, moonModel->boundsMax, moonMatrix());
+    }
+    else if (staticBatchCullId >= 0 && id >= staticBatchCullId) {
+        cullBounds[id] = staticBatcher.batches[id - staticBatchCullId].bounds;
+    }
+    else {
+        const SceneInstance& instance = sceneInstances[id];
+        cullBounds[id] = transformAABB(instance.model->boundsMin, instance.model->boundsMax, instanceMatrix(instance));
+    }
+}
+
+void initCulling() {
+    int count = (int)sceneInstances.size();
+    dynamicCullIds.clear();
+    for (int i = 0; i < count; i++) {
+        if (sceneInstances[i].swayAmplitude != 0.0f) dynamicCullIds.push_back(i);
+    }
+    if (bunnyTruckModel && bunnyTruckModel->vertexCount() > 0) {
+        truckCullId = count++;
+    }
+    if (moonModel && moonModel->vertexCount() > 0) {
+        moonCullId = count++;
+        dynamicCullIds.push_back(moonCullId);
+    }
+    if (!staticBatcher.empty()) {
+        staticBatchCullId = count;
+        count += (int)staticBatcher.batches.size();
+    }
+
+    cullBounds.resize(count);
+    for (int i = 0; i < count; i++) {
+        updateCullBounds(i);
+    }
+    sceneBVH.build(cullBounds);
+    cullVisible.assign(count, 1);
+    for (int c = 0; c < ShadowCascades::MAX_CASCADES; c++) {
+        shadowVisible[c].assign(count, 1);
+    }
+
+    std::cout << "Culling BVH built: " << count << " objects, " << sceneBVH.nodeCount() << " nodes ("
+              << dynamicCullIds.size() << " refit per frame)" << std::endl;
+}
+
+// Un obiect care aruncă umbră contează doar dacă e în volumul luminii (extins spre
+// lumină, trecerea de umbră folosește depth clamping) și umbra lui, întinsă pe
+// direcția luminii până la sol, poate cădea în frustumul camerei.
+int cullShadowCasters(const Frustum& cameraFrustum, const glm::mat4& lightViewProjection,
+    std::vector<unsigned char>& visible) {
+    Frustum lightFrustum = Frustum::fromMatrix(lightViewProjection);
+    lightFrustum.planes[4] = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f); // fără near plane
+
+    sceneBVH.cull(lightFrustum, visible);
+
+    glm::vec3 lightDir = glm::normalize(moonLightTarget - moonLightPosition);
+    int casterCount = 0;
+    for (size_t i = 0; i < visible.size(); i++) {
+        if (!visible[i]) continue;
+        if ((int)i == moonCullId) {
+            visible[i] = 0;
+            continue;
+        }
+        if (cullVisible[i]) {
+            casterCount++;
+            continue;
+        }
+
+        const AABB& box = cullBounds[i];
+        AABB swept = box;
+        if (lightDir.y < 0.0f && box.max.y > 0.0f) {
+            glm::vec3 offset = lightDir * (box.max.y / -lightDir.y);
+            swept.min = glm::min(box.min, box.min + offset);
+            swept.max = glm::max(box.max, box.max + offset);
+        }
+        if (cameraFrustum.intersects(swept)) {
+            casterCount++;
+        }
+        else {
+            visible[i] = 0;
+        }
+    }
+    return casterCount;
+}
+
+void cullScene(const glm::mat4& viewProjection) {
+    double start = glfwGetTime();
+
+    if (!dynamicCullIds.empty()) {
+        for (int id : dynamicCullIds) {
+            updateCullBounds(id);
+        }
+        sceneBVH.refit(cullBounds);
+    }
+
+    RenderStats& stats = RenderStats::frame();
+    int visibleCount = (int)cullBounds.size();
+    if (frustumCullingEnabled) {
+        Frustum cameraFrustum = Frustum::fromMatrix(viewProjection);
+        visibleCount = sceneBVH.cull(cameraFrustum, cullVisible);
+
+        // Fiecare cascadă are propriul set de obiecte care aruncă umbră
+        stats.shadowCasters = 0;
+        for (int c = 0; c < shadowCascades.count; c++) {
+            stats.shadowCasters += cullShadowCasters(cameraFrustum, shadowCascades.cascades[c].lightSpaceMatrix,
+                shadowVisible[c]);
+        }
+        stats.shadowCastersCulled = (int)cullBounds.size() * shadowCascades.count - stats.shadowCasters;
+    }
+    else {
+        cullVisible.assign(cullBounds.size(), 1);
+        for (int c = 0; c < shadowCascades.count; c++) {
+            shadowVisible[c].assign(cullBounds.size(), 1);
+            if (moonCullId >= 0) shadowVisible[c][moonCullId] = 0;
+        }
+        stats.shadowCasters = ((int)cullBounds.size() - (moonCullId >= 0 ? 1 : 0)) * shadowCascades.count;
+        stats.shadowCastersCulled = 0;
+    }
+
+    stats.objectsVisible = visibleCount;
+    stats.objectsCulled = (int)cullBounds.size() - visibleCount;
+    stats.cullMs = (glfwGetTime() - start) * 1000.0;
+}
 
         void initColliders() {
             sceneColliders.clear();
@@ -1395,6 +1891,74 @@ glEnable(GL_CULL_FACE);
 
 int main(int argc, const char * argv[]) {
 
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--extra-trees" && i + 1 < argc) {
+            extraTreeCount = atoi(argv[++i]);
+        }
+        else if (arg == "--extra-lamps" && i + 1 < argc) {
+            extraLampCount = atoi(argv[++i]);
+        }
+        else if (arg == "--window" && i + 1 < argc) {
+            int width = 0, height = 0;
+            if (sscanf(argv[++i], "%dx%d", &width, &height) == 2 && width > 0 && height > 0) {
+                GL_WINDOW_WIDTH = width;
+                GL_WINDOW_HEIGHT = height;
+            }
+        }
+        else if (arg == "--rain-drops" && i + 1 < argc) {
+            rainParticleCount = std::max(0, atoi(argv[++i]));
+        }
+        else if (arg == "--rain-density" && i + 1 < argc) {
+            rainDensity = std::max(0.0f, (float)atof(argv[++i]));
+        }
+        else if (arg == "--rain-box" && i + 1 < argc) {
+            float width = 0.0f, height = 0.0f;
+            if (sscanf(argv[++i], "%fx%f", &width, &height) == 2 && width > 0.0f && height > 0.0f) {
+                rainBoxWidth = width;
+                rainBoxHeight = height;
+            }
+        }
+        else if (arg == "--rain-world") {
+            rainFollowsCamera = false;
+        }
+        else if (arg == "--particle-scale" && i + 1 < argc) {
+            int scale = atoi(argv[++i]);
+            lowResParticles.scale = scale >= 4 ? 4 : (scale >= 2 ? 2 : 1);
+        }
+        else if (arg == "--render-scale" && i + 1 < argc) {
+            // MIN-MAX, sau o singură valoare pentru o scară fixă
+            float low = 0.0f, high = 0.0f;
+            int count = sscanf(argv[++i], "%f-%f", &low, &high);
+            if (count == 1) high = low;
+            if (count >= 1 && low > 0.0f && high >= low) {
+                dynamicResolution.minScale = std::max(low, 0.25f);
+                dynamicResolution.maxScale = std::min(std::max(high, dynamicResolution.minScale), 1.0f);
+                dynamicResolution.minScale = std::min(dynamicResolution.minScale, dynamicResolution.maxScale);
+            }
+        }
+        else if (arg == "--target-ms" && i + 1 < argc) {
+            float ms = (float)atof(argv[++i]);
+            if (ms > 0.0f) dynamicResolution.targetMs = ms;
+        }
+        else if (arg == "--rain-benchmark") {
+            rainBenchmark = true;
+        }
+        else if (arg == "--batch-bucket" && i + 1 < argc) {
+            float size = (float)atof(argv[++i]);
+            if (size > 0.0f) staticBatcher.bucketSize = size;
+        }
+        else if (arg == "--tier" && i + 1 < argc) {
+            GLCapabilities::Tier tier;
+            if (GLCapabilities::parseTier(argv[++i], tier)) {
+                GLCapabilities::get().requestedTier = tier;
+            }
+            else {
+                std::cout << "Unknown tier " << argv[i] << " (baseline, modern, azdo, auto)" << std::endl;
+            }
+        }
+    }
+
     if (!initOpenGLWindow()) {
         return 1;
     }
@@ -1406,11 +1970,25 @@ int main(int argc, const char * argv[]) {
     // Load shadow shader
     shadowShader.loadShader("shaders/shadow.vert", "shaders/shadow.frag");
     
+    // Shaderele pentru deferred shading
+    gBufferShader.loadShader("shaders/basic.vert", "shaders/gbuffer.frag");
+    deferredLightingShader.loadShader("shaders/fullscreen.vert", "shaders/deferred_lighting.frag");
+    
+    // Shaderul de depth prepass (etapa de fragmente doar scrie adâncimea)
+    depthPrepassShader.loadShader("shaders/depth_prepass.vert", "shaders/shadow.frag");
+    glGenVertexArrays(1, &fullscreenVAO);
+    
+    // Datele dinamice pe cadru (matricele instanțelor, comenzile indirecte, ploaia de pe CPU)
+    StreamBuffer::get().init();
+    
     // Load rain shader
     rainShader.loadShader("shaders/rain.vert", "shaders/rain.frag");
     
     // Initialize rain system
     initRainSystem();
+    if (rainBenchmark) {
+        RainSimulation::benchmark(std::max(rainParticleCount, 1000000), 100);
+    }
     
     // Initialize shadow map
     initShadowMap();
@@ -1485,6 +2063,18 @@ int main(int argc, const char * argv[]) {
         fprintf(stderr, "WARNING: Failed to load skybox\n");
     }
 
+    // Construiește lista de instanțe (bănci, lămpi, copaci, statuie)
+    initPointLights();
+    initSceneInstances();
+    buildStaticBatches();
+    initCulling();
+    buildRainOcclusion();
+    initParticleSystems();
+    lightClusters.init();
+    opaqueQueue.init();
+    GeometryPool::meshes().printStats();
+    GeometryPool::positions().printStats();
+
     // Initialize collision system
     initColliders();
     camera.setColliders(&sceneColliders);
@@ -1498,6 +2088,8 @@ int main(int argc, const char * argv[]) {
         float currentFrame = glfwGetTime();
         deltaTime = currentFrame - lastFrame;
         lastFrame = currentFrame;
+        RenderStats::frame().reset();
+        StreamBuffer::get().beginFrame();
         
         // Input
         processInput(glWindow);
@@ -1512,12 +2104,24 @@ int main(int argc, const char * argv[]) {
         if (rainEnabled) {
             updateRainParticles(deltaTime);
         }
+        if (particlesEnabled) {
+            for (ParticleSystem* system : particleSystems) system->update(deltaTime);
+        }
         
         // Render
         renderScene();
+        presentScene();
+        StreamBuffer::get().endFrame();
+        RenderStats::frame().cpuFrameMs = (glfwGetTime() - currentFrame) * 1000.0;
 
         glfwSwapBuffers(glWindow);
         glfwPollEvents();
+        if (statsReporter.endFrame(glfwGetTime())) {
+            if (particlesEnabled) ParticleSystem::printReport(particleSystems);
+        }
+        else if (!statsReporter.enabled) {
+            ParticleSystem::resetReport(particleSystems);
+        }
     }
     
     cleanup();
@@ -1562,6 +2166,28 @@ void processInput(GLFWwindow *window)
         static bool key0Pressed = false;
         static bool key9Pressed = false;
         static bool keyBPressed = false;
+        static bool keyIPressed = false;
+        static bool keyRPressed = false;
+        static bool keyMPressed = false;
+        static bool keyOPressed = false;
+        static bool keyGPressed = false;
+        static bool keyUPressed = false;
+        static bool keyPPressed = false;
+        static bool keyFPressed = false;
+        static bool keyKPressed = false;
+        static bool keyLPressed = false;
+        static bool keyJPressed = false;
+        static bool keyTPressed = false;
+        static bool keyNPressed = false;
+        static bool keyHPressed = false;
+        static bool keyYPressed = false;
+        static bool keyF2Pressed = false;
+        static bool key3Pressed = false;
+        static bool key4Pressed = false;
+        static bool key5Pressed = false;
+        static bool key6Pressed = false;
+        static bool key7Pressed = false;
+        static bool key8Pressed = false;
     
         if (glfwGetKey(window, GLFW_KEY_0) == GLFW_PRESS && !key0Pressed) {
             fogEnabled = !fogEnabled;
@@ -1572,6 +2198,36 @@ void processInput(GLFWwindow *window)
             key0Pressed = false;
         }
     
+        // Termenul de înălțime al ceții (pâcla care se rărește cu înălțimea)
+        if (glfwGetKey(window, GLFW_KEY_H) == GLFW_PRESS && !keyHPressed) {
+            heightFogEnabled = !heightFogEnabled;
+            keyHPressed = true;
+            std::cout << "Height fog " << (heightFogEnabled ? "enabled" : "disabled") << std::endl;
+        }
+        if (glfwGetKey(window, GLFW_KEY_H) == GLFW_RELEASE) {
+            keyHPressed = false;
+        }
+    
+        // Ceața volumetrică (froxeli) luminată de lună și de lămpi, sau trecerea analitică
+        if (glfwGetKey(window, GLFW_KEY_Y) == GLFW_PRESS && !keyYPressed) {
+            volumetricFogEnabled = !volumetricFogEnabled;
+            keyYPressed = true;
+            std::cout << (volumetricFogEnabled ? "Volumetric" : "Analytic") << " fog" << std::endl;
+        }
+        if (glfwGetKey(window, GLFW_KEY_Y) == GLFW_RELEASE) {
+            keyYPressed = false;
+        }
+    
+        // Rezoluția dinamică cu upscale temporal, sau direct în fereastră la mărime completă
+        if (glfwGetKey(window, GLFW_KEY_F2) == GLFW_PRESS && !keyF2Pressed) {
+            dynamicResolution.enabled = !dynamicResolution.enabled;
+            keyF2Pressed = true;
+            std::cout << "Dynamic resolution " << (dynamicResolution.enabled ? "enabled" : "disabled") << std::endl;
+        }
+        if (glfwGetKey(window, GLFW_KEY_F2) == GLFW_RELEASE) {
+            keyF2Pressed = false;
+        }
+    
         if (glfwGetKey(window, GLFW_KEY_9) == GLFW_PRESS && !key9Pressed) {
             rainEnabled = !rainEnabled;
             key9Pressed = true;
@@ -1581,6 +2237,47 @@ void processInput(GLFWwindow *window)
             key9Pressed = false;
         }
     
+        // Simularea ploii pe GPU (transform feedback) sau pe CPU
+        if (glfwGetKey(window, GLFW_KEY_U) == GLFW_PRESS && !keyUPressed) {
+            gpuRainEnabled = !gpuRainEnabled;
+            keyUPressed = true;
+            std::cout << "Rain simulation on the " << (gpuRainEnabled ? "GPU" : "CPU") << std::endl;
+        }
+        if (glfwGetKey(window, GLFW_KEY_U) == GLFW_RELEASE) {
+            keyUPressed = false;
+        }
+    
+        // Ploaia oprită de acoperișuri și coroane (harta de ocluzie de sus) sau doar de sol
+        if (glfwGetKey(window, GLFW_KEY_J) == GLFW_PRESS && !keyJPressed) {
+            rainOcclusionEnabled = !rainOcclusionEnabled;
+            keyJPressed = true;
+            std::cout << "Rain occlusion " << (rainOcclusionEnabled ? "enabled" : "disabled") << std::endl;
+        }
+        if (glfwGetKey(window, GLFW_KEY_J) == GLFW_RELEASE) {
+            keyJPressed = false;
+        }
+    
+        // Sistemele de particule (molii în jurul lămpilor, frunze care cad)
+        if (glfwGetKey(window, GLFW_KEY_T) == GLFW_PRESS && !keyTPressed) {
+            particlesEnabled = !particlesEnabled;
+            keyTPressed = true;
+            std::cout << "Particles " << (particlesEnabled ? "enabled" : "disabled") << std::endl;
+        }
+        if (glfwGetKey(window, GLFW_KEY_T) == GLFW_RELEASE) {
+            keyTPressed = false;
+        }
+    
+        // Rezoluția particulelor cu blending: completă -> jumătate -> sfert -> completă
+        if (glfwGetKey(window, GLFW_KEY_N) == GLFW_PRESS && !keyNPressed) {
+            lowResParticles.scale = lowResParticles.scale >= 4 ? 1 : lowResParticles.scale * 2;
+            keyNPressed = true;
+            std::cout << "Blended particles at " << (lowResParticles.scale == 1 ? "full" : lowResParticles.scale == 2 ? "half" : "quarter")
+                      << " resolution" << std::endl;
+        }
+        if (glfwGetKey(window, GLFW_KEY_N) == GLFW_RELEASE) {
+            keyNPressed = false;
+        }
+    
         // Collision toggle
         if (glfwGetKey(window, GLFW_KEY_B) == GLFW_PRESS && !keyBPressed) {
             camera.collisionEnabled = !camera.collisionEnabled;
@@ -1590,6 +2287,170 @@ void processInput(GLFWwindow *window)
         if (glfwGetKey(window, GLFW_KEY_B) == GLFW_RELEASE) {
             keyBPressed = false;
         }
+    
+        // Pornește / oprește coada de randare (oprită = desene în ordinea din cod, starea setată la fiecare desen)
+        if (glfwGetKey(window, GLFW_KEY_R) == GLFW_PRESS && !keyRPressed) {
+            renderQueueEnabled = !renderQueueEnabled;
+            keyRPressed = true;
+            std::cout << "Render queue " << (renderQueueEnabled ? "enabled" : "disabled") << std::endl;
+        }
+        if (glfwGetKey(window, GLFW_KEY_R) == GLFW_RELEASE) {
+            keyRPressed = false;
+        }
+    
+        // Pornește / oprește multi-draw indirect (oprit = un desen pe element, unite doar la aceeași transformare)
+        if (glfwGetKey(window, GLFW_KEY_M) == GLFW_PRESS && !keyMPressed) {
+            if (opaqueQueue.indirectSupported) {
+                opaqueQueue.indirectEnabled = !opaqueQueue.indirectEnabled;
+                std::cout << "Multi-draw indirect " << (opaqueQueue.indirectEnabled ? "enabled" : "disabled") << std::endl;
+            }
+            else {
+                std::cout << "Multi-draw indirect not supported (GL_ARB_multi_draw_indirect / GL_ARB_base_instance)" << std::endl;
+            }
+            keyMPressed = true;
+        }
+        if (glfwGetKey(window, GLFW_KEY_M) == GLFW_RELEASE) {
+            keyMPressed = false;
+        }
+    
+        // Încărcările pe cadru prin stream buffer-ul cu fence-uri (oprit = buffere orfanizate)
+        if (glfwGetKey(window, GLFW_KEY_O) == GLFW_PRESS && !keyOPressed) {
+            StreamBuffer::get().enabled = !StreamBuffer::get().enabled;
+            keyOPressed = true;
+            std::cout << "Stream buffer " << (StreamBuffer::get().enabled ? "enabled" : "disabled") << std::endl;
+        }
+        if (glfwGetKey(window, GLFW_KEY_O) == GLFW_RELEASE) {
+            keyOPressed = false;
+        }
+    
+        // Pornește / oprește static batching (oprit = băncile, lămpile, statuia desenate pe obiect / instanțiat)
+        if (glfwGetKey(window, GLFW_KEY_G) == GLFW_PRESS && !keyGPressed) {
+            staticBatchingEnabled = !staticBatchingEnabled;
+            staticShadowDirty = true;
+            keyGPressed = true;
+            std::cout << "Static batching " << (staticBatchingEnabled ? "enabled" : "disabled") << std::endl;
+        }
+        if (glfwGetKey(window, GLFW_KEY_G) == GLFW_RELEASE) {
+            keyGPressed = false;
+        }
+    
+        // Pornește / oprește instancing
+        if (glfwGetKey(window, GLFW_KEY_I) == GLFW_PRESS && !keyIPressed) {
+            instancingEnabled = !instancingEnabled;
+            keyIPressed = true;
+            std::cout << "Instancing " << (instancingEnabled ? "enabled" : "disabled") << std::endl;
+        }
+        if (glfwGetKey(window, GLFW_KEY_I) == GLFW_RELEASE) {
+            keyIPressed = false;
+        }
+    
+        // Pornește / oprește frustum culling
+        if (glfwGetKey(window, GLFW_KEY_F) == GLFW_PRESS && !keyFPressed) {
+            frustumCullingEnabled = !frustumCullingEnabled;
+            keyFPressed = true;
+            std::cout << "Frustum culling " << (frustumCullingEnabled ? "enabled" : "disabled") << std::endl;
+        }
+        if (glfwGetKey(window, GLFW_KEY_F) == GLFW_RELEASE) {
+            keyFPressed = false;
+        }
+    
+        // Pornește / oprește calea de umbră doar cu adâncime (comparați shadow gpu în statistici)
+        if (glfwGetKey(window, GLFW_KEY_K) == GLFW_PRESS && !keyKPressed) {
+            depthOnlyShadowsEnabled = !depthOnlyShadowsEnabled;
+            keyKPressed = true;
+            std::cout << "Depth-only shadow path " << (depthOnlyShadowsEnabled ? "enabled" : "disabled") << std::endl;
+        }
+        if (glfwGetKey(window, GLFW_KEY_K) == GLFW_RELEASE) {
+            keyKPressed = false;
+        }
+    
+        // Pornește / oprește cache-ul de umbre statice
+        if (glfwGetKey(window, GLFW_KEY_L) == GLFW_PRESS && !keyLPressed) {
+            shadowCacheEnabled = !shadowCacheEnabled;
+            staticShadowDirty = true;
+            keyLPressed = true;
+            std::cout << "Static shadow cache " << (shadowCacheEnabled ? "enabled" : "disabled") << std::endl;
+        }
+        if (glfwGetKey(window, GLFW_KEY_L) == GLFW_RELEASE) {
+            keyLPressed = false;
+        }
+    
+        // Numărul de cascade de umbră: 2 -> 3 -> 4 -> 2
+        if (glfwGetKey(window, GLFW_KEY_3) == GLFW_PRESS && !key3Pressed) {
+            shadowCascades.count = shadowCascades.count % ShadowCascades::MAX_CASCADES + 1;
+            if (shadowCascades.count < 2) shadowCascades.count = 2;
+            staticShadowDirty = true;
+            key3Pressed = true;
+            std::cout << "Shadow cascades: " << shadowCascades.count << std::endl;
+        }
+        if (glfwGetKey(window, GLFW_KEY_3) == GLFW_RELEASE) {
+            key3Pressed = false;
+        }
+    
+        // Umbre la rezoluție redusă (1024 în loc de 2048 pe cascadă)
+        if (glfwGetKey(window, GLFW_KEY_4) == GLFW_PRESS && !key4Pressed) {
+            resizeShadowMaps(shadowCascades.resolution == 2048 ? 1024 : 2048);
+            key4Pressed = true;
+            std::cout << "Shadow cascade resolution: " << shadowCascades.resolution << "x"
+                      << shadowCascades.resolution << std::endl;
+        }
+        if (glfwGetKey(window, GLFW_KEY_4) == GLFW_RELEASE) {
+            key4Pressed = false;
+        }
+    
+        // Filtrarea umbrelor: PCF 3x3 -> PCF hardware -> ESM
+        if (glfwGetKey(window, GLFW_KEY_5) == GLFW_PRESS && !key5Pressed) {
+            shadowFilterMode = (shadowFilterMode + 1) % 3;
+            key5Pressed = true;
+            std::cout << "Shadow filter: " << shadowFilterNames[shadowFilterMode] << std::endl;
+        }
+        if (glfwGetKey(window, GLFW_KEY_5) == GLFW_RELEASE) {
+            key5Pressed = false;
+        }
+    
+        // Pornește / oprește iluminarea pe clustere (oprită = fiecare fragment parcurge toate luminile)
+        if (glfwGetKey(window, GLFW_KEY_6) == GLFW_PRESS && !key6Pressed) {
+            clusteredLightingEnabled = !clusteredLightingEnabled;
+            key6Pressed = true;
+            std::cout << "Clustered lighting " << (clusteredLightingEnabled ? "enabled" : "disabled") << std::endl;
+        }
+        if (glfwGetKey(window, GLFW_KEY_6) == GLFW_RELEASE) {
+            key6Pressed = false;
+        }
+    
+        // Shading forward / deferred
+        if (glfwGetKey(window, GLFW_KEY_7) == GLFW_PRESS && !key7Pressed) {
+            deferredShadingEnabled = !deferredShadingEnabled;
+            key7Pressed = true;
+            std::cout << "Render path: " << (deferredShadingEnabled ? "deferred" : "forward") << std::endl;
+        }
+        if (glfwGetKey(window, GLFW_KEY_7) == GLFW_RELEASE) {
+            key7Pressed = false;
+        }
+    
+        // Depth prepass: oprit / pornit / auto (ales după overdraw-ul măsurat)
+        if (glfwGetKey(window, GLFW_KEY_8) == GLFW_PRESS && !key8Pressed) {
+            depthPrepassMode = (depthPrepassMode + 1) % 3;
+            key8Pressed = true;
+            std::cout << "Depth prepass: " << depthPrepassNames[depthPrepassMode] << std::endl;
+        }
+        if (glfwGetKey(window, GLFW_KEY_8) == GLFW_RELEASE) {
+            key8Pressed = false;
+        }
+    
+        // Pornește / oprește statisticile de performanță
+        if (glfwGetKey(window, GLFW_KEY_P) == GLFW_PRESS && !keyPPressed) {
+            statsReporter.enabled = !statsReporter.enabled;
+            keyPPressed = true;
+            std::cout << "Stats " << (statsReporter.enabled ? "enabled" : "disabled") << std::endl;
+            if (statsReporter.enabled) {
+                GeometryPool::meshes().printStats();
+                GeometryPool::positions().printStats();
+            }
+        }
+        if (glfwGetKey(window, GLFW_KEY_P) == GLFW_RELEASE) {
+            keyPPressed = false;
+        }
     }
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height)
@@ -4,25 +4,32 @@ layout(location = 0) in vec3 aPos;
 layout(location = 1) in vec3 aNormal;
 layout(location = 2) in vec2 aTexCoords;
 layout(location = 3) in vec3 aColor;
+layout(location = 4) in mat4 aInstanceModel;
 
 out vec3 FragPos;
 out vec3 Normal;
 out vec2 TexCoords;
 out vec3 VertexColor;
-out vec4 FragPosLightSpace;
+out float ViewDepth;
 
 uniform mat4 model;
 uniform mat4 view;
 uniform mat4 projection;
-uniform mat4 lightSpaceMatrix;
+uniform bool useInstancing;
+
+// Trebuie să dea exact aceeași adâncime ca depth_prepass.vert (GL_EQUAL)
+invariant gl_Position;
 
 void main()
 {
-    FragPos = vec3(model * vec4(aPos, 1.0));
-    Normal = mat3(transpose(inverse(model))) * aNormal;
+    mat4 worldModel = useInstancing ? aInstanceModel : model;
+
+    FragPos = vec3(worldModel * vec4(aPos, 1.0));
+    Normal = mat3(transpose(inverse(worldModel))) * aNormal;
     TexCoords = aTexCoords;
     VertexColor = aColor;
-    FragPosLightSpace = lightSpaceMatrix * vec4(FragPos, 1.0);
     
-    gl_Position = projection * view * vec4(FragPos, 1.0);
-}
\ No newline at end of file
+    vec4 viewPosition = view * vec4(FragPos, 1.0);
+    ViewDepth = -viewPosition.z;
+    gl_Position = projection * viewPosition;
+}
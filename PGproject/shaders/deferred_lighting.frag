@@ -0,0 +1,41 @@
+#version 410 core
+
+// Trecerea de iluminare a căii deferred: un triunghi pe tot ecranul, fiecare
+// pixel e luminat exact o dată, cu același cod ca în calea forward.
+in vec2 TexCoords;
+
+out vec4 FragColor;
+
+uniform sampler2D gAlbedo;
+uniform sampler2D gNormal;
+uniform sampler2D gDepth;
+uniform mat4 inverseViewProjection;
+uniform mat4 view;
+
+#include "lighting.glsl"
+
+void main()
+{
+    // texelFetch: cu rezoluția dinamică G-buffer-ul e mai mare decât viewport-ul
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+    float depth = texelFetch(gDepth, pixel, 0).r;
+    if (depth >= 1.0)
+        discard; // cerul (skybox-ul e deja desenat)
+
+    // Poziția în lume reconstruită din adâncime
+    vec4 clip = vec4(vec3(TexCoords, depth) * 2.0 - 1.0, 1.0);
+    vec4 world = inverseViewProjection * clip;
+    vec3 fragPos = world.xyz / world.w;
+    float viewDepth = -(view * vec4(fragPos, 1.0)).z;
+
+    vec4 albedo = texelFetch(gAlbedo, pixel, 0);
+    vec3 normalOrEmission = texelFetch(gNormal, pixel, 0).xyz;
+    bool emissive = albedo.a > 0.5;
+
+    vec3 result = ShadeSurface(fragPos, emissive ? vec3(0.0, 1.0, 0.0) : normalize(normalOrEmission),
+        viewDepth, albedo.rgb, emissive, normalOrEmission);
+    FragColor = vec4(result, 1.0);
+
+    // Scrie adâncimea ca ploaia (desenată forward) să fie ascunsă corect
+    gl_FragDepth = depth;
+}
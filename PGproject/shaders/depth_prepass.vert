@@ -0,0 +1,21 @@
+#version 410 core
+
+layout(location = 0) in vec3 aPos;
+layout(location = 4) in mat4 aInstanceModel;
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+uniform bool useInstancing;
+
+// Aceleași operații ca în basic.vert: pasul de culoare testează cu GL_EQUAL
+invariant gl_Position;
+
+void main()
+{
+    mat4 worldModel = useInstancing ? aInstanceModel : model;
+
+    vec3 fragPos = vec3(worldModel * vec4(aPos, 1.0));
+    vec4 viewPosition = view * vec4(fragPos, 1.0);
+    gl_Position = projection * viewPosition;
+}
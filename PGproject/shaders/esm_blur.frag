@@ -0,0 +1,33 @@
+#version 410 core
+
+in vec2 TexCoords;
+
+layout(location = 0) out float FragColor;
+
+uniform bool fromDepth;          // primul pas citește direct din shadow map
+uniform sampler2DArray depthLayers;
+uniform sampler2D source;
+uniform int layer;
+uniform vec2 direction;          // pasul de un texel pe axa blur-ului
+uniform float exponent;
+
+// Gaussian cu 9 eșantioane, patru ponderi pe fiecare parte plus centrul
+const float weights[5] = float[](0.2270270270, 0.1945945946, 0.1216216216, 0.0540540541, 0.0162162162);
+
+float fetch(vec2 uv)
+{
+    if (fromDepth)
+        return exp(exponent * texture(depthLayers, vec3(uv, float(layer))).r);
+    return texture(source, uv).r;
+}
+
+void main()
+{
+    float result = fetch(TexCoords) * weights[0];
+    for (int i = 1; i < 5; i++)
+    {
+        vec2 offset = direction * float(i);
+        result += (fetch(TexCoords + offset) + fetch(TexCoords - offset)) * weights[i];
+    }
+    FragColor = result;
+}
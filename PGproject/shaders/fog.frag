@@ -0,0 +1,36 @@
+#version 410 core
+
+// Ceața aplicată o singură dată pe pixel, după geometria opacă: poziția în lume
+// se reconstruiește din adâncime, iar rezultatul se amestecă peste fereastră
+in vec2 TexCoords;
+out vec4 FragColor;
+
+uniform sampler2D sceneDepth;
+uniform mat4 inverseViewProjection;
+uniform vec3 cameraPos;
+uniform vec3 fogColor;
+uniform float fogDensity;
+uniform float heightFogDensity; // 0 = fără ceață la sol
+uniform float heightFogFalloff;
+uniform float heightFogBase;
+
+void main()
+{
+    // Cerul (adâncime 1) ajunge pe planul îndepărtat, deci primește ceață plină
+    float depth = texelFetch(sceneDepth, ivec2(gl_FragCoord.xy), 0).r;
+    vec4 clip = vec4(vec3(TexCoords, depth) * 2.0 - 1.0, 1.0);
+    vec4 world = inverseViewProjection * clip;
+    vec3 ray = world.xyz / world.w - cameraPos;
+    float distance = length(ray);
+
+    // Ceața exponențială la pătrat, ca înainte în lighting.glsl
+    float opticalDepth = fogDensity * distance * distance;
+
+    // Ceața la sol: densitatea scade exponențial cu înălțimea; integrala pe rază e
+    // densitate(cameră) * distanță * (1 - exp(-k)) / k, cu k = falloff * diferența de înălțime
+    float k = heightFogFalloff * ray.y;
+    float cameraDensity = heightFogDensity * exp(-heightFogFalloff * (cameraPos.y - heightFogBase));
+    opticalDepth += cameraDensity * distance * (abs(k) > 1e-4 ? (1.0 - exp(-k)) / k : 1.0);
+
+    FragColor = vec4(fogColor, clamp(1.0 - exp(-opticalDepth), 0.0, 1.0));
+}
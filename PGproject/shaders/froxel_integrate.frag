@@ -0,0 +1,67 @@
+#version 410 core
+
+// Integrare de la cameră spre fundal pe coloana (x, y): după felia z, rgb =
+// lumina adunată până la capătul feliei, a = transmitanța rămasă. Fragmentul
+// scrie 8 felii consecutive și pornește din starea coloanei de la capătul
+// desenului anterior (carry), deci fiecare felie e integrată o singură dată.
+layout (location = 0) out vec4 integrated0;
+layout (location = 1) out vec4 integrated1;
+layout (location = 2) out vec4 integrated2;
+layout (location = 3) out vec4 integrated3;
+layout (location = 4) out vec4 integrated4;
+layout (location = 5) out vec4 integrated5;
+layout (location = 6) out vec4 integrated6;
+layout (location = 7) out vec4 integrated7;
+
+uniform sampler3D scattering;
+uniform ivec3 volumeSize;
+uniform float volumeNear;
+uniform float volumeFar;
+uniform vec2 tanHalfFov;
+uniform int firstSlice;
+uniform sampler2D carry; // ultima felie a desenului anterior (nefolosită pentru firstSlice = 0)
+
+vec3 accumulated = vec3(0.0);
+float transmittance = 1.0;
+float rayScale; // lungimea razei pe metru de adâncime în spațiul camerei
+float sliceStart; // adâncimea la care începe felia următoare
+
+float SliceDepth(float slice)
+{
+    return volumeNear * pow(volumeFar / volumeNear, slice / float(volumeSize.z));
+}
+
+vec4 Step(int slice)
+{
+    vec4 froxel = texelFetch(scattering, ivec3(ivec2(gl_FragCoord.xy), slice), 0);
+    float sliceEnd = SliceDepth(float(slice + 1));
+    float thickness = (sliceEnd - sliceStart) * rayScale;
+    sliceStart = sliceEnd;
+    float sliceTransmittance = exp(-froxel.a * thickness);
+    // Integrala exactă a luminii împrăștiate pe felie (densitate constantă în froxel)
+    accumulated += transmittance * froxel.rgb * (1.0 - sliceTransmittance) / max(froxel.a, 1e-5);
+    transmittance *= sliceTransmittance;
+    return vec4(accumulated, transmittance);
+}
+
+void main()
+{
+    vec2 uv = gl_FragCoord.xy / vec2(volumeSize.xy);
+    rayScale = length(vec3((uv * 2.0 - 1.0) * tanHalfFov, 1.0));
+
+    sliceStart = SliceDepth(float(firstSlice));
+    if (firstSlice > 0) {
+        vec4 state = texelFetch(carry, ivec2(gl_FragCoord.xy), 0);
+        accumulated = state.rgb;
+        transmittance = state.a;
+    }
+
+    integrated0 = Step(firstSlice);
+    integrated1 = Step(firstSlice + 1);
+    integrated2 = Step(firstSlice + 2);
+    integrated3 = Step(firstSlice + 3);
+    integrated4 = Step(firstSlice + 4);
+    integrated5 = Step(firstSlice + 5);
+    integrated6 = Step(firstSlice + 6);
+    integrated7 = Step(firstSlice + 7);
+}
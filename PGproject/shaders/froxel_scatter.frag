@@ -0,0 +1,123 @@
+#version 410 core
+
+// Volumul de ceață aliniat cu frustumul (froxeli): fiecare fragment e o coloană
+// (x, y) și scrie 8 felii consecutive, câte una pe atașament. O felie întreagă
+// e recalculată doar la câteva cadre (feliile se rotesc); restul reproiectează
+// valoarea din cadrul anterior.
+layout (location = 0) out vec4 scatter0;
+layout (location = 1) out vec4 scatter1;
+layout (location = 2) out vec4 scatter2;
+layout (location = 3) out vec4 scatter3;
+layout (location = 4) out vec4 scatter4;
+layout (location = 5) out vec4 scatter5;
+layout (location = 6) out vec4 scatter6;
+layout (location = 7) out vec4 scatter7;
+
+uniform sampler3D history;           // volumul cadrului anterior
+uniform bool historyValid;
+uniform mat4 previousViewProjection;
+uniform mat4 inverseView;
+uniform vec2 tanHalfFov;             // (tan * aspect, tan)
+uniform ivec3 volumeSize;
+uniform float volumeNear;
+uniform float volumeFar;
+uniform int firstSlice;
+uniform int frameIndex;
+uniform int updateInterval;
+uniform float sliceJitter;           // 0..1, alt punct din froxel la fiecare cadru
+uniform float historyWeight;         // cât din istoric păstrează un froxel recalculat
+
+// Mediul: densitate constantă + ceață la sol, lumina ambientală și a lunii
+uniform float fogDensity;
+uniform float heightFogDensity;
+uniform float heightFogFalloff;
+uniform float heightFogBase;
+uniform vec3 ambientLight;
+uniform float moonScattering;
+uniform float lampScattering;
+uniform float anisotropy;            // Henyey-Greenstein g
+
+#include "lighting.glsl"
+
+float SliceDepth(float slice)
+{
+    return volumeNear * pow(volumeFar / volumeNear, slice / float(volumeSize.z));
+}
+
+float DepthToSlice(float depth)
+{
+    return log(max(depth, volumeNear) / volumeNear) / log(volumeFar / volumeNear) * float(volumeSize.z);
+}
+
+// Henyey-Greenstein; cosTheta = unghiul dintre direcția luminii și cea spre cameră
+float Phase(float cosTheta)
+{
+    float g2 = anisotropy * anisotropy;
+    return (1.0 - g2) / (4.0 * 3.14159265 * pow(1.0 + g2 - 2.0 * anisotropy * cosTheta, 1.5));
+}
+
+// rgb = lumina împrăștiată spre cameră pe metru, a = coeficientul de extincție
+vec4 Froxel(int slice)
+{
+    ivec3 cell = ivec3(ivec2(gl_FragCoord.xy), slice);
+    vec2 uv = (vec2(cell.xy) + 0.5) / vec2(volumeSize.xy);
+    float viewDepth = SliceDepth(float(slice) + sliceJitter);
+    vec3 viewPosition = vec3((uv * 2.0 - 1.0) * tanHalfFov * viewDepth, -viewDepth);
+    vec3 worldPosition = (inverseView * vec4(viewPosition, 1.0)).xyz;
+
+    // Reproiectare în volumul cadrului anterior (clip.w = adâncimea în spațiul camerei)
+    vec4 previousClip = previousViewProjection * vec4(worldPosition, 1.0);
+    vec3 historyCoord = vec3(previousClip.xy / previousClip.w * 0.5 + 0.5,
+        DepthToSlice(previousClip.w) / float(volumeSize.z));
+    bool reprojected = historyValid && previousClip.w > 0.0
+        && all(greaterThanEqual(historyCoord, vec3(0.0))) && all(lessThanEqual(historyCoord, vec3(1.0)));
+    vec4 previous = reprojected ? texture(history, historyCoord) : vec4(0.0);
+
+    // Aceeași decizie pentru toată felia: fragmentele vecine (din același warp)
+    // iau aceeași ramură, altfel fiecare apel ar plăti calea completă
+    bool update = (cell.z + frameIndex) % updateInterval == 0;
+    if (reprojected && !update)
+        return previous;
+
+    float height = worldPosition.y - heightFogBase;
+    float extinction = fogDensity + heightFogDensity * exp(-heightFogFalloff * max(height, 0.0));
+
+    vec3 toCamera = normalize(viewPos - worldPosition);
+    vec3 moonDirection = normalize(lightPos - worldPosition);
+    float shadow = shadowsEnabled ? ShadowCalculation(worldPosition, viewDepth, moonDirection, moonDirection) : 0.0;
+    vec3 light = ambientLight + lightColor * moonScattering * (1.0 - shadow) * Phase(dot(-moonDirection, toCamera));
+
+    // Lămpile: aceleași clustere ca la suprafețe, fără termenul N·L
+    if (clusteredLighting) {
+        uvec2 range = ClusterLightRange(uv, viewDepth);
+        for (uint i = 0u; i < range.y; i++) {
+            int index = int(texelFetch(clusterLightIndices, int(range.x + i)).r);
+            vec4 positionRadius = texelFetch(lightData, index * 2);
+            vec3 lampDirection = normalize(positionRadius.xyz - worldPosition);
+            light += texelFetch(lightData, index * 2 + 1).rgb * PointLightAttenuation(positionRadius, worldPosition)
+                * lampScattering * Phase(dot(-lampDirection, toCamera));
+        }
+    } else {
+        for (int i = 0; i < numPointLights; i++) {
+            vec4 positionRadius = texelFetch(lightData, i * 2);
+            vec3 lampDirection = normalize(positionRadius.xyz - worldPosition);
+            light += texelFetch(lightData, i * 2 + 1).rgb * PointLightAttenuation(positionRadius, worldPosition)
+                * lampScattering * Phase(dot(-lampDirection, toCamera));
+        }
+    }
+
+    vec4 current = vec4(light * extinction, extinction);
+    return reprojected ? mix(previous, current, 1.0 - historyWeight) : current;
+}
+
+void main()
+{
+    scatter0 = Froxel(firstSlice);
+    scatter1 = Froxel(firstSlice + 1);
+    scatter2 = Froxel(firstSlice + 2);
+    scatter3 = Froxel(firstSlice + 3);
+    scatter4 = Froxel(firstSlice + 4);
+    scatter5 = Froxel(firstSlice + 5);
+    scatter6 = Froxel(firstSlice + 6);
+    scatter7 = Froxel(firstSlice + 7);
+}
@@ -0,0 +1,11 @@
+#version 410 core
+
+out vec2 TexCoords;
+
+// Triunghi pe tot ecranul generat din gl_VertexID (fără vertex buffer)
+void main()
+{
+    vec2 position = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    TexCoords = position;
+    gl_Position = vec4(position * 2.0 - 1.0, 0.0, 1.0);
+}
@@ -0,0 +1,29 @@
+#version 410 core
+
+// Trecerea G-buffer a căii deferred. Aceleași intrări și uniforme de material
+// ca basic.frag, dar doar memorează suprafața; iluminarea vine mai târziu, pe pixel.
+layout(location = 0) out vec4 gAlbedo;  // rgb = albedo, a = 1 pentru suprafețele emisive
+layout(location = 1) out vec4 gNormal;  // xyz = normala în lume, sau culoarea emisiei când e emisiv
+
+in vec3 FragPos;
+in vec3 Normal;
+in vec2 TexCoords;
+in vec3 VertexColor;
+in float ViewDepth;
+
+uniform sampler2D diffuseTexture;
+uniform vec3 objectColor;
+uniform bool useTexture;
+uniform vec3 emissionColor;
+uniform bool hasEmission;
+
+void main()
+{
+    vec3 albedo = objectColor;
+    if (useTexture) {
+        albedo *= texture(diffuseTexture, TexCoords).rgb;
+    }
+    
+    gAlbedo = vec4(albedo, hasEmission ? 1.0 : 0.0);
+    gNormal = vec4(hasEmission ? emissionColor : normalize(Normal), 0.0);
+}
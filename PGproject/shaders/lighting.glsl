@@ -0,0 +1,201 @@
+// Iluminarea comună căilor forward (basic.frag) și deferred
+// (deferred_lighting.frag): lumina lunii cu umbre în cascadă, lumini punctuale
+// pe clustere. Inclus de Shader::loadShader. Ceața e o trecere separată la
+// final (fog.frag).
+
+uniform sampler2DArray shadowMap;
+uniform sampler2DArrayShadow shadowMapCompare;
+uniform sampler2DArray shadowMapESM;
+uniform int shadowFilter; // 0 = PCF 3x3, 1 = PCF hardware, 2 = ESM
+uniform float esmExponent;
+uniform vec3 lightPos;
+uniform vec3 lightColor;
+uniform vec3 viewPos;
+uniform bool smoothShading;  
+uniform bool shadowsEnabled; 
+
+// Shadow map în cascadă: câte o matrice de lumină și o distanță de capăt pe strat
+#define MAX_CASCADES 4
+uniform mat4 cascadeMatrices[MAX_CASCADES];
+uniform float cascadeSplits[MAX_CASCADES];
+uniform float cascadeDepthRanges[MAX_CASCADES];
+uniform int cascadeCount;
+
+// Luminile punctuale ale lămpilor, în texture buffers:
+// lightData = 2 texeli pe lumină (poziție, rază) și (culoare, 0),
+// clusterGrid = (primul indice, număr) pe cluster, clusterLightIndices = id-urile luminilor
+uniform samplerBuffer lightData;
+uniform usamplerBuffer clusterGrid;
+uniform usamplerBuffer clusterLightIndices;
+uniform int numPointLights;
+uniform bool clusteredLighting;
+uniform ivec3 clusterDims;
+uniform float clusterNear;
+uniform float clusterFar;
+uniform vec2 viewportSize;
+
+float ShadowCalculation(vec3 fragPos, float viewDepth, vec3 normal, vec3 lightDir)
+{
+    // Prima cascadă care conține fragmentul (după adâncimea în spațiul camerei)
+    int cascade = -1;
+    for (int i = 0; i < cascadeCount && i < MAX_CASCADES; i++) {
+        if (viewDepth < cascadeSplits[i]) {
+            cascade = i;
+            break;
+        }
+    }
+    if (cascade < 0)
+        return 0.0;
+
+    vec4 fragPosLightSpace = cascadeMatrices[cascade] * vec4(fragPos, 1.0);
+    vec3 projCoords = fragPosLightSpace.xyz / fragPosLightSpace.w;
+
+    projCoords = projCoords * 0.5 + 0.5;
+    
+    float currentDepth = projCoords.z;
+    
+    float bias = max(0.05 * (1.0 - dot(normal, lightDir)), 0.005);
+    // Bias-ul e în unități de adâncime: îl păstrez constant în metri,
+    // ca la vechiul shadow map cu adâncimea de 100 de unități
+    bias *= 100.0 / cascadeDepthRanges[cascade];
+    
+    float shadow = 0.0;
+    vec2 texelSize = 1.0 / vec2(textureSize(shadowMap, 0).xy);
+    float layer = float(cascade);
+    if (shadowFilter == 2)
+    {
+        // ESM: o singură citire biliniară din harta deja filtrată
+        float occluder = texture(shadowMapESM, vec3(projCoords.xy, layer)).r;
+        float visibility = clamp(occluder * exp(-esmExponent * (currentDepth - bias)), 0.0, 1.0);
+        shadow = 1.0 - visibility;
+    }
+    else if (shadowFilter == 1)
+    {
+        // Patru citiri cu comparare hardware (fiecare e deja un PCF 2x2)
+        for(int x = 0; x < 2; ++x)
+        {
+            for(int y = 0; y < 2; ++y)
+            {
+                vec2 offset = (vec2(x, y) - 0.5) * texelSize;
+                shadow += 1.0 - texture(shadowMapCompare, vec4(projCoords.xy + offset, layer, currentDepth - bias));
+            }
+        }
+        shadow /= 4.0;
+    }
+    else
+    {
+        for(int x = -1; x <= 1; ++x)
+        {
+            for(int y = -1; y <= 1; ++y)
+            {
+                float pcfDepth = texture(shadowMap, vec3(projCoords.xy + vec2(x, y) * texelSize, layer)).r;
+                shadow += currentDepth - bias > pcfDepth ? 1.0 : 0.0;
+            }
+        }
+        shadow /= 9.0;
+    }
+    
+    if(projCoords.z > 1.0)
+        shadow = 0.0;
+    
+    return shadow;
+}
+
+// Atenuarea după distanță, adusă la zero la raza luminii
+float PointLightAttenuation(vec4 positionRadius, vec3 fragPos)
+{
+    float distance = length(positionRadius.xyz - fragPos);
+    float attenuation = 1.0 / (1.0 + 0.09 * distance + 0.032 * distance * distance);
+    float window = clamp(1.0 - pow(distance / positionRadius.w, 4.0), 0.0, 1.0);
+    return attenuation * window * window;
+}
+
+vec3 PointLightContribution(int index, vec3 fragPos, vec3 norm)
+{
+    vec4 positionRadius = texelFetch(lightData, index * 2);
+    vec3 color = texelFetch(lightData, index * 2 + 1).rgb;
+
+    vec3 pointDir = normalize(positionRadius.xyz - fragPos);
+    float pointDiff = max(dot(norm, pointDir), 0.0);
+    float attenuation = PointLightAttenuation(positionRadius, fragPos);
+    
+    // Specular pentru luminile punctuale în modul smooth
+    float pointSpec = 0.0;
+    if (smoothShading) {
+        vec3 viewDir = normalize(viewPos - fragPos);
+        vec3 reflectDir = reflect(-pointDir, norm);
+        pointSpec = pow(max(dot(viewDir, reflectDir), 0.0), 32.0) * 0.3;
+    }
+    
+    return color * (pointDiff + pointSpec) * attenuation;
+}
+
+// (primul indice, număr) în clusterLightIndices pentru clusterul de la poziția
+// de ecran screenUV (0..1) și adâncimea în vedere viewDepth
+uvec2 ClusterLightRange(vec2 screenUV, float viewDepth)
+{
+    ivec2 tile = ivec2(screenUV * vec2(clusterDims.xy));
+    tile = clamp(tile, ivec2(0), clusterDims.xy - 1);
+    float slice = log(max(viewDepth, clusterNear) / clusterNear) / log(clusterFar / clusterNear) * float(clusterDims.z);
+    int sliceIndex = clamp(int(slice), 0, clusterDims.z - 1);
+    int cluster = (sliceIndex * clusterDims.y + tile.y) * clusterDims.x + tile.x;
+    return texelFetch(clusterGrid, cluster).rg;
+}
+
+// Luminile clusterului care conține pixelul (dala de ecran + felia de adâncime)
+vec3 PointLighting(vec3 fragPos, vec3 norm, float viewDepth)
+{
+    vec3 pointLighting = vec3(0.0);
+    if (clusteredLighting) {
+        uvec2 range = ClusterLightRange(gl_FragCoord.xy / viewportSize, viewDepth);
+        for (uint i = 0u; i < range.y; i++) {
+            int lightIndex = int(texelFetch(clusterLightIndices, int(range.x + i)).r);
+            pointLighting += PointLightContribution(lightIndex, fragPos, norm);
+        }
+    } else {
+        for (int i = 0; i < numPointLights; i++) {
+            pointLighting += PointLightContribution(i, fragPos, norm);
+        }
+    }
+    return pointLighting;
+}
+
+// Culoarea finală a unui punct de pe suprafață: albedo luminat de lună și de
+// luminile punctuale (sau emisia lui)
+vec3 ShadeSurface(vec3 fragPos, vec3 norm, float viewDepth, vec3 albedo, bool emissive, vec3 emission)
+{
+    vec3 result;
+    if (emissive) {
+        // Obiectele emissive stralucesc independent de iluminare
+        // Aplic o tenta calda galbuie pentru becurile de lampa
+        vec3 warmEmission = emission * vec3(1.0, 0.85, 0.5);
+        result = albedo * 0.3 + warmEmission * 1.5;
+    } else {
+        // Lumina principală direcțională/ambientală
+        vec3 lightDir = normalize(lightPos - fragPos);
+        float diff = max(dot(norm, lightDir), 0.0);
+        
+        vec3 ambient = 0.2 * lightColor;
+        vec3 diffuse = diff * lightColor * 0.3;
+        
+        // Iluminarea speculară (doar în modul smooth)
+        vec3 specular = vec3(0.0);
+        if (smoothShading) {
+            vec3 viewDir = normalize(viewPos - fragPos);
+            vec3 reflectDir = reflect(-lightDir, norm);
+            float spec = pow(max(dot(viewDir, reflectDir), 0.0), 32.0);
+            specular = spec * lightColor * 0.5;
+        }
+        
+        // Calculez umbra de la lumina principala (luna)
+        float shadow = 0.0;
+        if (shadowsEnabled) {
+            shadow = ShadowCalculation(fragPos, viewDepth, norm, lightDir);
+        }
+        
+        // Aplic umbra pe iluminarea directionala
+        vec3 lighting = ambient + (1.0 - shadow) * (diffuse + specular) + PointLighting(fragPos, norm, viewDepth);
+        result = lighting * albedo;
+    }
+    return result;
+}
@@ -0,0 +1,15 @@
+#version 410 core
+
+in vec2 corner;
+in vec4 color;
+out vec4 FragColor;
+
+void main()
+{
+    // Particula rotunda cu margine moale; colturile quad-ului sunt aruncate
+    float dist = length(corner) * 2.0;
+    if (dist > 1.0) discard;
+
+    float fade = 1.0 - smoothstep(0.5, 1.0, dist);
+    FragColor = vec4(color.rgb, color.a * fade);
+}
@@ -0,0 +1,25 @@
+#version 410 core
+
+// Colturile quad-ului (-0.5 .. 0.5) si, pe instanta, centrul + marimea si culoarea
+layout (location = 0) in vec2 aCorner;
+layout (location = 1) in vec4 aCenterSize;
+layout (location = 2) in vec4 aColor;
+
+uniform mat4 projection;
+uniform mat4 view;
+
+out vec2 corner;
+out vec4 color;
+
+void main()
+{
+    // Axele right / up ale camerei sunt primele doua randuri din view, deci quad-ul
+    // sta mereu cu fata spre camera
+    vec3 right = vec3(view[0][0], view[1][0], view[2][0]);
+    vec3 up = vec3(view[0][1], view[1][1], view[2][1]);
+    vec3 worldPos = aCenterSize.xyz + (right * aCorner.x + up * aCorner.y) * aCenterSize.w;
+
+    gl_Position = projection * view * vec4(worldPos, 1.0);
+    corner = aCorner;
+    color = aColor;
+}
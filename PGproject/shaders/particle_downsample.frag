@@ -0,0 +1,21 @@
+#version 410 core
+
+uniform sampler2D sceneDepth;
+uniform int scale;
+uniform ivec2 sceneSize; // partea folosită din sceneDepth (poate fi mai mare, cu rezoluția dinamică)
+
+// Adâncimea cea mai apropiată din blocul scale x scale al scenei: particulele din
+// spatele oricărei geometrii din bloc sunt ascunse, iar upsample-ul bilateral
+// reface marginile din texelii vecini
+void main()
+{
+    ivec2 base = ivec2(gl_FragCoord.xy) * scale;
+    ivec2 limit = sceneSize - 1;
+    float nearest = 1.0;
+    for (int y = 0; y < scale; y++) {
+        for (int x = 0; x < scale; x++) {
+            nearest = min(nearest, texelFetch(sceneDepth, min(base + ivec2(x, y), limit), 0).r);
+        }
+    }
+    gl_FragDepth = nearest;
+}
@@ -0,0 +1,42 @@
+#version 410 core
+
+in vec2 TexCoords;
+out vec4 FragColor;
+
+uniform sampler2D lowColor;   // rgb = culoarea particulelor, a = transmitanța
+uniform sampler2D lowDepth;
+uniform sampler2D sceneDepth;
+uniform ivec2 lowSize;       // partea folosită din ținta low-res
+uniform float nearPlane;
+uniform float farPlane;
+
+float linearDepth(float depth)
+{
+    float z = depth * 2.0 - 1.0;
+    return 2.0 * nearPlane * farPlane / (farPlane + nearPlane - z * (farPlane - nearPlane));
+}
+
+void main()
+{
+    float depth = linearDepth(texelFetch(sceneDepth, ivec2(gl_FragCoord.xy), 0).r);
+
+    // Cei patru texeli low-res din jurul pixelului, cu ponderile biliniare
+    // împărțite la diferența relativă de adâncime față de pixel
+    vec2 position = TexCoords * vec2(lowSize) - 0.5;
+    ivec2 base = ivec2(floor(position));
+    vec2 f = position - floor(position);
+
+    vec4 sum = vec4(0.0);
+    float weightSum = 0.0;
+    for (int i = 0; i < 4; i++) {
+        ivec2 offset = ivec2(i & 1, i >> 1);
+        ivec2 texel = clamp(base + offset, ivec2(0), lowSize - 1);
+        float bilinear = (offset.x == 1 ? f.x : 1.0 - f.x) * (offset.y == 1 ? f.y : 1.0 - f.y);
+        float difference = abs(linearDepth(texelFetch(lowDepth, texel, 0).r) - depth) / depth;
+        float weight = bilinear / (0.001 + difference);
+        sum += texelFetch(lowColor, texel, 0) * weight;
+        weightSum += weight;
+    }
+
+    FragColor = weightSum > 0.0 ? sum / weightSum : vec4(0.0, 0.0, 0.0, 1.0);
+}
@@ -1,17 +1,23 @@
 #version 410 core
 
-layout (location = 0) in vec3 aPos;
+// Coordonatele vin ca trei atribute separate, ca să poată fi citite direct din
+// blocurile x / y / z ale simulării pe CPU (SoA) sau din bufferul vec4 de pe GPU
+layout (location = 0) in float aPosX;
+layout (location = 1) in float aPosY;
+layout (location = 2) in float aPosZ;
 
 uniform mat4 projection;
 uniform mat4 view;
+uniform float pixelScale; // 2 sau 4 când ploaia se desenează în ținta low-res
 
 out float alpha;
 out float height;
 
 void main()
 {
+    vec3 aPos = vec3(aPosX, aPosY, aPosZ);
     gl_Position = projection * view * vec4(aPos, 1.0);
-    gl_PointSize = 4.0;
+    gl_PointSize = max(4.0 / pixelScale, 1.0);
     
     height = aPos.y;
     alpha = clamp(0.4 + (1.0 - aPos.y / 50.0) * 0.4, 0.3, 0.8);
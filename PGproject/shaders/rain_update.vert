@@ -0,0 +1,77 @@
+#version 410 core
+
+// Un pas de simulare pentru o picătură; rezultatul e capturat cu transform
+// feedback în celălalt buffer (ping-pong), nimic nu ajunge la rasterizare
+layout (location = 0) in vec4 aParticle; // xyz = poziție, w = viteză de cădere
+
+uniform float deltaTime;
+uniform vec2 windVelocity; // deplasarea pe X / Z pe secundă
+uniform uint frameSeed;
+uniform bool respawnAll;   // primul cadru: toate picăturile primesc o poziție aleatoare
+uniform vec3 volumeMin;    // cutia în care trăiesc picăturile (fixă sau în jurul camerei)
+uniform vec3 volumeSize;
+
+// Harta de sus în jos a scenei statice (RainOcclusion): adâncimea 0 = occlusionTop,
+// 1 = occlusionBottom; în afara hărții întoarce 1 (doar solul)
+uniform bool occlusionEnabled;
+uniform sampler2D occlusionMap;
+uniform vec4 occlusionRect; // minX, minZ, 1 / lățime, 1 / adâncime
+uniform float occlusionTop;
+uniform float occlusionBottom;
+
+out vec4 outParticle;
+
+// PCG hash: un număr pseudo-aleator independent per picătură și per cadru
+uint pcgHash(uint v)
+{
+    uint state = v * 747796405u + 2891336453u;
+    uint word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+    return (word >> 22u) ^ word;
+}
+
+float random01(inout uint state)
+{
+    state = pcgHash(state);
+    return float(state) * (1.0 / 4294967295.0);
+}
+
+// Înălțimea la care se oprește o picătură: cea mai înaltă suprafață de sub ea sau fundul cutiei
+float stopHeight(vec2 xz)
+{
+    if (!occlusionEnabled) return volumeMin.y;
+    vec2 uv = (xz - occlusionRect.xy) * occlusionRect.zw;
+    float depth = textureLod(occlusionMap, uv, 0.0).r;
+    return max(volumeMin.y, occlusionTop - depth * (occlusionTop - occlusionBottom));
+}
+
+void main()
+{
+    vec4 p = aParticle;
+    uint rng = pcgHash(uint(gl_VertexID) ^ pcgHash(frameSeed));
+
+    if (respawnAll) {
+        p.x = volumeMin.x + random01(rng) * volumeSize.x;
+        p.y = volumeMin.y + random01(rng) * volumeSize.y;
+        p.z = volumeMin.z + random01(rng) * volumeSize.z;
+        p.w = 25.0 + random01(rng) * 15.0;
+    }
+    else {
+        p.y -= p.w * deltaTime;
+        p.xz += windVelocity * deltaTime;
+
+        // Picăturile ajunse pe un acoperiș, o coroană sau sub cutie revin sus
+        // (cu cât au depășit suprafața), cu alt x / z și altă viteză
+        float stop = stopHeight(p.xz);
+        if (p.y < stop) {
+            p.y += volumeMin.y + volumeSize.y - stop;
+            p.x = volumeMin.x + random01(rng) * volumeSize.x;
+            p.z = volumeMin.z + random01(rng) * volumeSize.z;
+            p.w = 25.0 + random01(rng) * 15.0;
+        }
+
+        // Cutia se închide pe ea însăși (tor): ce iese printr-o parte intră prin cea opusă
+        p.xyz = volumeMin + mod(p.xyz - volumeMin, volumeSize);
+    }
+
+    outParticle = p;
+}
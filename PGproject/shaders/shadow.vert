@@ -1,11 +1,14 @@
 #version 410 core
 
 layout (location = 0) in vec3 aPos;
+layout (location = 4) in mat4 aInstanceModel;
 
 uniform mat4 lightSpaceMatrix;
 uniform mat4 model;
+uniform bool useInstancing;
 
 void main()
 {
-    gl_Position = lightSpaceMatrix * model * vec4(aPos, 1.0);
+    mat4 worldModel = useInstancing ? aInstanceModel : model;
+    gl_Position = lightSpaceMatrix * worldModel * vec4(aPos, 1.0);
 }
@@ -0,0 +1,63 @@
+#version 410 core
+
+in vec2 TexCoords;
+out vec4 FragColor;
+
+uniform sampler2D sceneColor;   // ținta de randare; cadrul folosește doar colțul renderSize
+uniform sampler2D sceneDepth;
+uniform sampler2D history;      // rezultatul cadrului trecut, la rezoluția ferestrei
+uniform vec2 renderSize;
+uniform vec2 jitter;            // decalajul proiecției, în pixeli de randare
+uniform mat4 inverseViewProjection;   // cadrul curent, fără jitter
+uniform mat4 previousViewProjection;
+uniform bool historyValid;
+
+void main()
+{
+    // Centrul pixelului ferestrei, în pixeli de randare; texelul i a fost
+    // eșantionat în i + 0.5 - jitter
+    vec2 position = TexCoords * renderSize;
+    ivec2 center = ivec2(floor(position + jitter));
+    ivec2 limit = ivec2(renderSize) - 1;
+
+    vec3 sum = vec3(0.0);
+    float weightSum = 0.0;
+    float nearestWeight = 0.0;
+    vec3 low = vec3(1.0);
+    vec3 high = vec3(0.0);
+    float closestDepth = 1.0;
+    for (int y = -1; y <= 1; y++) {
+        for (int x = -1; x <= 1; x++) {
+            ivec2 texel = clamp(center + ivec2(x, y), ivec2(0), limit);
+            vec3 color = texelFetch(sceneColor, texel, 0).rgb;
+            vec2 offset = vec2(texel) + 0.5 - jitter - position;
+            float weight = exp(-2.29 * dot(offset, offset)); // aproximarea gaussiană a filtrului Blackman-Harris
+            sum += color * weight;
+            weightSum += weight;
+            nearestWeight = max(nearestWeight, weight);
+            low = min(low, color);
+            high = max(high, color);
+            closestDepth = min(closestDepth, texelFetch(sceneDepth, texel, 0).r);
+        }
+    }
+    vec3 current = sum / weightSum;
+
+    // Mișcarea camerei: punctul din lume al celei mai apropiate adâncimi,
+    // proiectat cu matricea cadrului trecut (marginile urmează obiectul din față)
+    vec4 world = inverseViewProjection * vec4(vec3(TexCoords, closestDepth) * 2.0 - 1.0, 1.0);
+    world /= world.w;
+    vec4 previousClip = previousViewProjection * world;
+    vec2 previousUV = previousClip.xy / previousClip.w * 0.5 + 0.5;
+
+    if (!historyValid || previousClip.w <= 0.0 ||
+        any(lessThan(previousUV, vec2(0.0))) || any(greaterThan(previousUV, vec2(1.0)))) {
+        FragColor = vec4(current, 1.0);
+        return;
+    }
+
+    // Istoricul e limitat la culorile vecinătății (fără dâre în urma mișcării);
+    // eșantioanele noi cântăresc mai mult când cad aproape de centrul pixelului
+    vec3 previous = clamp(texture(history, previousUV).rgb, low, high);
+    float blend = mix(0.05, 0.25, nearestWeight);
+    FragColor = vec4(mix(previous, current, blend), 1.0);
+}
@@ -0,0 +1,24 @@
+#version 410 core
+
+// Aplică volumul integrat cu o singură citire 3D pe pixel:
+// culoare = culoare * transmitanță + lumina împrăștiată (blend ONE, SRC_ALPHA)
+in vec2 TexCoords;
+out vec4 FragColor;
+
+uniform sampler3D integratedVolume;
+uniform sampler2D sceneDepth;
+uniform float nearPlane;
+uniform float farPlane;
+uniform float volumeNear;
+uniform float volumeFar;
+uniform int volumeSlices;
+
+void main()
+{
+    float depth = texelFetch(sceneDepth, ivec2(gl_FragCoord.xy), 0).r * 2.0 - 1.0;
+    float viewDepth = 2.0 * nearPlane * farPlane / (farPlane + nearPlane - depth * (farPlane - nearPlane));
+
+    // Felia z ține valoarea de la capătul ei: coordonata se mută cu o jumătate de texel
+    float slice = log(max(viewDepth, volumeNear) / volumeNear) / log(volumeFar / volumeNear);
+    FragColor = texture(integratedVolume, vec3(TexCoords, slice - 0.5 / float(volumeSlices)));
+}